@@ -0,0 +1,909 @@
+/**
+ * Copyright The bmalloc Contributors
+ * @file bmalloc_bench.cpp
+ * @brief 各分配器的 Google Benchmark 性能测试
+ * @details 工作负载：固定大小反复分配释放、随机大小、生产者/消费者、
+ *          realloc 增长与多线程竞争，FirstFit 各搜索策略的分配延迟，
+ *          以及 1 到 32 个线程的扩展性负载
+ *          （Scaling/ 前缀：跨线程释放、突发分配与 larson 式换手）。
+ *          每个基准除吞吐量外还输出抽样得到的单次操作延迟 p50/p99
+ *          （纳秒，多线程时为各线程的平均值），扩展性负载另外输出 p999
+ *          与驻留内存增量。通过
+ *          --benchmark_out=<file> --benchmark_out_format=json
+ *          （或 bmalloc_bench_json 目标）导出 JSON 结果
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bmalloc.hpp"
+#include "buddy.hpp"
+#include "bump.hpp"
+#include "first_fit.hpp"
+#include "lock.hpp"
+#include "slab.hpp"
+#include "standard_allocator.hpp"
+#include "thread_cache.hpp"
+
+using namespace bmalloc;
+
+namespace {
+
+/// 所有分配器使用的锁
+using BenchLock = SpinLock<>;
+
+/// 每个分配器管理的内存大小
+constexpr size_t kArenaBytes = 64 * 1024 * 1024;
+/// 通用 cache 的最小对象大小，小于该值的请求 Slab 不处理
+constexpr size_t kMinBenchSize = Slab<Buddy<>>::kMinObjectSize;
+/// 扩展性负载的最大线程数
+constexpr int kMaxBenchThreads = 32;
+
+/// 当前进程的驻留内存字节数
+auto ResidentBytes() -> size_t {
+  std::ifstream statm("/proc/self/statm");
+  size_t total = 0;
+  size_t resident = 0;
+  statm >> total >> resident;
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/**
+ * @brief 按页对齐的测试内存
+ */
+class Arena {
+ public:
+  explicit Arena(size_t bytes)
+      : bytes_(bytes), memory_(std::aligned_alloc(kPageSize, bytes)) {}
+  Arena(const Arena&) = delete;
+  Arena(Arena&&) = delete;
+  auto operator=(const Arena&) -> Arena& = delete;
+  auto operator=(Arena&&) -> Arena& = delete;
+  ~Arena() { std::free(memory_); }
+
+  [[nodiscard]] auto Memory() const -> void* { return memory_; }
+  [[nodiscard]] auto Bytes() const -> size_t { return bytes_; }
+
+ private:
+  size_t bytes_;
+  void* memory_;
+};
+
+/**
+ * @brief 原位调整失败时分配新内存、复制并释放旧内存
+ */
+template <class Subject>
+auto ReallocOrMove(Subject& subject, void* ptr, size_t old_size,
+                   size_t new_size) -> void* {
+  if (void* resized = subject.TryResize(ptr, new_size); resized != nullptr) {
+    return resized;
+  }
+  void* moved = subject.Alloc(new_size);
+  if (moved != nullptr) {
+    std::memcpy(moved, ptr, std::min(old_size, new_size));
+    subject.Free(ptr, old_size);
+  }
+  return moved;
+}
+
+/**
+ * @brief 被测分配器的统一接口
+ * @details 每个适配器提供：
+ *          - kName：基准名称中的分配器名
+ *          - kCanFree：能否释放单个对象，为 false 时只能通过 Reset() 整体回收
+ *          - Alloc(bytes) / Free(ptr, bytes)
+ *          - TryResize(ptr, bytes)：原位调整大小，不支持时返回 nullptr
+ */
+template <class Allocator>
+class BaseSubject {
+ public:
+  static constexpr bool kCanFree = true;
+
+  explicit BaseSubject(const Arena& arena)
+      : allocator_("bench", arena.Memory(), arena.Bytes()) {}
+
+  auto Alloc(size_t bytes) -> void* { return allocator_.Alloc(bytes); }
+  void Free(void* ptr, size_t bytes) { allocator_.Free(ptr, bytes); }
+  auto TryResize(void* ptr, size_t bytes) -> void* {
+    return allocator_.Realloc(ptr, bytes);
+  }
+  void Reset() {}
+
+ protected:
+  Allocator allocator_;
+};
+
+struct BuddySubject : BaseSubject<Buddy<std::nullptr_t, BenchLock>> {
+  static constexpr const char* kName = "Buddy";
+  using BaseSubject::BaseSubject;
+};
+
+struct SlabSubject
+    : BaseSubject<Slab<Buddy<std::nullptr_t, BenchLock>, std::nullptr_t,
+                       BenchLock>> {
+  static constexpr const char* kName = "Slab<Buddy>";
+  using BaseSubject::BaseSubject;
+};
+
+/// FirstFit 以页为单位分配
+class FirstFitSubject {
+ public:
+  static constexpr const char* kName = "FirstFit";
+  static constexpr bool kCanFree = true;
+
+  explicit FirstFitSubject(const Arena& arena)
+      : allocator_("bench", arena.Memory(), arena.Bytes() / kPageSize) {}
+
+  auto Alloc(size_t bytes) -> void* { return allocator_.Alloc(Pages(bytes)); }
+  void Free(void* ptr, size_t bytes) { allocator_.Free(ptr, Pages(bytes)); }
+  auto TryResize(void* /*ptr*/, size_t /*bytes*/) -> void* { return nullptr; }
+  void Reset() {}
+
+ private:
+  static auto Pages(size_t bytes) -> size_t {
+    return (bytes + kPageSize - 1) / kPageSize;
+  }
+
+  FirstFit<std::nullptr_t, BenchLock> allocator_;
+};
+
+/// BumpAllocator 不能释放单个对象，内存用尽时整体重置
+class BumpSubject {
+ public:
+  static constexpr const char* kName = "BumpAllocator";
+  static constexpr bool kCanFree = false;
+
+  explicit BumpSubject(const Arena& arena)
+      : allocator_("bench", arena.Memory(), arena.Bytes()) {}
+
+  auto Alloc(size_t bytes) -> void* {
+    void* ptr = allocator_.Alloc(bytes);
+    if (ptr == nullptr) {
+      Reset();
+      ptr = allocator_.Alloc(bytes);
+    }
+    return ptr;
+  }
+  void Free(void* /*ptr*/, size_t /*bytes*/) {}
+  auto TryResize(void* /*ptr*/, size_t /*bytes*/) -> void* { return nullptr; }
+  void Reset() { allocator_.Reset(); }
+
+ private:
+  BumpAllocator<std::nullptr_t, BenchLock> allocator_;
+};
+
+template <class ThreadCachePolicy>
+class BmallocSubjectBase {
+ public:
+  static constexpr bool kCanFree = true;
+
+  explicit BmallocSubjectBase(const Arena& arena)
+      : allocator_(arena.Memory(), arena.Bytes()) {}
+
+  auto Alloc(size_t bytes) -> void* { return allocator_.malloc(bytes); }
+  void Free(void* ptr, size_t bytes) { allocator_.free_sized(ptr, bytes); }
+  auto TryResize(void* ptr, size_t bytes) -> void* {
+    return allocator_.realloc(ptr, bytes);
+  }
+  void Reset() {}
+
+ private:
+  Bmalloc<std::nullptr_t, BenchLock, ThreadCachePolicy> allocator_;
+};
+
+struct BmallocSubject : BmallocSubjectBase<NoThreadCache> {
+  static constexpr const char* kName = "Bmalloc";
+  using BmallocSubjectBase::BmallocSubjectBase;
+};
+
+struct BmallocThreadCacheSubject : BmallocSubjectBase<ThreadLocalCache<>> {
+  static constexpr const char* kName = "Bmalloc<ThreadLocalCache>";
+  using BmallocSubjectBase::BmallocSubjectBase;
+};
+
+/// glibc 基准：通过 StandardAllocator 访问 aligned_alloc/free
+struct StandardSubject
+    : BaseSubject<StandardAllocator<std::nullptr_t, BenchLock>> {
+  static constexpr const char* kName = "StandardAllocator";
+  using BaseSubject::BaseSubject;
+};
+
+/// glibc 基准：直接调用 malloc/free/realloc，不经过 AllocatorBase
+class LibcSubject {
+ public:
+  static constexpr const char* kName = "libc";
+  static constexpr bool kCanFree = true;
+
+  explicit LibcSubject(const Arena& /*arena*/) {}
+
+  auto Alloc(size_t bytes) -> void* { return std::malloc(bytes); }
+  void Free(void* ptr, size_t /*bytes*/) { std::free(ptr); }
+  auto TryResize(void* ptr, size_t bytes) -> void* {
+    return std::realloc(ptr, bytes);
+  }
+  void Reset() {}
+};
+
+/**
+ * @brief 抽样记录单次操作的延迟
+ * @details 每 kInterval 次操作计时一次，避免读时钟的开销影响吞吐量
+ */
+class LatencySampler {
+ public:
+  static constexpr size_t kInterval = 64;
+
+  LatencySampler() { samples_.reserve(1 << 16); }
+
+  /// 执行 op，需要抽样时记录耗时
+  template <class Op>
+  void Run(Op&& op) {
+    if (++count_ % kInterval != 0) {
+      op();
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    op();
+    auto end = std::chrono::steady_clock::now();
+    if (samples_.size() < samples_.capacity()) {
+      samples_.push_back(static_cast<double>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+              .count()));
+    }
+  }
+
+  /// 将 p50/p99（extended 时还有 p999）写入基准的计数器，多线程时取平均
+  void Report(benchmark::State& state, bool extended = false) {
+    if (samples_.empty()) {
+      return;
+    }
+    std::sort(samples_.begin(), samples_.end());
+    auto at = [this](double quantile) {
+      return samples_[static_cast<size_t>(quantile *
+                                          static_cast<double>(
+                                              samples_.size() - 1))];
+    };
+    auto counter = [](double value) {
+      return benchmark::Counter(value, benchmark::Counter::kAvgThreads);
+    };
+    state.counters["p50_ns"] = counter(at(0.50));
+    state.counters["p99_ns"] = counter(at(0.99));
+    if (extended) {
+      state.counters["p999_ns"] = counter(at(0.999));
+    }
+  }
+
+ private:
+  size_t count_ = 0;
+  std::vector<double> samples_;
+};
+
+/// 生成 [kMinBenchSize, max_size] 内对数均匀分布的随机大小
+auto RandomSizes(size_t count, size_t max_size) -> std::vector<size_t> {
+  std::mt19937_64 gen(42);
+  std::uniform_real_distribution<double> dist(
+      std::log2(static_cast<double>(kMinBenchSize)),
+      std::log2(static_cast<double>(max_size)));
+  std::vector<size_t> sizes(count);
+  for (auto& size : sizes) {
+    size = static_cast<size_t>(std::exp2(dist(gen)));
+  }
+  return sizes;
+}
+
+/**
+ * @brief 固定大小反复分配释放
+ * @details 保持 kWindow 个存活对象，每次释放最早的对象并分配一个新对象
+ * @param state.range(0) 对象大小
+ */
+template <class Subject>
+void BM_FixedChurn(benchmark::State& state) {
+  constexpr size_t kWindow = 256;
+  const auto size = static_cast<size_t>(state.range(0));
+
+  Arena arena(kArenaBytes);
+  Subject subject(arena);
+  std::array<void*, kWindow> live{};
+  LatencySampler sampler;
+
+  size_t next = 0;
+  for (auto _ : state) {
+    sampler.Run([&]() {
+      auto& slot = live[next];
+      if (slot != nullptr) {
+        subject.Free(slot, size);
+      }
+      slot = subject.Alloc(size);
+      benchmark::DoNotOptimize(slot);
+    });
+    next = (next + 1) % kWindow;
+  }
+
+  for (auto* ptr : live) {
+    if (ptr != nullptr) {
+      subject.Free(ptr, size);
+    }
+  }
+  sampler.Report(state);
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+
+/**
+ * @brief 随机大小反复分配释放
+ * @details 保持 kWindow 个存活对象，每次替换一个随机位置上的对象
+ * @param state.range(0) 最大对象大小
+ */
+template <class Subject>
+void BM_RandomSizes(benchmark::State& state) {
+  constexpr size_t kWindow = 1024;
+  constexpr size_t kSizes = 1 << 14;
+  const auto sizes = RandomSizes(kSizes, static_cast<size_t>(state.range(0)));
+  std::vector<size_t> slots(kSizes);
+  std::mt19937 gen(7);
+  for (auto& slot : slots) {
+    slot = gen() % kWindow;
+  }
+
+  Arena arena(kArenaBytes);
+  Subject subject(arena);
+  std::array<void*, kWindow> live{};
+  std::array<size_t, kWindow> live_sizes{};
+  LatencySampler sampler;
+
+  size_t i = 0;
+  for (auto _ : state) {
+    sampler.Run([&]() {
+      auto slot = slots[i];
+      if (live[slot] != nullptr) {
+        subject.Free(live[slot], live_sizes[slot]);
+      }
+      live_sizes[slot] = sizes[i];
+      live[slot] = subject.Alloc(sizes[i]);
+      benchmark::DoNotOptimize(live[slot]);
+    });
+    i = (i + 1) % kSizes;
+  }
+
+  for (size_t slot = 0; slot < kWindow; slot++) {
+    if (live[slot] != nullptr) {
+      subject.Free(live[slot], live_sizes[slot]);
+    }
+  }
+  sampler.Report(state);
+  state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief realloc 增长：从最小大小开始按 1.5 倍增长到 state.range(0)
+ * @details 每次迭代完成一次完整的增长并释放，计数一次 realloc 为一项
+ */
+template <class Subject>
+void BM_ReallocGrowth(benchmark::State& state) {
+  const auto max_size = static_cast<size_t>(state.range(0));
+
+  Arena arena(kArenaBytes);
+  Subject subject(arena);
+  LatencySampler sampler;
+
+  int64_t reallocs = 0;
+  for (auto _ : state) {
+    size_t size = kMinBenchSize;
+    void* ptr = subject.Alloc(size);
+    while (ptr != nullptr && size < max_size) {
+      size_t new_size = std::min(max_size, size + size / 2);
+      sampler.Run([&]() {
+        ptr = ReallocOrMove(subject, ptr, size, new_size);
+      });
+      size = new_size;
+      reallocs++;
+    }
+    benchmark::DoNotOptimize(ptr);
+    if (ptr != nullptr) {
+      subject.Free(ptr, size);
+    }
+  }
+
+  sampler.Report(state);
+  state.SetItemsProcessed(reallocs);
+}
+
+/**
+ * @brief 多线程共享的基准状态
+ * @details 由 0 号线程在计时循环开始前创建，Google Benchmark 在循环开始时
+ *          同步所有线程。循环结束后各线程还要释放自己的对象，因此 0 号线程
+ *          等所有线程调用 TearDown 后才销毁
+ */
+template <class Subject>
+struct Shared {
+  static inline std::unique_ptr<Arena> arena;
+  static inline std::unique_ptr<Subject> subject;
+  static inline std::atomic<int> finished{0};
+  /// 创建分配器之前的驻留内存
+  static inline size_t resident = 0;
+
+  static void SetUp(const benchmark::State& state) {
+    if (state.thread_index() == 0) {
+      resident = ResidentBytes();
+      arena = std::make_unique<Arena>(kArenaBytes);
+      subject = std::make_unique<Subject>(*arena);
+    }
+  }
+
+  /// 由 0 号线程在计时循环结束时调用，记录创建分配器以来的驻留内存增量
+  static void ReportResident(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+      size_t now = ResidentBytes();
+      state.counters["rss_kb"] =
+          static_cast<double>(now > resident ? now - resident : 0) / 1024;
+    }
+  }
+
+  /// 所有线程调用后，0 号线程先执行 cleanup 归还共享的对象再销毁分配器
+  template <class Cleanup>
+  static void TearDown(const benchmark::State& state, Cleanup cleanup) {
+    finished.fetch_add(1, std::memory_order_acq_rel);
+    if (state.thread_index() == 0) {
+      while (finished.load(std::memory_order_acquire) < state.threads()) {
+        std::this_thread::yield();
+      }
+      finished.store(0, std::memory_order_relaxed);
+      cleanup();
+      subject.reset();
+      arena.reset();
+    }
+  }
+
+  static void TearDown(const benchmark::State& state) {
+    TearDown(state, []() {});
+  }
+};
+
+/**
+ * @brief 生产者/消费者：0 号线程分配对象，1 号线程释放
+ * @details 两个线程通过单生产者单消费者环形队列传递对象，
+ *          对象总是在分配它的线程之外被释放
+ */
+template <class Subject>
+void BM_ProducerConsumer(benchmark::State& state) {
+  constexpr size_t kSize = 64;
+  constexpr size_t kRing = 1024;
+  static std::array<std::atomic<void*>, kRing> ring{};
+
+  using Env = Shared<Subject>;
+  Env::SetUp(state);
+  const bool producer = state.thread_index() == 0;
+  LatencySampler sampler;
+
+  size_t i = 0;
+  for (auto _ : state) {
+    auto& entry = ring[i % kRing];
+    if (producer) {
+      void* ptr = nullptr;
+      sampler.Run([&]() { ptr = Env::subject->Alloc(kSize); });
+      while (entry.load(std::memory_order_acquire) != nullptr) {
+        std::this_thread::yield();
+      }
+      entry.store(ptr, std::memory_order_release);
+    } else {
+      void* ptr = nullptr;
+      while ((ptr = entry.exchange(nullptr, std::memory_order_acquire)) ==
+             nullptr) {
+        std::this_thread::yield();
+      }
+      sampler.Run([&]() { Env::subject->Free(ptr, kSize); });
+    }
+    i++;
+  }
+
+  sampler.Report(state);
+  state.SetItemsProcessed(state.iterations());
+  Env::TearDown(state);
+}
+
+/**
+ * @brief 多线程竞争：所有线程共享一个分配器，各自反复分配释放
+ * @param state.range(0) 对象大小
+ */
+template <class Subject>
+void BM_Contention(benchmark::State& state) {
+  constexpr size_t kWindow = 64;
+  const auto size = static_cast<size_t>(state.range(0));
+
+  using Env = Shared<Subject>;
+  Env::SetUp(state);
+  std::array<void*, kWindow> live{};
+  LatencySampler sampler;
+
+  size_t next = 0;
+  for (auto _ : state) {
+    sampler.Run([&]() {
+      auto& slot = live[next];
+      if (slot != nullptr) {
+        Env::subject->Free(slot, size);
+      }
+      slot = Env::subject->Alloc(size);
+      benchmark::DoNotOptimize(slot);
+    });
+    next = (next + 1) % kWindow;
+  }
+
+  for (auto* ptr : live) {
+    if (ptr != nullptr) {
+      Env::subject->Free(ptr, size);
+    }
+  }
+  sampler.Report(state);
+  state.SetItemsProcessed(state.iterations());
+  Env::TearDown(state);
+}
+
+/**
+ * @brief 扩展性负载中检查对象没有被重复分配
+ * @details 分配后在对象起始处写入对象地址，释放前检查，
+ *          对象被同时交给两个使用者时另一方的写入会破坏标记
+ */
+class Stamp {
+ public:
+  static void Mark(void* ptr) {
+    *static_cast<uintptr_t*>(ptr) = reinterpret_cast<uintptr_t>(ptr);
+  }
+
+  void Check(void* ptr) {
+    if (*static_cast<uintptr_t*>(ptr) != reinterpret_cast<uintptr_t>(ptr)) {
+      corrupted_++;
+    }
+  }
+
+  /// 发现损坏的对象时将基准标记为失败
+  void Report(benchmark::State& state) const {
+    if (corrupted_ != 0) {
+      state.SkipWithError("allocator returned an object that is still in use");
+    }
+  }
+
+ private:
+  size_t corrupted_ = 0;
+};
+
+/// 扩展性负载各线程的 xorshift 随机数
+class FastRandom {
+ public:
+  explicit FastRandom(uint64_t seed)
+      : state_(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+
+  auto Next() -> uint64_t {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 7;
+    state_ ^= state_ << 17;
+    return state_;
+  }
+
+ private:
+  uint64_t state_;
+};
+
+/**
+ * @brief 跨线程释放：所有线程通过共享的槽位表交换对象
+ * @details 每次操作分配一个对象放入随机槽位，并释放槽位中原有的对象。
+ *          N 个线程时约 (N-1)/N 的对象在分配它的线程之外被释放，
+ *          测量远程释放路径（如 slab 的 remote_free_ 与线程缓存的归还）
+ */
+template <class Subject>
+void BM_CrossThreadFree(benchmark::State& state) {
+  constexpr size_t kSize = 64;
+  constexpr size_t kSlots = 4096;
+  static std::array<std::atomic<void*>, kSlots> slots{};
+
+  using Env = Shared<Subject>;
+  Env::SetUp(state);
+  FastRandom random(static_cast<uint64_t>(state.thread_index()));
+  LatencySampler sampler;
+  Stamp stamp;
+
+  for (auto _ : state) {
+    sampler.Run([&]() {
+      void* ptr = Env::subject->Alloc(kSize);
+      if (ptr != nullptr) {
+        Stamp::Mark(ptr);
+      }
+      void* old = slots[random.Next() % kSlots].exchange(
+          ptr, std::memory_order_acq_rel);
+      if (old != nullptr) {
+        stamp.Check(old);
+        Env::subject->Free(old, kSize);
+      }
+    });
+  }
+  Env::ReportResident(state);
+
+  sampler.Report(state, true);
+  stamp.Report(state);
+  state.SetItemsProcessed(state.iterations());
+  Env::TearDown(state, []() {
+    for (auto& slot : slots) {
+      if (void* ptr = slot.exchange(nullptr); ptr != nullptr) {
+        Env::subject->Free(ptr, kSize);
+      }
+    }
+  });
+}
+
+/**
+ * @brief 突发分配：各线程交替连续分配 kBurst 个随机大小的对象、
+ *        再按分配顺序全部释放
+ * @details 每次迭代是一次分配或释放，测量 slab 增长与收缩、
+ *          空闲页归还下层分配器时的锁竞争
+ */
+template <class Subject>
+void BM_BurstyAlloc(benchmark::State& state) {
+  constexpr size_t kBurst = 256;
+  constexpr size_t kSizes = 1 << 12;
+  const auto sizes = RandomSizes(kSizes, 1024);
+
+  using Env = Shared<Subject>;
+  Env::SetUp(state);
+  std::array<void*, kBurst> live{};
+  std::array<size_t, kBurst> live_sizes{};
+  LatencySampler sampler;
+  Stamp stamp;
+
+  size_t i = static_cast<size_t>(state.thread_index()) * 997;
+  size_t count = 0;
+  bool allocating = true;
+  for (auto _ : state) {
+    sampler.Run([&]() {
+      if (allocating) {
+        live_sizes[count] = sizes[i++ % kSizes];
+        live[count] = Env::subject->Alloc(live_sizes[count]);
+        if (live[count] != nullptr) {
+          Stamp::Mark(live[count]);
+        }
+      } else if (live[count] != nullptr) {
+        stamp.Check(live[count]);
+        Env::subject->Free(live[count], live_sizes[count]);
+        live[count] = nullptr;
+      }
+    });
+    if (++count == kBurst) {
+      count = 0;
+      allocating = !allocating;
+    }
+  }
+  Env::ReportResident(state);
+
+  for (size_t slot = 0; slot < kBurst; slot++) {
+    if (live[slot] != nullptr) {
+      Env::subject->Free(live[slot], live_sizes[slot]);
+    }
+  }
+  sampler.Report(state, true);
+  stamp.Report(state);
+  state.SetItemsProcessed(state.iterations());
+  Env::TearDown(state);
+}
+
+/**
+ * @brief larson 式换手：各线程随机替换自己窗口中的对象，
+ *        每 kRound 次操作把整个窗口与共享看板上的一个窗口交换
+ * @details 换到的窗口中的对象由其它线程分配，此后在本线程中被逐个替换，
+ *          模拟服务器中请求对象在线程之间移交、存活一段时间后释放
+ */
+template <class Subject>
+void BM_Larson(benchmark::State& state) {
+  constexpr size_t kWindow = 256;
+  constexpr size_t kRound = 1024;
+  constexpr size_t kBoard = 32;
+  constexpr size_t kSizes = 1 << 12;
+  struct Window {
+    std::array<void*, kWindow> ptrs_;
+    std::array<size_t, kWindow> sizes_;
+  };
+  // 窗口总数固定，交换只改变窗口的持有者，每个对象始终属于一个窗口
+  static std::array<Window, kBoard + kMaxBenchThreads> windows{};
+  static std::array<std::atomic<Window*>, kBoard> board{};
+  const auto sizes = RandomSizes(kSizes, 1024);
+
+  using Env = Shared<Subject>;
+  Env::SetUp(state);
+  if (state.thread_index() == 0) {
+    for (size_t j = 0; j < kBoard; j++) {
+      board[j].store(&windows[j], std::memory_order_relaxed);
+    }
+  }
+  Window* mine = &windows[kBoard + state.thread_index()];
+  FastRandom random(static_cast<uint64_t>(state.thread_index()));
+  LatencySampler sampler;
+  Stamp stamp;
+
+  size_t i = 0;
+  for (auto _ : state) {
+    sampler.Run([&]() {
+      auto slot = random.Next() % kWindow;
+      if (mine->ptrs_[slot] != nullptr) {
+        stamp.Check(mine->ptrs_[slot]);
+        Env::subject->Free(mine->ptrs_[slot], mine->sizes_[slot]);
+      }
+      mine->sizes_[slot] = sizes[random.Next() % kSizes];
+      mine->ptrs_[slot] = Env::subject->Alloc(mine->sizes_[slot]);
+      if (mine->ptrs_[slot] != nullptr) {
+        Stamp::Mark(mine->ptrs_[slot]);
+      }
+    });
+    if (++i % kRound == 0) {
+      mine = board[random.Next() % kBoard].exchange(
+          mine, std::memory_order_acq_rel);
+    }
+  }
+  Env::ReportResident(state);
+
+  auto drain = [](Window& window) {
+    for (size_t slot = 0; slot < kWindow; slot++) {
+      if (window.ptrs_[slot] != nullptr) {
+        Env::subject->Free(window.ptrs_[slot], window.sizes_[slot]);
+        window.ptrs_[slot] = nullptr;
+      }
+    }
+  };
+  drain(*mine);
+  sampler.Report(state, true);
+  stamp.Report(state);
+  state.SetItemsProcessed(state.iterations());
+  Env::TearDown(state, [&]() {
+    for (auto& entry : board) {
+      drain(*entry.load(std::memory_order_relaxed));
+    }
+  });
+}
+
+/**
+ * @brief FirstFit 搜索策略在不同区域大小与碎片程度下的分配延迟
+ * @details 先用单页分配填满区域的前半部分，模拟堆积在区域开头的长期分配，
+ *          再每 pinned_every 页保留一个、释放其余的页制造碎片；
+ *          之后每次迭代分配 4 页，每 32 次分配后全部释放
+ * @param state.range(0) 区域页数
+ * @param state.range(1) 保留单页分配的间隔，为 0 时不制造碎片
+ */
+template <class SearchPolicy>
+void BM_SearchPolicy(benchmark::State& state) {
+  constexpr size_t kRunPages = 4;
+  constexpr size_t kBatch = 32;
+  const auto pages = static_cast<size_t>(state.range(0));
+  const auto pinned_every = static_cast<size_t>(state.range(1));
+
+  Arena arena(pages * kPageSize);
+  FirstFit<std::nullptr_t, BenchLock, SearchPolicy> allocator(
+      "bench", arena.Memory(), pages);
+  std::vector<void*> pinned;
+  for (size_t i = 0; i < pages / 2; i++) {
+    void* ptr = allocator.Alloc(1);
+    if (ptr == nullptr) {
+      break;
+    }
+    pinned.push_back(ptr);
+  }
+  if (pinned_every != 0) {
+    for (size_t i = 0; i < pinned.size(); i++) {
+      if (i % pinned_every != 0) {
+        allocator.Free(pinned[i], 1);
+      }
+    }
+  }
+
+  std::vector<void*> ptrs;
+  ptrs.reserve(kBatch);
+  LatencySampler sampler;
+  for (auto _ : state) {
+    // 只抽样分配，批量释放的耗时计入吞吐量但不计入单次延迟
+    sampler.Run([&]() {
+      void* ptr = allocator.Alloc(kRunPages);
+      benchmark::DoNotOptimize(ptr);
+      ptrs.push_back(ptr);
+    });
+    if (ptrs.size() == kBatch) {
+      for (auto* block : ptrs) {
+        allocator.Free(block, kRunPages);
+      }
+      ptrs.clear();
+    }
+  }
+
+  for (auto* block : ptrs) {
+    allocator.Free(block, kRunPages);
+  }
+  sampler.Report(state);
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// 注册一种 FirstFit 搜索策略的基准
+template <class SearchPolicy>
+void RegisterSearchPolicy(const char* policy) {
+  benchmark::RegisterBenchmark(
+      (std::string("SearchPolicy/FirstFit<") + policy + ">").c_str(),
+      BM_SearchPolicy<SearchPolicy>)
+      ->ArgsProduct({{1024, 8 * 1024, 64 * 1024}, {0, 8, 2}})
+      ->ArgNames({"pages", "pinned_every"});
+}
+
+/// 为一个分配器注册所有适用的基准
+template <class Subject>
+void RegisterSubject() {
+  auto name = [](const char* workload) {
+    return std::string(workload) + "/" + Subject::kName;
+  };
+
+  benchmark::RegisterBenchmark(name("FixedChurn").c_str(),
+                               BM_FixedChurn<Subject>)
+      ->Arg(64)
+      ->Arg(4096);
+  benchmark::RegisterBenchmark(name("RandomSizes").c_str(),
+                               BM_RandomSizes<Subject>)
+      ->Arg(4096);
+
+  // 以下负载需要释放单个对象
+  if constexpr (Subject::kCanFree) {
+    benchmark::RegisterBenchmark(name("ReallocGrowth").c_str(),
+                                 BM_ReallocGrowth<Subject>)
+        ->Arg(65536);
+    benchmark::RegisterBenchmark(name("ProducerConsumer").c_str(),
+                                 BM_ProducerConsumer<Subject>)
+        ->Threads(2)
+        ->UseRealTime();
+    benchmark::RegisterBenchmark(name("Contention").c_str(),
+                                 BM_Contention<Subject>)
+        ->Arg(64)
+        ->ThreadRange(1, 8)
+        ->UseRealTime();
+
+    // 扩展性负载：线程数 1/2/4/8/16/32，可用 --benchmark_filter=Scaling 单独运行
+    benchmark::RegisterBenchmark(name("Scaling/CrossThreadFree").c_str(),
+                                 BM_CrossThreadFree<Subject>)
+        ->ThreadRange(1, kMaxBenchThreads)
+        ->UseRealTime();
+    benchmark::RegisterBenchmark(name("Scaling/BurstyAlloc").c_str(),
+                                 BM_BurstyAlloc<Subject>)
+        ->ThreadRange(1, kMaxBenchThreads)
+        ->UseRealTime();
+    benchmark::RegisterBenchmark(name("Scaling/Larson").c_str(),
+                                 BM_Larson<Subject>)
+        ->ThreadRange(1, kMaxBenchThreads)
+        ->UseRealTime();
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  RegisterSubject<BuddySubject>();
+  RegisterSubject<FirstFitSubject>();
+  RegisterSubject<BumpSubject>();
+  RegisterSubject<SlabSubject>();
+  RegisterSubject<BmallocSubject>();
+  RegisterSubject<BmallocThreadCacheSubject>();
+  RegisterSubject<StandardSubject>();
+  RegisterSubject<LibcSubject>();
+  RegisterSearchPolicy<FirstFitSearch>("FirstFitSearch");
+  RegisterSearchPolicy<NextFitSearch>("NextFitSearch");
+  RegisterSearchPolicy<BestFitSearch>("BestFitSearch");
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -2,20 +2,111 @@
  * Copyright The bmalloc Contributors
  */
 
-#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+// 禁止编译器把下面的循环识别为 memset/memcpy 调用，避免递归调用自身
+#if defined(__GNUC__) && !defined(__clang__)
+#define BMALLOC_NO_LOOP_PATTERNS \
+  __attribute__((optimize("no-tree-loop-distribute-patterns")))
+#else
+#define BMALLOC_NO_LOOP_PATTERNS
+#endif
+
+namespace {
+
+/// 按字访问内存的类型，may_alias 允许以任意类型的对象为目标
+using Word = uintptr_t __attribute__((may_alias));
+
+constexpr size_t kWordSize = sizeof(Word);
+
+}  // namespace
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-__attribute__((weak)) void *memset(void *dest, int val, size_t n) {
-  unsigned char *ptr = (unsigned char *)dest;
+/**
+ * @brief 按字宽填充内存
+ * @details 先逐字节填充到字对齐，然后每次写入 4 个字，最后处理剩余字节。
+ *          定义 BMALLOC_FREESTANDING 时作为 memset 的弱定义
+ */
+BMALLOC_NO_LOOP_PATTERNS void *bmalloc_memset(void *dest, int val, size_t n) {
+  auto *ptr = static_cast<unsigned char *>(dest);
+  auto byte = static_cast<unsigned char>(val);
+  while (n > 0 && (reinterpret_cast<uintptr_t>(ptr) & (kWordSize - 1)) != 0) {
+    *ptr++ = byte;
+    n--;
+  }
+
+  Word pattern = static_cast<Word>(-1) / 0xFF * byte;
+  auto *words = reinterpret_cast<Word *>(ptr);
+  for (; n >= 4 * kWordSize; n -= 4 * kWordSize, words += 4) {
+    words[0] = pattern;
+    words[1] = pattern;
+    words[2] = pattern;
+    words[3] = pattern;
+  }
+  for (; n >= kWordSize; n -= kWordSize) {
+    *words++ = pattern;
+  }
+
+  ptr = reinterpret_cast<unsigned char *>(words);
+  while (n-- > 0) {
+    *ptr++ = byte;
+  }
+  return dest;
+}
+
+/**
+ * @brief 按字宽复制内存
+ * @details 源与目标相对字对齐时先逐字节复制到对齐处，然后按字复制；
+ *          否则逐字节复制。源与目标不能重叠。
+ *          定义 BMALLOC_FREESTANDING 时作为 memcpy 的弱定义
+ */
+BMALLOC_NO_LOOP_PATTERNS void *bmalloc_memcpy(void *dest, const void *src,
+                                              size_t n) {
+  auto *to = static_cast<unsigned char *>(dest);
+  const auto *from = static_cast<const unsigned char *>(src);
+  if (((reinterpret_cast<uintptr_t>(to) ^ reinterpret_cast<uintptr_t>(from)) &
+       (kWordSize - 1)) == 0) {
+    while (n > 0 &&
+           (reinterpret_cast<uintptr_t>(to) & (kWordSize - 1)) != 0) {
+      *to++ = *from++;
+      n--;
+    }
+    auto *to_words = reinterpret_cast<Word *>(to);
+    const auto *from_words = reinterpret_cast<const Word *>(from);
+    for (; n >= 4 * kWordSize; n -= 4 * kWordSize) {
+      to_words[0] = from_words[0];
+      to_words[1] = from_words[1];
+      to_words[2] = from_words[2];
+      to_words[3] = from_words[3];
+      to_words += 4;
+      from_words += 4;
+    }
+    for (; n >= kWordSize; n -= kWordSize) {
+      *to_words++ = *from_words++;
+    }
+    to = reinterpret_cast<unsigned char *>(to_words);
+    from = reinterpret_cast<const unsigned char *>(from_words);
+  }
   while (n-- > 0) {
-    *ptr++ = val;
+    *to++ = *from++;
   }
   return dest;
 }
 
+// 库总是以 -ffreestanding 编译，__STDC_HOSTED__ 无法区分目标环境，
+// 由构建选项 BMALLOC_FREESTANDING 决定是否导出 memset/memcpy
+#ifdef BMALLOC_FREESTANDING
+__attribute__((weak, alias("bmalloc_memset"))) void *memset(void *dest,
+                                                            int val, size_t n);
+
+__attribute__((weak, alias("bmalloc_memcpy"))) void *memcpy(
+    void *dest, const void *src, size_t n);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -7,13 +7,37 @@
 
 #include <cstdarg>
 #include <cstddef>
+#include <concepts>
 #include <cstdint>
 #include <type_traits>
 #include <utility>
 
+#include "sampler.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
+
+/// 分配器的页面大小，可以在编译时通过 -DBMALLOC_PAGE_SIZE=<n> 按目标设置
+#ifndef BMALLOC_PAGE_SIZE
+#define BMALLOC_PAGE_SIZE 4096
+#endif
+
+/// 缓存行大小，可以在编译时通过 -DBMALLOC_CACHE_LINE_SIZE=<n> 按目标设置
+#ifndef BMALLOC_CACHE_LINE_SIZE
+#define BMALLOC_CACHE_LINE_SIZE 64
+#endif
+
 namespace bmalloc {
 /// 分配器的页面大小
-static constexpr size_t kPageSize = 4096;
+static constexpr size_t kPageSize = BMALLOC_PAGE_SIZE;
+static_assert(kPageSize >= 64 && (kPageSize & (kPageSize - 1)) == 0,
+              "BMALLOC_PAGE_SIZE must be a power of 2 and at least 64");
+
+/// 锁与 slab cache 内部分组对齐到的缓存行大小，避免与相邻数据伪共享
+static constexpr size_t kCacheLineSize = BMALLOC_CACHE_LINE_SIZE;
+static_assert(kCacheLineSize >= sizeof(void*) &&
+                  (kCacheLineSize & (kCacheLineSize - 1)) == 0 &&
+                  kCacheLineSize <= kPageSize,
+              "BMALLOC_CACHE_LINE_SIZE must be a power of 2 within a page");
 
 /**
  * @brief 锁接口抽象基类
@@ -26,13 +50,38 @@ class LockBase {
   virtual void Unlock() {}
 };
 
+/**
+ * @brief 锁类型需要满足的接口
+ * @details 不要求继承 LockBase；不继承 LockBase 或声明为 final 的锁类型
+ *          可以在编译期绑定 Lock/Unlock 调用并内联
+ */
+template <class T>
+concept Lockable = requires(T& lock) {
+  lock.Lock();
+  lock.Unlock();
+};
+
+/**
+ * @brief 不加锁的锁类型
+ * @details 用于单线程环境，final 保证 Lock/Unlock 调用不经过虚函数表
+ */
+class NullLock final : public LockBase {
+ public:
+  void Lock() override {}
+  void Unlock() override {}
+};
+
 /**
  * @brief RAII 风格的锁守卫
- * @details 类似于 std::lock_guard，用于自动管理锁的获取和释放
+ * @details 类似于 std::lock_guard，用于自动管理锁的获取和释放。
+ *          按实际的锁类型实例化（LockGuard guard(lock) 自动推导），
+ *          锁类型不是多态类型或为 final 时调用被静态绑定
+ * @tparam L 锁类型
  */
+template <Lockable L = LockBase>
 class LockGuard {
  public:
-  explicit LockGuard(LockBase& lock) : lock_(lock) { lock_.Lock(); }
+  explicit LockGuard(L& lock) : lock_(lock) { lock_.Lock(); }
 
   ~LockGuard() { lock_.Unlock(); }
 
@@ -43,7 +92,7 @@ class LockGuard {
   auto operator=(LockGuard&&) -> LockGuard& = delete;
 
  private:
-  LockBase& lock_;
+  L& lock_;
 };
 
 /**
@@ -54,7 +103,7 @@ class LockGuard {
  */
 
 template <class LogFunc, class Lock>
-  requires std::derived_from<Lock, LockBase> || std::is_same_v<Lock, LockBase>
+  requires Lockable<Lock>
 class AllocatorBase {
  public:
   /**
@@ -87,7 +136,9 @@ class AllocatorBase {
    */
   [[nodiscard]] auto Alloc(size_t length) -> void* {
     LockGuard guard(lock_);
-    return AllocImpl(length);
+    void* addr = AllocImpl(length);
+    Record(TraceOp::kAlloc, addr, length);
+    return addr;
   }
 
   /**
@@ -97,9 +148,56 @@ class AllocatorBase {
    */
   void Free(void* addr, size_t length = 0) {
     LockGuard guard(lock_);
+    Record(TraceOp::kFree, addr, length);
     FreeImpl(addr, length);
   }
 
+  /**
+   * @brief 调整已分配内存块的长度
+   * @param  addr            已分配的地址
+   * @param  length          新的长度
+   * @return void*          调整后的地址，可能与 addr 相同；
+   *                        失败或不支持时返回 nullptr，原内存块保持不变
+   */
+  [[nodiscard]] auto Realloc(void* addr, size_t length) -> void* {
+    LockGuard guard(lock_);
+    void* resized = ReallocImpl(addr, length);
+    RecordRealloc(addr, resized, length);
+    return resized;
+  }
+
+  /**
+   * @brief 批量分配多个指定长度的内存块
+   * @param  length          每个内存块的长度
+   * @param  count           要分配的内存块数量
+   * @param  ptrs            保存分配结果的数组，至少能容纳 count 个元素
+   * @return size_t          成功分配的数量 n，结果保存在 ptrs[0, n) 中
+   */
+  [[nodiscard]] auto AllocBulk(size_t length, size_t count, void** ptrs)
+      -> size_t {
+    LockGuard guard(lock_);
+    size_t n = AllocBulkImpl(length, count, ptrs);
+    for (size_t i = 0; i < n; i++) {
+      Record(TraceOp::kAlloc, ptrs[i], length);
+    }
+    failed_allocs_ += count - n;
+    return n;
+  }
+
+  /**
+   * @brief 批量释放多个内存块
+   * @param  ptrs            要释放的地址数组
+   * @param  count           要释放的内存块数量
+   * @param  length          每个内存块的长度
+   */
+  void FreeBulk(void* const* ptrs, size_t count, size_t length = 0) {
+    LockGuard guard(lock_);
+    for (size_t i = 0; i < count; i++) {
+      Record(TraceOp::kFree, ptrs[i], length);
+    }
+    FreeBulkImpl(ptrs, count, length);
+  }
+
   /**
    * @brief 获取一个内存块在内存池中占用的实际字节数
    * @param  addr            内存块地址
@@ -111,15 +209,70 @@ class AllocatorBase {
 
   /**
    * @brief 获取已使用的内存数量
+   * @details 不在锁内维护 used_count_ 的分配器（如无锁的 BumpAllocator）
+   *          需覆盖此函数
    * @return size_t          已使用的数量
    */
-  [[nodiscard]] auto GetUsedCount() const -> size_t { return used_count_; }
+  [[nodiscard]] virtual auto GetUsedCount() const -> size_t {
+    return used_count_;
+  }
 
   /**
    * @brief 获取空闲的内存数量
+   * @details 与 GetUsedCount() 相同，不维护 free_count_ 的分配器需覆盖
    * @return size_t          空闲的数量
    */
-  [[nodiscard]] auto GetFreeCount() const -> size_t { return free_count_; }
+  [[nodiscard]] virtual auto GetFreeCount() const -> size_t {
+    return free_count_;
+  }
+
+  /**
+   * @brief 获取统计快照
+   * @details 不加锁，可以在其它线程中周期性调用；
+   *          锁类型提供 GetLockStats() 时包含锁的竞争统计
+   * @return AllocatorStats  统计快照
+   */
+  [[nodiscard]] auto GetStats() const -> AllocatorStats {
+    AllocatorStats stats{};
+    stats.allocs_ = allocs_;
+    stats.failed_allocs_ = failed_allocs_;
+    stats.frees_ = frees_;
+    stats.used_ = GetUsedCount();
+    stats.free_ = GetFreeCount();
+    stats.peak_used_ = peak_used_;
+    // 覆盖了 GetUsedCount() 的分配器不更新 peak_used_
+    if (stats.peak_used_ < stats.used_) {
+      stats.peak_used_ = stats.used_;
+    }
+    if constexpr (requires { lock_.GetLockStats(); }) {
+      auto lock_stats = lock_.GetLockStats();
+      stats.lock_acquisitions_ = lock_stats.acquisitions_;
+      stats.lock_contentions_ = lock_stats.contentions_;
+    }
+    return stats;
+  }
+
+  /**
+   * @brief 设置跟踪缓冲区
+   * @details 设置后 Alloc/Free/Realloc 及其批量版本在锁内将每次操作写入
+   *          缓冲区，不额外分配内存或加锁
+   * @param  buffer          调用者提供的缓冲区，为 nullptr 时停止跟踪
+   */
+  void SetTraceBuffer(TraceBuffer* buffer) {
+    LockGuard guard(lock_);
+    trace_ = buffer;
+  }
+
+  /**
+   * @brief 设置采样堆分析器
+   * @details 设置后 Alloc/Free/Realloc 及其批量版本在锁内调用采样器，
+   *          采样的回调同样在锁内执行；未设置时只多一次指针判断
+   * @param  sampler         采样器，为 nullptr 时停止采样
+   */
+  void SetSampler(HeapSampler* sampler) {
+    LockGuard guard(lock_);
+    sampler_ = sampler;
+  }
 
  protected:
   /// 分配器名称
@@ -129,11 +282,70 @@ class AllocatorBase {
   /// 当前管理的内存区域长度
   const size_t length_;
   /// 当前管理的内存区域空闲数量
-  size_t free_count_;
+  StatCounter<size_t> free_count_;
   /// 当前管理的内存区域已使用数量
-  size_t used_count_;
+  StatCounter<size_t> used_count_;
+  /// used_count_ 的最大值
+  StatCounter<size_t> peak_used_;
+  /// 成功的分配次数
+  StatCounter<> allocs_;
+  /// 失败的分配次数
+  StatCounter<> failed_allocs_;
+  /// 释放次数
+  StatCounter<> frees_;
   /// 用于线程安全的锁对象
   Lock lock_;
+  /// 跟踪缓冲区，为 nullptr 时不跟踪
+  TraceBuffer* trace_ = nullptr;
+  /// 采样堆分析器，为 nullptr 时不采样
+  HeapSampler* sampler_ = nullptr;
+
+  /// 在锁内记录一次操作：更新统计计数，设置了跟踪缓冲区时写入跟踪记录，
+  /// 设置了采样器时交给采样器
+  void Record(TraceOp op, const void* addr, size_t length) {
+    if (op == TraceOp::kAlloc) {
+      if (addr != nullptr) [[likely]] {
+        allocs_++;
+        peak_used_.Max(used_count_);
+      } else {
+        failed_allocs_++;
+      }
+    } else if (op == TraceOp::kFree && addr != nullptr) {
+      frees_++;
+    }
+    if (trace_ != nullptr) [[unlikely]] {
+      trace_->Record(op, addr, length);
+    }
+    if (sampler_ != nullptr) [[unlikely]] {
+      if (op == TraceOp::kAlloc) {
+        sampler_->RecordAlloc(addr, length);
+      } else {
+        sampler_->RecordFree(addr);
+      }
+    }
+  }
+
+  /// 在锁内记录一次 Realloc，移动时跟踪记录为释放旧块与分配新块，
+  /// 失败时不记录；采样器只关心移动，原位调整保留原来的采样记录
+  void RecordRealloc(const void* addr, const void* resized, size_t length) {
+    if (resized != nullptr) {
+      peak_used_.Max(used_count_);
+    }
+    if (sampler_ != nullptr && resized != nullptr && resized != addr)
+        [[unlikely]] {
+      sampler_->RecordFree(addr);
+      sampler_->RecordAlloc(resized, length);
+    }
+    if (trace_ == nullptr || resized == nullptr) [[likely]] {
+      return;
+    }
+    if (resized == addr) {
+      trace_->Record(TraceOp::kRealloc, resized, length);
+    } else {
+      trace_->Record(TraceOp::kFree, addr, 0);
+      trace_->Record(TraceOp::kAlloc, resized, length);
+    }
+  }
 
   /**
    * @brief 分配指定长度的内存的实际实现（线程不安全）
@@ -153,6 +365,52 @@ class AllocatorBase {
   virtual void FreeImpl([[maybe_unused]] void* addr,
                         [[maybe_unused]] size_t length = 0) {}
 
+  /**
+   * @brief 调整内存块长度的实际实现（线程不安全）
+   * @details 默认不支持，返回 nullptr，由调用者分配新内存并复制
+   * @param  addr            已分配的地址
+   * @param  length          新的长度
+   * @return void*          调整后的地址，失败时返回 nullptr
+   */
+  [[nodiscard]] virtual auto ReallocImpl([[maybe_unused]] void* addr,
+                                         [[maybe_unused]] size_t length)
+      -> void* {
+    return nullptr;
+  }
+
+  /**
+   * @brief 批量分配的实际实现（线程不安全）
+   * @details 默认逐个调用 AllocImpl，遇到失败时停止
+   * @param  length          每个内存块的长度
+   * @param  count           要分配的内存块数量
+   * @param  ptrs            保存分配结果的数组
+   * @return size_t          成功分配的数量
+   */
+  [[nodiscard]] virtual auto AllocBulkImpl(size_t length, size_t count,
+                                           void** ptrs) -> size_t {
+    size_t i = 0;
+    for (; i < count; i++) {
+      ptrs[i] = AllocImpl(length);
+      if (ptrs[i] == nullptr) {
+        break;
+      }
+    }
+    return i;
+  }
+
+  /**
+   * @brief 批量释放的实际实现（线程不安全）
+   * @details 默认逐个调用 FreeImpl
+   * @param  ptrs            要释放的地址数组
+   * @param  count           要释放的内存块数量
+   * @param  length          每个内存块的长度
+   */
+  virtual void FreeBulkImpl(void* const* ptrs, size_t count, size_t length) {
+    for (size_t i = 0; i < count; i++) {
+      FreeImpl(ptrs[i], length);
+    }
+  }
+
   /**
    * @brief 获取一个内存块在内存池中占用的实际字节数
    * @param  addr            内存块地址
@@ -176,6 +434,101 @@ class AllocatorBase {
   }
 };
 
+/**
+ * @brief 编译期分派的内存分配器基类（CRTP）
+ * @details 公共接口与 AllocatorBase 相同，但直接调用 Derived 中的 *Impl 实现
+ *          （限定名调用，不经过虚函数表），对具体类型的调用可以完全内联；
+ *          派生类仍然是 AllocatorBase，通过 AllocatorBase 的指针或引用调用时
+ *          保持原有的虚函数接口。
+ *          Derived 需要将本类声明为友元以便访问 protected 的 *Impl，
+ *          并且 Derived 的派生类不应再重写 *Impl
+ * @tparam Derived 派生的分配器类型
+ * @tparam LogFunc printf 风格的日志函数类型
+ * @tparam Lock 锁类型
+ */
+template <class Derived, class LogFunc, class Lock>
+class StaticAllocatorBase : public AllocatorBase<LogFunc, Lock> {
+ public:
+  using Base = AllocatorBase<LogFunc, Lock>;
+  using Base::Base;
+
+  /// 分配指定长度的内存，语义与 AllocatorBase::Alloc 相同
+  [[nodiscard]] auto Alloc(size_t length) -> void* {
+    LockGuard guard(this->lock_);
+    void* addr = Self().Derived::AllocImpl(length);
+    this->Record(TraceOp::kAlloc, addr, length);
+    return addr;
+  }
+
+  /// 释放指定地址和长度的内存，语义与 AllocatorBase::Free 相同
+  void Free(void* addr, size_t length = 0) {
+    LockGuard guard(this->lock_);
+    this->Record(TraceOp::kFree, addr, length);
+    Self().Derived::FreeImpl(addr, length);
+  }
+
+  /// 调整已分配内存块的长度，语义与 AllocatorBase::Realloc 相同
+  [[nodiscard]] auto Realloc(void* addr, size_t length) -> void* {
+    LockGuard guard(this->lock_);
+    void* resized = Self().Derived::ReallocImpl(addr, length);
+    this->RecordRealloc(addr, resized, length);
+    return resized;
+  }
+
+  /// 批量分配多个指定长度的内存块，语义与 AllocatorBase::AllocBulk 相同
+  [[nodiscard]] auto AllocBulk(size_t length, size_t count, void** ptrs)
+      -> size_t {
+    LockGuard guard(this->lock_);
+    size_t n = 0;
+    if constexpr (std::is_same_v<
+                      decltype(&Derived::AllocBulkImpl),
+                      decltype(&StaticAllocatorBase::AllocBulkImpl)>) {
+      // 未重写时同样逐个分配，但不经过虚函数表
+      for (; n < count; n++) {
+        ptrs[n] = Self().Derived::AllocImpl(length);
+        if (ptrs[n] == nullptr) {
+          break;
+        }
+      }
+    } else {
+      n = Self().Derived::AllocBulkImpl(length, count, ptrs);
+    }
+    for (size_t i = 0; i < n; i++) {
+      this->Record(TraceOp::kAlloc, ptrs[i], length);
+    }
+    this->failed_allocs_ += count - n;
+    return n;
+  }
+
+  /// 批量释放多个内存块，语义与 AllocatorBase::FreeBulk 相同
+  void FreeBulk(void* const* ptrs, size_t count, size_t length = 0) {
+    LockGuard guard(this->lock_);
+    for (size_t i = 0; i < count; i++) {
+      this->Record(TraceOp::kFree, ptrs[i], length);
+    }
+    if constexpr (std::is_same_v<
+                      decltype(&Derived::FreeBulkImpl),
+                      decltype(&StaticAllocatorBase::FreeBulkImpl)>) {
+      for (size_t i = 0; i < count; i++) {
+        Self().Derived::FreeImpl(ptrs[i], length);
+      }
+    } else {
+      Self().Derived::FreeBulkImpl(ptrs, count, length);
+    }
+  }
+
+  /// 获取内存块的实际字节数，语义与 AllocatorBase::AllocSize 相同
+  [[nodiscard]] size_t AllocSize(void* addr) const {
+    return Self().Derived::AllocSizeImpl(addr);
+  }
+
+ private:
+  auto Self() -> Derived& { return static_cast<Derived&>(*this); }
+  auto Self() const -> const Derived& {
+    return static_cast<const Derived&>(*this);
+  }
+};
+
 }  // namespace bmalloc
 
 #endif /* BMALLOC_SRC_INCLUDE_ALLOCATOR_BASE_HPP_ */
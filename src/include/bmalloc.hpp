@@ -9,20 +9,50 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
+#include <new>
 
 #include "allocator_base.hpp"
 #include "buddy.hpp"
 #include "bump.hpp"
 #include "first_fit.hpp"
 #include "slab.hpp"
+#include "thread_cache.hpp"
 
 namespace bmalloc {
 
-template <class LogFunc = std::nullptr_t, class Lock = LockBase>
+/**
+ * @brief 通用内存分配器
+ * @details 不超过 kSmallLimit 的请求由 Slab 的通用 cache 分配，
+ *          更大的请求直接由 Slab 下层的页分配器（默认为 Buddy）分配，
+ *          两层共享同一块内存。
+ *          释放、查询大小时通过 Slab 的页描述符表 O(1) 判断内存所属的层。
+ *          启用线程缓存时，不超过 ThreadCachePolicy::kMaxSize 的 malloc/free
+ *          优先访问当前线程的缓存，只在缓存为空或已满时批量访问 slab。
+ * @tparam LogFunc printf 风格的日志函数类型
+ * @tparam Lock 锁类型
+ * @tparam ThreadCachePolicy 线程缓存策略，默认不启用
+ * @tparam PageAllocator slab 与大块请求共用的页分配器，构造参数与 Buddy 相同；
+ *         使用 HugePageAllocator 时 slab 与大块请求从按大页对齐的 extent 中分配
+ */
+template <class LogFunc = std::nullptr_t, class Lock = LockBase,
+          class ThreadCachePolicy = NoThreadCache,
+          class PageAllocator = Buddy<LogFunc, Lock>>
 class Bmalloc {
  public:
-  explicit Bmalloc(void* start_addr, size_t bytes)
-      : allocator_("Bmalloc", start_addr, bytes) {}
+  /**
+   * @brief 构造分配器
+   * @param start_addr 管理的内存起始地址，会向上对齐到页边界
+   * @param bytes 管理的字节数
+   * @param zeroed 内存是否已全部清零，为 true 时 calloc 跳过从未分配过的页
+   */
+  explicit Bmalloc(void* start_addr, size_t bytes, bool zeroed = false)
+      : allocator_("Bmalloc", AlignUp(start_addr),
+                   AlignedBytes(start_addr, bytes), zeroed) {
+    if constexpr (ThreadCachePolicy::kEnabled) {
+      cache_id_ = ThreadCachePolicy::NextId();
+    }
+  }
 
   Bmalloc() = default;
   Bmalloc(const Bmalloc&) = delete;
@@ -41,11 +71,11 @@ class Bmalloc {
       Log("malloc: size is 0, returning nullptr\n");
       return nullptr;
     }
-    void* ptr = allocator_.Alloc(size);
+    void* ptr = AllocBlock(size);
     if (ptr == nullptr) {
       Log("malloc: failed to allocate %zu bytes\n", size);
     }
-    return ptr;
+    return Sampled(ptr, size);
   }
 
   /**
@@ -71,16 +101,23 @@ class Bmalloc {
     }
 
     size_t total_size = num * size;
-    void* ptr = allocator_.Alloc(total_size);
-
-    if (ptr != nullptr) {
-      std::memset(ptr, 0, total_size);
+    void* ptr = nullptr;
+    if (total_size >= kPageSize) {
+      // 不小于一页的请求直接由 Buddy 分配，从未分配过的页无需清零
+      ptr = allocator_.GetPageAllocator().AllocZeroed(total_size);
     } else {
+      ptr = AllocBlock(total_size);
+      if (ptr != nullptr) {
+        std::memset(ptr, 0, total_size);
+      }
+    }
+
+    if (ptr == nullptr) {
       Log("calloc: failed to allocate %zu bytes (num=%zu, size=%zu)\n",
           total_size, num, size);
     }
 
-    return ptr;
+    return Sampled(ptr, total_size);
   }
 
   /**
@@ -90,37 +127,50 @@ class Bmalloc {
    * @return void* 重新分配成功时返回新内存地址，失败时返回nullptr
    * @note 如果ptr为nullptr，则等同于malloc(new_size)
    * @note 如果new_size为0，则等同于free(ptr)并返回nullptr
+   * @note 先交给所属的层调整：slab 中新大小属于同一分级时原位返回；
+   *       Buddy 层由 buddy_realloc 重新查找，可能原位也可能移动，
+   *       不保证原位增长或缩小。所属的层无法满足时才分配新内存并复制
    */
   [[nodiscard]] auto realloc(void* ptr, size_t new_size) -> void* {
     // If ptr is nullptr, equivalent to malloc(new_size)
     if (ptr == nullptr) {
       Log("realloc: ptr is nullptr, equivalent to malloc(%zu)\n", new_size);
-      return allocator_.Alloc(new_size);
+      return Sampled(AllocBlock(new_size), new_size);
     }
 
     // If new_size is 0, equivalent to free(ptr) and return nullptr
     if (new_size == 0) {
       Log("realloc: new_size is 0, equivalent to free(ptr)\n");
-      allocator_.Free(ptr);
+      SampleFree(ptr);
+      FreeBlock(ptr);
       return nullptr;
     }
 
     // Get the current size of the memory block
-    size_t old_size = allocator_.AllocSize(ptr);
+    size_t old_size = BlockSize(ptr);
     if (old_size == 0) {
       Log("realloc: ptr %p is invalid or corrupted, AllocSize returned 0\n",
           ptr);
       return nullptr;
     }
 
-    // If the new size is the same or smaller and within reasonable bounds,
-    // we can return the same pointer
-    if (new_size <= old_size && old_size - new_size < old_size / 2) {
-      return ptr;
+    // 先在内存块所属的层调整：slab 中新大小属于同一分级时原位返回，
+    // 页分配器中可能原位调整，也可能移动到新的块（如 Buddy 重新查找）
+    void* resized = IsSmall(ptr)
+                        ? allocator_.Realloc(ptr, new_size)
+                        : allocator_.GetPageAllocator().Realloc(ptr, new_size);
+    if (resized != nullptr) {
+      // 页分配器移动了内存块时，与 AllocatorBase::RecordRealloc 一样
+      // 记为释放旧块与分配新块
+      if (resized != ptr) {
+        SampleFree(ptr);
+        Sampled(resized, new_size);
+      }
+      return resized;
     }
 
     // Allocate new memory
-    void* new_ptr = allocator_.Alloc(new_size);
+    void* new_ptr = AllocBlock(new_size);
     if (new_ptr == nullptr) {
       Log("realloc: failed to allocate new memory of size %zu\n", new_size);
       return nullptr;
@@ -131,9 +181,10 @@ class Bmalloc {
     std::memcpy(new_ptr, ptr, copy_size);
 
     // Free the old memory
-    allocator_.Free(ptr);
+    SampleFree(ptr);
+    FreeBlock(ptr);
 
-    return new_ptr;
+    return Sampled(new_ptr, new_size);
   }
 
   /**
@@ -145,9 +196,199 @@ class Bmalloc {
     if (ptr == nullptr) {
       return;
     }
-    allocator_.Free(ptr);
+    SampleFree(ptr);
+    FreeBlock(ptr);
+  }
+
+  /**
+   * @brief 按分配时的大小释放内存块（C23 free_sized）
+   * @param ptr 要释放的内存指针，可以为nullptr
+   * @param size 分配时请求的大小（realloc 之后为新的大小），为 0 时等同于 free
+   * @note 大于 slab 上限的内存块直接归还 Buddy，不查询任何元数据；
+   *       其余的只查询一次页描述符表，确认属于 size 对应的通用 cache 后
+   *       跳过 cache 名称比较与重复查表直接释放。calloc 与原位 realloc
+   *       可能把较小的请求留在 Buddy 中，确认失败时退回 free 的查找路径
+   * @note size 与分配时的大小不符时行为未定义
+   */
+  void free_sized(void* ptr, size_t size) {
+    if (ptr == nullptr) {
+      return;
+    }
+    SampleFree(ptr);
+    if (size > kSmallLimit) {
+      allocator_.GetPageAllocator().Free(ptr, size);
+      return;
+    }
+    if (!allocator_.IsSizeCacheObject(ptr, size)) {
+      FreeBlock(ptr);
+      return;
+    }
+    if constexpr (ThreadCachePolicy::kEnabled) {
+      auto object_size = SizeClass::Size(SizeClass::Index(SmallSize(size)));
+      if (object_size <= ThreadCachePolicy::kMaxSize &&
+          CachedFree(ptr, object_size)) {
+        return;
+      }
+    }
+    allocator_.Free(ptr, SmallSize(size));
+  }
+
+  /**
+   * @brief 按分配时的对齐与大小释放 aligned_alloc 分配的内存块
+   *        （C23 free_aligned_sized）
+   * @param ptr 由 aligned_alloc 返回的内存指针，可以为nullptr
+   * @param alignment 分配时的对齐参数
+   * @param size 分配时请求的大小
+   */
+  void free_aligned_sized(void* ptr, size_t alignment, size_t size) {
+    free_sized(ptr, size > alignment ? size : alignment);
+  }
+
+  /**
+   * @brief 批量分配多个相同大小的内存块
+   * @param size 每个内存块的大小（字节）
+   * @param count 要分配的内存块数量
+   * @param ptrs 保存分配结果的数组，至少能容纳 count 个元素
+   * @return size_t 成功分配的数量 n，结果保存在 ptrs[0, n) 中
+   */
+  [[nodiscard]] auto malloc_bulk(size_t size, size_t count, void** ptrs)
+      -> size_t {
+    if (size == 0 || count == 0 || ptrs == nullptr) {
+      Log("malloc_bulk: invalid arguments, returning 0\n");
+      return 0;
+    }
+    size_t n = 0;
+    if (size <= kSmallLimit) {
+      n = allocator_.AllocBulk(SmallSize(size), count, ptrs);
+    } else {
+      while (n < count && (ptrs[n] = AllocBlock(size)) != nullptr) {
+        n++;
+      }
+    }
+    if (n < count) {
+      Log("malloc_bulk: allocated %zu of %zu blocks of %zu bytes\n", n, count,
+          size);
+    }
+    if (sampler_ != nullptr) [[unlikely]] {
+      for (size_t i = 0; i < n; i++) {
+        sampler_->RecordAlloc(ptrs[i], size);
+      }
+    }
+    return n;
+  }
+
+  /**
+   * @brief 批量释放内存块
+   * @param ptrs 要释放的内存指针数组，其中的 nullptr 会被跳过
+   * @param count 数组长度
+   */
+  void free_bulk(void* const* ptrs, size_t count) {
+    if (ptrs == nullptr || count == 0) {
+      return;
+    }
+    if (sampler_ != nullptr) [[unlikely]] {
+      for (size_t i = 0; i < count; i++) {
+        sampler_->RecordFree(ptrs[i]);
+      }
+    }
+    // 连续属于同一分级的 slab 指针按已知大小批量释放，其余的逐个释放
+    size_t i = 0;
+    while (i < count) {
+      size_t size = ptrs[i] != nullptr ? allocator_.GetAllocatedSize(ptrs[i])
+                                       : 0;
+      if (size != 0) {
+        size_t j = i + 1;
+        while (j < count && ptrs[j] != nullptr &&
+               allocator_.GetAllocatedSize(ptrs[j]) == size) {
+          j++;
+        }
+        allocator_.FreeBulk(ptrs + i, j - i, size);
+        i = j;
+        continue;
+      }
+      if (ptrs[i] != nullptr) {
+        allocator_.GetPageAllocator().Free(ptrs[i]);
+      }
+      i++;
+    }
   }
 
+  /**
+   * @brief 将当前线程缓存的对象全部归还给 slab
+   * @details 线程退出前或长时间不再分配时调用
+   * @return size_t 归还的对象数量
+   */
+  auto release_thread_cache() -> size_t {
+    if constexpr (ThreadCachePolicy::kEnabled) {
+      auto* cache = LocalCache();
+      if (cache != nullptr && cache->Acquire()) {
+        size_t n = FlushCache(*cache);
+        cache->Release();
+        return n;
+      }
+    }
+    return 0;
+  }
+
+  /**
+   * @brief 回收空闲的线程缓存
+   * @details 自上次调用以来没有被使用过的线程缓存（如线程已退出）中的对象
+   *          全部归还给 slab；正在被所属线程访问的缓存会被跳过
+   * @return size_t 归还的对象数量
+   */
+  auto scavenge_thread_caches() -> size_t {
+    size_t n = 0;
+    if constexpr (ThreadCachePolicy::kEnabled) {
+      LockGuard guard(cache_list_lock_);
+      for (auto* cache = thread_caches_; cache != nullptr;
+           cache = cache->next_) {
+        if (cache->TestAndClearUsed() || !cache->Acquire()) {
+          continue;
+        }
+        n += FlushCache(*cache);
+        cache->Release();
+      }
+    }
+    return n;
+  }
+
+  /// get_stats() 填充的统计快照
+  struct Stats {
+    /// slab 层的统计，used_ 与 free_ 以页为单位
+    AllocatorStats slab_;
+    /// buddy 层（大于 slab 上限的请求与 slab 页）的统计
+    AllocatorStats pages_;
+    /// 通用 cache 的统计，数量与 slab 使用的 PowerOfTwoSizeClass 一致
+    CacheStats caches_[PowerOfTwoSizeClass::kCount];
+    /// caches_ 中有效的数量
+    size_t cache_count_;
+  };
+
+  /**
+   * @brief 获取统计快照
+   * @details 不加锁，可以由监控线程周期性调用。
+   *          线程缓存命中的 malloc/free 不经过 slab，只在批量补充与归还时
+   *          计入 slab 层的统计，线程缓存中的空闲对象计为活跃对象
+   * @param stats 保存结果的快照
+   */
+  void get_stats(Stats& stats) const {
+    stats.slab_ = allocator_.GetStats();
+    stats.pages_ = allocator_.GetPageAllocator().GetStats();
+    stats.cache_count_ =
+        allocator_.GetCacheStats(stats.caches_, std::size(stats.caches_));
+  }
+
+  /**
+   * @brief 设置采样堆分析器
+   * @details 设置后 malloc/calloc/realloc/aligned_alloc 及批量分配的结果
+   *          交给采样器，释放时在内存块归还之前查询采样记录；
+   *          回调在分配器的锁外执行，包括线程缓存命中的请求。
+   *          未设置时每次调用只多一次指针判断。
+   *          不能与其它调用并发，应在分配线程开始前或停止后设置
+   * @param sampler 采样器，为 nullptr 时停止采样
+   */
+  void set_sampler(HeapSampler* sampler) { sampler_ = sampler; }
+
   /**
    * @brief 分配对齐的内存块
    * @param alignment 内存对齐要求（必须是2的幂）
@@ -155,8 +396,12 @@ class Bmalloc {
    * @return void* 分配成功时返回对齐的内存地址，失败时返回 nullptr
    * @note 对齐参数必须是2的幂次方，否则返回 nullptr
    * @note 如果 size 为 0，返回 nullptr
-   * @note 分配的内存必须使用 aligned_free 释放，不能使用普通的 free
-   * @note 在对齐地址前存储原始指针，用于释放时定位原始分配块
+   * @note 对齐不超过 kPageSize 的小请求由自然对齐的通用 cache 分配，
+   *       其它请求从 buddy 分配不小于 alignment 的块。buddy arena 从堆的
+   *       起始地址开始，块相对 arena 按自身大小对齐，因此 alignment
+   *       不超过堆起始地址本身的对齐时总能满足，超过时返回 nullptr。
+   *       不在返回地址前保存额外的元数据，没有填充开销
+   * @note 分配的内存可以直接使用 free 释放，aligned_free 与其等价
    */
   [[nodiscard]] auto aligned_alloc(size_t alignment, size_t size) -> void* {
     // 检查对齐参数是否为2的幂
@@ -171,112 +416,256 @@ class Bmalloc {
       return nullptr;
     }
 
-    // 计算需要额外分配的空间：对齐调整 + 原始指针存储空间
-    size_t extra_offset = alignment - 1 + sizeof(void*);
-    auto* original_ptr = allocator_.Alloc(size + extra_offset);
+    auto bytes = size > alignment ? size : alignment;
+    if (alignment <= kPageSize && bytes <= kSmallLimit) {
+      auto* ptr = allocator_.AllocAligned(alignment, SmallSize(size));
+      if (ptr == nullptr) {
+        Log("aligned_alloc: failed to allocate %zu bytes (alignment: %zu)\n",
+            size, alignment);
+      }
+      return Sampled(ptr, size);
+    }
 
-    if (original_ptr == nullptr) {
-      Log("aligned_alloc: failed to allocate %zu bytes (requested: %zu, "
-          "alignment: %zu)\n",
-          size + extra_offset, size, alignment);
+    auto& pages = allocator_.GetPageAllocator();
+    auto* ptr = pages.Alloc(bytes);
+    if (ptr == nullptr) {
+      Log("aligned_alloc: failed to allocate %zu bytes (alignment: %zu)\n",
+          size, alignment);
       return nullptr;
     }
-
-    // 计算对齐后的地址
-    auto original_addr = reinterpret_cast<uintptr_t>(original_ptr);
-    auto aligned_addr = (original_addr + extra_offset) & ~(alignment - 1);
-    auto* aligned_ptr = reinterpret_cast<void*>(aligned_addr);
-
-    // 在对齐地址前存储原始指针，用于释放时找到原始分配
-    auto* original_ptr_storage =
-        reinterpret_cast<void**>(aligned_addr - sizeof(void*));
-    *original_ptr_storage = original_ptr;
-
-    return aligned_ptr;
+    // buddy 块相对管理区域的起始地址对齐，超过起始地址本身的对齐时无法满足
+    if ((reinterpret_cast<uintptr_t>(ptr) & (alignment - 1)) != 0) {
+      Log("aligned_alloc: alignment %zu exceeds the alignment of the heap\n",
+          alignment);
+      pages.Free(ptr);
+      return nullptr;
+    }
+    return Sampled(ptr, size);
   }
 
   /**
    * @brief 释放由 aligned_alloc 分配的对齐内存块
    * @param ptr 由 aligned_alloc 返回的对齐内存指针，可以为nullptr
-   * @note 如果ptr为nullptr，则不执行任何操作
-   * @note 此函数专门用于释放 aligned_alloc 分配的内存，不能用于普通 malloc
-   * 分配的内存
-   * @note 通过读取对齐地址前存储的原始指针来定位并释放原始分配块
-   * @warning 传入非 aligned_alloc 分配的指针会导致未定义行为
+   * @note 与 free 等价，保留以兼容旧接口
    */
-  void aligned_free(void* ptr) {
-    if (ptr == nullptr) {
-      Log("aligned_free: ptr is nullptr, no operation performed\n");
-      return;
-    }
-
-    // 获取存储在对齐地址前的原始指针
-    auto* original_ptr_storage = reinterpret_cast<void**>(ptr) - 1;
-    auto* original_ptr = *original_ptr_storage;
-
-    if (original_ptr == nullptr) {
-      Log("aligned_free: corrupted metadata, original_ptr is nullptr\n");
-      return;
-    }
-
-    // 释放原始分配的内存
-    allocator_.Free(original_ptr);
-  }
+  void aligned_free(void* ptr) { free(ptr); }
 
   /**
    * @brief 获取内存块的实际大小
    * @param ptr 内存指针
    * @return size_t 内存块的实际大小，如果ptr无效则返回0
    * @note 此函数用于获取普通 malloc 分配的内存大小
-   * @note 对于 aligned_alloc 分配的内存，请使用 aligned_malloc_size
+   * @note 也可用于 aligned_alloc 分配的内存
    */
   [[nodiscard]] auto malloc_size(void* ptr) const -> size_t {
     if (ptr == nullptr) {
       return 0;
     }
 
-    return allocator_.AllocSize(ptr);
+    return BlockSize(ptr);
   }
 
   /**
    * @brief 获取由 aligned_alloc 分配的内存块的实际大小
    * @param ptr 由 aligned_alloc 返回的对齐内存指针
    * @return size_t 对齐内存块的实际大小，如果ptr无效则返回0
-   * @note 此函数专门用于获取 aligned_alloc 分配的内存大小
-   * @note 返回的是原始分配的内存总大小，包括对齐开销和元数据空间
-   * @note 通过读取对齐地址前存储的原始指针来定位原始分配块
-   * @warning 传入非 aligned_alloc 分配的指针会导致未定义行为
+   * @note 与 malloc_size 等价，保留以兼容旧接口
    */
   [[nodiscard]] auto aligned_malloc_size(void* ptr) const -> size_t {
-    if (ptr == nullptr) {
-      Log("aligned_malloc_size: ptr is nullptr, returning 0\n");
-      return 0;
+    return malloc_size(ptr);
+  }
+
+ private:
+  using SizeClass = PowerOfTwoSizeClass;
+  using Allocator = Slab<PageAllocator, LogFunc, Lock, SizeClass>;
+  using Cache = ThreadCache<SizeClass, ThreadCachePolicy>;
+
+  /// 不超过该大小的请求由 slab 分配
+  static constexpr size_t kSmallLimit = Allocator::kMaxObjectSize;
+
+  /// 查询 slab 中的内存大小需要加锁查找，因此在 const 接口中也可修改
+  mutable Allocator allocator_;
+
+  /// 所有线程缓存的链表，只在创建与回收时加锁访问
+  Cache* thread_caches_ = nullptr;
+  /// 保护 thread_caches_ 链表
+  Lock cache_list_lock_;
+  /// 本分配器在线程缓存槽位中的编号
+  uint64_t cache_id_ = 0;
+  /// 采样堆分析器，为 nullptr 时不采样
+  HeapSampler* sampler_ = nullptr;
+
+  /// 起始地址向上对齐到页边界
+  static auto AlignUp(void* addr) -> void* {
+    auto value = reinterpret_cast<uintptr_t>(addr);
+    return reinterpret_cast<void*>((value + kPageSize - 1) & ~(kPageSize - 1));
+  }
+
+  /// 对齐起始地址后剩余的字节数
+  static auto AlignedBytes(void* addr, size_t bytes) -> size_t {
+    auto skipped = static_cast<size_t>(static_cast<char*>(AlignUp(addr)) -
+                                       static_cast<char*>(addr));
+    return bytes > skipped ? bytes - skipped : 0;
+  }
+
+  /// 小于 slab 最小对象大小的请求向上取整
+  static constexpr auto SmallSize(size_t size) -> size_t {
+    return size < Allocator::kMinObjectSize ? Allocator::kMinObjectSize
+                                            : size;
+  }
+
+  /// 设置了采样器时记录一次分配，返回 ptr
+  auto Sampled(void* ptr, size_t size) -> void* {
+    if (sampler_ != nullptr) [[unlikely]] {
+      sampler_->RecordAlloc(ptr, size);
     }
+    return ptr;
+  }
 
-    // 获取存储在对齐地址前的原始指针
-    auto* original_ptr_storage = reinterpret_cast<void**>(ptr) - 1;
-    auto* original_ptr = *original_ptr_storage;
+  /// 设置了采样器时记录一次释放，需在内存块归还之前调用
+  void SampleFree(void* ptr) {
+    if (sampler_ != nullptr) [[unlikely]] {
+      sampler_->RecordFree(ptr);
+    }
+  }
 
-    if (original_ptr == nullptr) {
-      Log("aligned_malloc_size: corrupted metadata, original_ptr is "
-          "nullptr\n");
-      return 0;
+  /// 按请求大小从对应的层分配
+  auto AllocBlock(size_t size) -> void* {
+    if constexpr (ThreadCachePolicy::kEnabled) {
+      if (size <= ThreadCachePolicy::kMaxSize) {
+        if (auto* ptr = CachedAlloc(SmallSize(size)); ptr != nullptr) {
+          return ptr;
+        }
+      }
     }
+    if (size <= kSmallLimit) {
+      return allocator_.Alloc(SmallSize(size));
+    }
+    return allocator_.GetPageAllocator().Alloc(size);
+  }
 
-    // 返回原始分配的大小
-    size_t size = allocator_.AllocSize(original_ptr);
-    if (size == 0) {
-      Log("aligned_malloc_size: original_ptr %p is invalid, AllocSize "
-          "returned 0\n",
-          original_ptr);
+  /// 指针是否由 slab 分配
+  auto IsSmall(void* ptr) const -> bool {
+    return ptr != nullptr && allocator_.GetAllocatedSize(ptr) != 0;
+  }
+
+  /// 内存块的实际大小
+  auto BlockSize(void* ptr) const -> size_t {
+    size_t size = allocator_.GetAllocatedSize(ptr);
+    if (size != 0) {
+      return size;
     }
-    return size;
+    return allocator_.GetPageAllocator().AllocSize(ptr);
   }
 
- private:
-  // using PageAllocator = Buddy<LogFunc, Lock>;
-  using Allocator = BumpAllocator<LogFunc, Lock>;
-  Allocator allocator_;
+  /// 释放到所属的层
+  void FreeBlock(void* ptr) {
+    size_t size = ptr != nullptr ? allocator_.GetAllocatedSize(ptr) : 0;
+    if constexpr (ThreadCachePolicy::kEnabled) {
+      if (size != 0 && size <= ThreadCachePolicy::kMaxSize &&
+          CachedFree(ptr, size)) {
+        return;
+      }
+    }
+    if (size != 0) {
+      allocator_.Free(ptr);
+    } else {
+      allocator_.GetPageAllocator().Free(ptr);
+    }
+  }
+
+  /**
+   * @brief 获取当前线程的缓存，不存在时创建
+   * @return Cache* 线程缓存，无法分配时返回 nullptr
+   */
+  auto LocalCache() -> Cache* {
+    auto& slot = ThreadCachePolicy::Slot(cache_id_);
+    if (slot != nullptr) {
+      return static_cast<Cache*>(slot);
+    }
+
+    // 槽位被替换过或首次访问：按线程标识查找，找不到时创建
+    auto key = ThreadCachePolicy::ThreadKey();
+    LockGuard guard(cache_list_lock_);
+    for (auto* cache = thread_caches_; cache != nullptr;
+         cache = cache->next_) {
+      if (cache->thread_key_ == key) {
+        slot = cache;
+        return cache;
+      }
+    }
+    auto* memory = allocator_.Alloc(SmallSize(sizeof(Cache)));
+    if (memory == nullptr) {
+      return nullptr;
+    }
+    auto* cache = new (memory) Cache(key);
+    cache->next_ = thread_caches_;
+    thread_caches_ = cache;
+    slot = cache;
+    return cache;
+  }
+
+  /**
+   * @brief 从当前线程的缓存分配，为空时从 slab 批量补充
+   * @param size 请求的大小，不小于 slab 的最小对象大小
+   * @return void* 失败或缓存不可用时返回 nullptr
+   */
+  auto CachedAlloc(size_t size) -> void* {
+    auto* cache = LocalCache();
+    if (cache == nullptr || !cache->Acquire()) {
+      return nullptr;
+    }
+    auto index = SizeClass::Index(size);
+    void* ptr = cache->Pop(index);
+    if (ptr == nullptr) {
+      void* batch[Cache::kMaxBatch + 1];
+      size_t n = allocator_.AllocBulk(SizeClass::Size(index),
+                                      Cache::BatchSize(index) + 1, batch);
+      for (size_t i = 1; i < n; i++) {
+        cache->Push(index, batch[i]);
+      }
+      ptr = n > 0 ? batch[0] : nullptr;
+    }
+    cache->Release();
+    return ptr;
+  }
+
+  /**
+   * @brief 释放到当前线程的缓存，已满时先将一批对象归还给 slab
+   * @param ptr 由 slab 分配的对象
+   * @param size 对象大小
+   * @return bool 缓存不可用时返回 false
+   */
+  auto CachedFree(void* ptr, size_t size) -> bool {
+    auto* cache = LocalCache();
+    if (cache == nullptr || !cache->Acquire()) {
+      return false;
+    }
+    auto index = SizeClass::Index(size);
+    if (!cache->Push(index, ptr)) {
+      void* batch[Cache::kMaxBatch];
+      size_t n = cache->Take(index, Cache::BatchSize(index), batch);
+      // 同一批对象属于同一分级，按大小释放以跳过逐个查找 cache
+      allocator_.FreeBulk(batch, n, SizeClass::Size(index));
+      cache->Push(index, ptr);
+    }
+    cache->Release();
+    return true;
+  }
+
+  /// 将缓存中的对象全部归还给 slab，调用者需持有缓存的访问权
+  auto FlushCache(Cache& cache) -> size_t {
+    size_t total = 0;
+    for (size_t index = 0; index < Cache::kClassCount; index++) {
+      void* batch[Cache::kMaxBatch];
+      size_t n = 0;
+      while ((n = cache.Take(index, Cache::kMaxBatch, batch)) > 0) {
+        allocator_.FreeBulk(batch, n, SizeClass::Size(index));
+        total += n;
+      }
+    }
+    return total;
+  }
 
   /**
    * @brief 记录日志信息
@@ -10,26 +10,54 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include "allocator_base.hpp"
 
 namespace bmalloc {
 
 template <class LogFunc = std::nullptr_t, class Lock = LockBase>
-class Buddy : public AllocatorBase<LogFunc, Lock> {
+class Buddy : public StaticAllocatorBase<Buddy<LogFunc, Lock>, LogFunc, Lock> {
  public:
-  using AllocatorBase<LogFunc, Lock>::Alloc;
-  using AllocatorBase<LogFunc, Lock>::Free;
-  using AllocatorBase<LogFunc, Lock>::AllocSize;
+  using Dispatch = StaticAllocatorBase<Buddy<LogFunc, Lock>, LogFunc, Lock>;
+  using Dispatch::Alloc;
+  using Dispatch::AllocSize;
+  using Dispatch::Free;
+  using Dispatch::Realloc;
 
-  explicit Buddy(const char* name, void* addr, size_t bytes)
-      : AllocatorBase<LogFunc, Lock>(name, addr, bytes) {
-    buddy = buddy_embed(static_cast<uint8_t*>(addr), bytes);
+  /**
+   * @brief 构造 Buddy 分配器
+   * @param name 分配器名称
+   * @param addr 管理的内存起始地址
+   * @param bytes 管理的字节数
+   * @param zeroed 内存是否已全部清零（如启动时清零的内存），为 true 时
+   *        在区域末尾保留一张页位图记录哪些页分配过，
+   *        AllocZeroed() 对从未分配过的页不再清零
+   */
+  explicit Buddy(const char* name, void* addr, size_t bytes,
+                 bool zeroed = false)
+      : Dispatch(name, addr, bytes) {
+    auto* arena = static_cast<uint8_t*>(addr);
+    size_t map_bytes = zeroed ? DirtyMapBytes(bytes) : 0;
+    if (map_bytes != 0) {
+      // 页位图放在区域末尾，arena 从 addr 开始，buddy 块的绝对地址
+      // 随 addr 本身的对齐而对齐
+      auto start = reinterpret_cast<uintptr_t>(addr);
+      auto map = (start + bytes - map_bytes) & ~(alignof(uint64_t) - 1);
+      dirty_map_ = reinterpret_cast<uint64_t*>(map);
+      bytes = map - start;
+      dirty_pages_ = bytes / kPageSize;
+      for (size_t i = 0; i < map_bytes / sizeof(uint64_t); i++) {
+        dirty_map_[i] = 0;
+      }
+      arena_start_ = start;
+    }
+    buddy = buddy_embed(arena, bytes);
     if (!buddy) {
       Log("Buddy allocator initialization failed for %s\n", name);
     } else {
       Log("Buddy allocator initialized: %s managing %zu bytes at %p\n", name,
-          bytes, addr);
+          bytes, static_cast<void*>(arena));
     }
   }
 
@@ -43,7 +71,38 @@ class Buddy : public AllocatorBase<LogFunc, Lock> {
   ~Buddy() override = default;
   /// @}
 
+  /**
+   * @brief 分配内存并保证前 bytes 字节为 0
+   * @details 构造时声明内存已清零时，内存块覆盖的页都从未分配过则跳过清零；
+   *          否则（或未启用页位图时）在锁外清零。
+   *          依赖 buddy_alloc 不向空闲块写入元数据
+   * @param bytes 要分配的字节数
+   * @return void* 分配到的地址，失败时返回 nullptr
+   */
+  [[nodiscard]] auto AllocZeroed(size_t bytes) -> void* {
+    void* ptr = nullptr;
+    bool clean = false;
+    {
+      LockGuard guard(this->lock_);
+      ptr = buddy_malloc(buddy, bytes);
+      this->Record(TraceOp::kAlloc, ptr, bytes);
+      if (ptr == nullptr) {
+        Log("Buddy allocator %s failed to allocate %zu bytes\n", name_,
+            bytes);
+        return nullptr;
+      }
+      clean = IsClean(ptr, bytes);
+      MarkDirty(ptr, buddy_alloc_size(buddy, ptr));
+    }
+    if (!clean) {
+      std::memset(ptr, 0, bytes);
+    }
+    return ptr;
+  }
+
  protected:
+  friend Dispatch;
+
   using AllocatorBase<LogFunc, Lock>::Log;
   using AllocatorBase<LogFunc, Lock>::name_;
   using AllocatorBase<LogFunc, Lock>::start_addr_;
@@ -51,18 +110,110 @@ class Buddy : public AllocatorBase<LogFunc, Lock> {
 
   struct buddy* buddy{};
 
+  /// 页位图，第 i 位为 1 表示从 arena_start_ 起的第 i 页分配过，可能不为 0
+  uint64_t* dirty_map_ = nullptr;
+  /// 页位图覆盖的页数
+  size_t dirty_pages_ = 0;
+  /// buddy arena 的起始地址，页位图位于 arena 之后
+  uintptr_t arena_start_ = 0;
+
+  /// 页位图占用的字节数（按页向上取整），区域过小无法容纳时返回 0
+  static constexpr auto DirtyMapBytes(size_t bytes) -> size_t {
+    auto words = (bytes / kPageSize + 63) / 64;
+    auto map_bytes = (words * sizeof(uint64_t) + kPageSize - 1) &
+                     ~(kPageSize - 1);
+    return map_bytes < bytes ? map_bytes : 0;
+  }
+
+  /**
+   * @brief 对 [addr, addr + bytes) 覆盖的页位图按 64 位字逐段处理
+   * @param op 接收 (字下标, 掩码)，返回 false 时停止
+   * @return bool op 是否对所有字都返回了 true
+   */
+  template <class Op>
+  auto ForEachMapWord(const void* addr, size_t bytes, Op op) const -> bool {
+    if (dirty_map_ == nullptr || bytes == 0) {
+      return true;
+    }
+    auto offset = reinterpret_cast<uintptr_t>(addr) - arena_start_;
+    size_t first = offset / kPageSize;
+    size_t last = (offset + bytes - 1) / kPageSize;
+    if (last >= dirty_pages_) {
+      last = dirty_pages_ - 1;
+    }
+    for (size_t page = first; page <= last;) {
+      size_t bit = page % 64;
+      size_t count = 64 - bit;
+      if (count > last - page + 1) {
+        count = last - page + 1;
+      }
+      uint64_t mask = count == 64 ? ~uint64_t{0}
+                                  : ((uint64_t{1} << count) - 1) << bit;
+      if (!op(page / 64, mask)) {
+        return false;
+      }
+      page += count;
+    }
+    return true;
+  }
+
+  /// 内存块覆盖的页是否都从未分配过；未启用页位图时返回 false
+  [[nodiscard]] auto IsClean(const void* addr, size_t bytes) const -> bool {
+    return dirty_map_ != nullptr &&
+           ForEachMapWord(addr, bytes, [this](size_t word, uint64_t mask) {
+             return (dirty_map_[word] & mask) == 0;
+           });
+  }
+
+  /// 将内存块覆盖的页标记为分配过
+  void MarkDirty(const void* addr, size_t bytes) {
+    ForEachMapWord(addr, bytes, [this](size_t word, uint64_t mask) {
+      dirty_map_[word] |= mask;
+      return true;
+    });
+  }
+
   [[nodiscard]] auto AllocImpl(size_t bytes) -> void* override {
     auto* ptr = buddy_malloc(buddy, bytes);
     if (!ptr) {
       Log("Buddy allocator %s failed to allocate %zu bytes\n", name_, bytes);
+    } else if (dirty_map_ != nullptr) {
+      MarkDirty(ptr, buddy_alloc_size(buddy, ptr));
     }
     return ptr;
   }
 
+  /**
+   * @brief 释放内存块
+   * @details buddy_alloc 没有按大小（order）释放的接口，bytes 不参与释放；
+   *          内存块的 order 由 buddy_free 在树中查找
+   */
   void FreeImpl(void* addr, [[maybe_unused]] size_t bytes = 0) override {
     buddy_free(buddy, addr);
   }
 
+  /**
+   * @brief 在 buddy 树中调整内存块大小
+   * @details 新大小与原块同级时直接返回。否则由 buddy_realloc 释放原内存块
+   *          并在树中重新查找新大小的空闲块：找到的块恰好从原地址开始时
+   *          （如原块是左侧的 buddy 且右侧空闲，或缩小为左半部分）不复制数据，
+   *          其余情况移动并复制数据，即使原位增长可行也可能移动
+   *          （原块是右侧的 buddy 且左侧空闲时移动到父块的起始地址）。
+   *          调用者必须使用返回的地址，失败时原内存块保持不变。
+   *          buddy_alloc 的公开接口无法占用树中指定的位置，因此这里不实现
+   *          与空闲 buddy 合并的原位增长，也不实现拆分出尾部的原位缩小
+   */
+  [[nodiscard]] auto ReallocImpl(void* addr, size_t bytes) -> void* override {
+    auto* ptr = buddy_realloc(buddy, addr, bytes, false);
+    if (!ptr) {
+      Log("Buddy allocator %s failed to reallocate %p to %zu bytes\n", name_,
+          addr, bytes);
+    } else if (dirty_map_ != nullptr) {
+      MarkDirty(ptr, buddy_alloc_size(buddy, ptr));
+    }
+    return ptr;
+  }
+
   [[nodiscard]] size_t AllocSizeImpl(
       [[maybe_unused]] void* addr) const override {
     return buddy_alloc_size(buddy, addr);
@@ -5,26 +5,81 @@
 #ifndef BMALLOC_SRC_INCLUDE_BUMP_HPP_
 #define BMALLOC_SRC_INCLUDE_BUMP_HPP_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <new>
+#include <utility>
 
 #include "allocator_base.hpp"
 
 namespace bmalloc {
 
 /**
- * @brief 极简 bump allocator
- * @details
- * 只支持向前线性分配，不真正回收内存，适合作为启动阶段或测试用的最小分配器。
+ * @brief bump allocator 的分配位置，由 Mark() 返回，交给 Rewind() 回退
+ */
+struct ArenaCheckpoint {
+  /// 分配位置所在的内存块，BumpAllocator 中为 nullptr
+  void* chunk_ = nullptr;
+  /// 下一次分配的起始地址
+  uintptr_t position_ = 0;
+};
+
+namespace detail {
+
+/// bump 分配的对齐字节数
+constexpr size_t kBumpAlign = alignof(max_align_t);
+
+/// 请求长度按 kBumpAlign 向上取整，溢出时返回 0
+constexpr auto BumpSize(size_t bytes) -> size_t {
+  auto size = (bytes + (kBumpAlign - 1)) & ~(kBumpAlign - 1);
+  return size < bytes ? 0 : size;
+}
+
+constexpr auto BumpAlignUp(uintptr_t value) -> uintptr_t {
+  return (value + (kBumpAlign - 1)) & ~static_cast<uintptr_t>(kBumpAlign - 1);
+}
+
+/**
+ * @brief 在 [*, end) 中无锁地向前分配 size 字节
+ * @param current 当前分配位置，始终按 kBumpAlign 对齐
+ * @param end 结束地址（开区间）
+ * @param size 按 kBumpAlign 取整后的长度
+ * @return void* 分配到的地址，空间不足时返回 nullptr 且不移动分配位置
+ */
+inline auto BumpAlloc(std::atomic<uintptr_t>& current, uintptr_t end,
+                      size_t size) -> void* {
+  auto cur = current.load(std::memory_order_relaxed);
+  do {
+    if (size > end - cur) {
+      return nullptr;
+    }
+  } while (!current.compare_exchange_weak(cur, cur + size,
+                                          std::memory_order_relaxed));
+  return reinterpret_cast<void*>(cur);
+}
+
+}  // namespace detail
+
+/**
+ * @brief 无锁的 bump allocator
+ * @details 只支持向前线性分配，Alloc() 通过原子 CAS 移动分配位置，不获取锁。
+ *          不能逐块释放，可以通过 Reset() 回收全部内存，或通过
+ *          Mark()/Rewind() 回退到之前的位置，适合作为请求级的临时内存。
  *          管理单位为字节，length 参数表示可管理的总字节数。
+ *          Reset()/Rewind() 不能与 Alloc() 并发，调用者需保证回收的内存
+ *          不再使用；SetTraceBuffer()/SetSampler() 同样不能与 Alloc()
+ *          并发，设置后 Alloc() 在锁内记录
  */
 template <class LogFunc = std::nullptr_t, class Lock = LockBase>
-class BumpAllocator : public AllocatorBase<LogFunc, Lock> {
+class BumpAllocator
+    : public StaticAllocatorBase<BumpAllocator<LogFunc, Lock>, LogFunc, Lock> {
  public:
   using Base = AllocatorBase<LogFunc, Lock>;
-  using Base::Alloc;
-  using Base::AllocSize;
-  using Base::Free;
+  using Dispatch =
+      StaticAllocatorBase<BumpAllocator<LogFunc, Lock>, LogFunc, Lock>;
+  using Dispatch::AllocSize;
+  using Dispatch::Free;
 
   /**
    * @brief 构造 bump allocator
@@ -33,25 +88,81 @@ class BumpAllocator : public AllocatorBase<LogFunc, Lock> {
    * @param bytes 管理的总字节数
    */
   explicit BumpAllocator(const char* name, void* start_addr, size_t bytes)
-      : Base(name, start_addr, bytes),
-        current_(reinterpret_cast<uintptr_t>(start_addr)),
-        end_(reinterpret_cast<uintptr_t>(start_addr) + bytes) {}
+      : Dispatch(name, start_addr, bytes),
+        begin_(detail::BumpAlignUp(reinterpret_cast<uintptr_t>(start_addr))),
+        current_(begin_),
+        end_(reinterpret_cast<uintptr_t>(start_addr) + bytes) {
+    if (begin_ > end_) {
+      begin_ = end_;
+      current_.store(end_, std::memory_order_relaxed);
+    }
+  }
 
   /// @name 构造/析构函数
   /// @{
   BumpAllocator() = default;
   BumpAllocator(const BumpAllocator&) = delete;
-  BumpAllocator(BumpAllocator&&) = default;
+  /// 移动不能与 Alloc() 并发
+  BumpAllocator(BumpAllocator&& other) noexcept
+      : Dispatch(std::move(other)),
+        begin_(other.begin_),
+        current_(other.current_.load(std::memory_order_relaxed)),
+        end_(other.end_) {}
   auto operator=(const BumpAllocator&) -> BumpAllocator& = delete;
-  auto operator=(BumpAllocator&&) -> BumpAllocator& = default;
+  auto operator=(BumpAllocator&&) -> BumpAllocator& = delete;
   ~BumpAllocator() override = default;
   /// @}
 
+  /**
+   * @brief 无锁地分配指定字节数的内存，按 max_align_t 对齐
+   * @param bytes 要分配的字节数
+   * @return void* 分配成功时返回内存地址，失败时返回nullptr
+   */
+  [[nodiscard]] auto Alloc(size_t bytes) -> void* {
+    void* ptr = AllocImpl(bytes);
+    if (this->trace_ != nullptr || this->sampler_ != nullptr) [[unlikely]] {
+      LockGuard guard(this->lock_);
+      this->Record(TraceOp::kAlloc, ptr, bytes);
+    }
+    return ptr;
+  }
+
+  /// 回收全部内存
+  void Reset() { current_.store(begin_, std::memory_order_relaxed); }
+
+  /// 记录当前的分配位置
+  [[nodiscard]] auto Mark() const -> ArenaCheckpoint {
+    return {nullptr, current_.load(std::memory_order_relaxed)};
+  }
+
+  /**
+   * @brief 回退到 Mark() 记录的位置，回收之后分配的所有内存
+   * @param checkpoint 由本分配器的 Mark() 返回的位置
+   */
+  void Rewind(const ArenaCheckpoint& checkpoint) {
+    current_.store(checkpoint.position_, std::memory_order_relaxed);
+  }
+
+  /// 已分配的字节数，由当前分配位置计算（无锁的分配不更新 used_count_）
+  [[nodiscard]] auto GetUsedCount() const -> size_t override {
+    return current_.load(std::memory_order_relaxed) -
+           reinterpret_cast<uintptr_t>(this->start_addr_);
+  }
+
+  /// 剩余的字节数，由当前分配位置计算
+  [[nodiscard]] auto GetFreeCount() const -> size_t override {
+    return end_ - current_.load(std::memory_order_relaxed);
+  }
+
  protected:
+  friend Dispatch;
+
   using Base::Log;
 
+  /// 第一次分配的地址，按 max_align_t 对齐
+  uintptr_t begin_ = 0;
   /// 当前分配指针
-  uintptr_t current_ = 0;
+  std::atomic<uintptr_t> current_{0};
   /// 管理区域结束地址（开区间）
   uintptr_t end_ = 0;
 
@@ -61,35 +172,17 @@ class BumpAllocator : public AllocatorBase<LogFunc, Lock> {
    * @return void* 分配成功时返回内存地址，失败时返回nullptr
    */
   [[nodiscard]] auto AllocImpl(size_t bytes) -> void* override {
-    if (bytes == 0) {
+    auto size = detail::BumpSize(bytes);
+    if (size == 0) {
       return nullptr;
     }
 
-    // 按 max_align_t 对齐
-    constexpr size_t align = alignof(max_align_t);
-    auto align_up = [](uintptr_t v, size_t a) {
-      return (v + (a - 1)) & ~(static_cast<uintptr_t>(a) - 1);
-    };
-
-    auto cur = align_up(current_, align);
-    auto next = cur + bytes;
-
-    if (next > end_) {
+    void* ptr = detail::BumpAlloc(current_, end_, size);
+    if (ptr == nullptr) {
       Log("Bump allocator '%s' out of memory: request=%zu, remain=%zu\n",
-          this->name_, bytes,
-          (end_ > cur) ? static_cast<size_t>(end_ - cur) : 0U);
-      return nullptr;
+          this->name_, bytes, GetFreeCount());
     }
-
-    current_ = next;
-
-    // 统计信息以字节为单位
-    this->used_count_ = static_cast<size_t>(
-        current_ - reinterpret_cast<uintptr_t>(this->start_addr_));
-    this->free_count_ =
-        (end_ > current_) ? static_cast<size_t>(end_ - current_) : 0U;
-
-    return reinterpret_cast<void*>(cur);
+    return ptr;
   }
 
   /**
@@ -99,7 +192,7 @@ class BumpAllocator : public AllocatorBase<LogFunc, Lock> {
    */
   void FreeImpl([[maybe_unused]] void* addr,
                 [[maybe_unused]] size_t length) override {
-    // 不做任何事情；如需重置整个区域，可额外提供 Reset() 接口
+    // 不做任何事情；通过 Reset() 或 Rewind() 整体回收
   }
 
   /**
@@ -113,6 +206,223 @@ class BumpAllocator : public AllocatorBase<LogFunc, Lock> {
   }
 };
 
+/**
+ * @brief 从上级页分配器按块获取内存的无锁 bump allocator
+ * @details 当前块用尽时在锁内从 PageAllocator 分配一个新块（至少 chunk_bytes
+ *          字节，能容纳超大请求），块之间通过块头链接。块内的分配通过原子 CAS
+ *          完成，只有换块时获取锁。Reset()/Rewind() 把多余的块归还给
+ *          PageAllocator，与 BumpAllocator 一样不能与 Alloc() 并发
+ * @tparam PageAllocator 上级页分配器，如 Buddy，Alloc/Free 以字节为单位
+ * @tparam LogFunc printf 风格的日志函数类型
+ * @tparam Lock 锁类型，保护换块过程
+ */
+template <class PageAllocator, class LogFunc = std::nullptr_t,
+          class Lock = LockBase>
+class ChainedArena
+    : public StaticAllocatorBase<ChainedArena<PageAllocator, LogFunc, Lock>,
+                                 LogFunc, Lock> {
+ public:
+  using Base = AllocatorBase<LogFunc, Lock>;
+  using Dispatch =
+      StaticAllocatorBase<ChainedArena<PageAllocator, LogFunc, Lock>, LogFunc,
+                          Lock>;
+  using Dispatch::AllocSize;
+  using Dispatch::Free;
+
+  /**
+   * @brief 构造链式 arena，第一次分配时才获取第一个块
+   * @param name 分配器名称
+   * @param parent 提供内存块的上级分配器，生命周期需长于本对象
+   * @param chunk_bytes 每个块的默认字节数（含块头）
+   */
+  explicit ChainedArena(const char* name, PageAllocator& parent,
+                        size_t chunk_bytes = kPageSize * 16)
+      : Dispatch(name, nullptr, 0),
+        parent_(parent),
+        chunk_bytes_(chunk_bytes) {}
+
+  /// @name 构造/析构函数
+  /// @{
+  ChainedArena(const ChainedArena&) = delete;
+  ChainedArena(ChainedArena&&) = delete;
+  auto operator=(const ChainedArena&) -> ChainedArena& = delete;
+  auto operator=(ChainedArena&&) -> ChainedArena& = delete;
+  ~ChainedArena() override { Release(nullptr); }
+  /// @}
+
+  /**
+   * @brief 无锁地分配指定字节数的内存，当前块用尽时换块
+   * @param bytes 要分配的字节数
+   * @return void* 分配成功时返回内存地址，失败时返回nullptr
+   */
+  [[nodiscard]] auto Alloc(size_t bytes) -> void* {
+    void* ptr = AllocImpl(bytes);
+    if (this->trace_ != nullptr || this->sampler_ != nullptr) [[unlikely]] {
+      LockGuard guard(this->lock_);
+      this->Record(TraceOp::kAlloc, ptr, bytes);
+    }
+    return ptr;
+  }
+
+  /// 回收全部内存，所有块归还给上级分配器
+  void Reset() {
+    LockGuard guard(chunk_lock_);
+    Release(nullptr);
+  }
+
+  /// 记录当前的分配位置
+  [[nodiscard]] auto Mark() const -> ArenaCheckpoint {
+    auto* chunk = current_.load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+      return {};
+    }
+    return {chunk, chunk->current_.load(std::memory_order_relaxed)};
+  }
+
+  /**
+   * @brief 回退到 Mark() 记录的位置，之后获取的块归还给上级分配器
+   * @param checkpoint 由本分配器的 Mark() 返回的位置
+   */
+  void Rewind(const ArenaCheckpoint& checkpoint) {
+    LockGuard guard(chunk_lock_);
+    auto* chunk = static_cast<chunk_t*>(checkpoint.chunk_);
+    Release(chunk);
+    if (chunk != nullptr) {
+      chunk->current_.store(checkpoint.position_, std::memory_order_relaxed);
+    }
+  }
+
+  /// 当前持有的块数
+  [[nodiscard]] auto GetChunkCount() const -> size_t {
+    size_t count = 0;
+    for (auto* chunk = current_.load(std::memory_order_acquire);
+         chunk != nullptr; chunk = chunk->prev_) {
+      count++;
+    }
+    return count;
+  }
+
+ protected:
+  friend Dispatch;
+
+  using Base::Log;
+
+  /// 块头，位于每个块的起始处
+  struct chunk_t {
+    /// 前一个块
+    chunk_t* prev_ = nullptr;
+    /// 块的结束地址（开区间）
+    uintptr_t end_ = 0;
+    /// 块内的分配位置
+    std::atomic<uintptr_t> current_{0};
+  };
+
+  PageAllocator& parent_;
+  /// 每个块的默认字节数
+  size_t chunk_bytes_;
+  /// 当前分配的块
+  std::atomic<chunk_t*> current_{nullptr};
+  /// 保护换块与回收，与 lock_ 分开，经由 AllocatorBase 的接口调用时不会重入
+  Lock chunk_lock_;
+
+  /// 将 keep 之后获取的块归还给上级分配器（调用者需持有 chunk_lock_）
+  void Release(chunk_t* keep) {
+    auto* chunk = current_.load(std::memory_order_relaxed);
+    while (chunk != nullptr && chunk != keep) {
+      auto* prev = chunk->prev_;
+      parent_.Free(chunk);
+      chunk = prev;
+    }
+    current_.store(chunk, std::memory_order_release);
+  }
+
+  [[nodiscard]] auto AllocImpl(size_t bytes) -> void* override {
+    auto size = detail::BumpSize(bytes);
+    if (size == 0) {
+      return nullptr;
+    }
+
+    auto* chunk = current_.load(std::memory_order_acquire);
+    if (chunk != nullptr) {
+      if (void* ptr = detail::BumpAlloc(chunk->current_, chunk->end_, size);
+          ptr != nullptr) {
+        return ptr;
+      }
+    }
+
+    LockGuard guard(chunk_lock_);
+    // 其它线程可能已经换过块
+    chunk = current_.load(std::memory_order_relaxed);
+    if (chunk != nullptr) {
+      if (void* ptr = detail::BumpAlloc(chunk->current_, chunk->end_, size);
+          ptr != nullptr) {
+        return ptr;
+      }
+    }
+
+    constexpr size_t kHeader = detail::BumpSize(sizeof(chunk_t));
+    if (size > SIZE_MAX - kHeader) {
+      return nullptr;
+    }
+    size_t chunk_bytes = chunk_bytes_;
+    if (chunk_bytes < size + kHeader) {
+      chunk_bytes = size + kHeader;
+    }
+    void* memory = parent_.Alloc(chunk_bytes);
+    if (memory == nullptr) {
+      Log("Chained arena '%s' failed to get a %zu-byte chunk\n", this->name_,
+          chunk_bytes);
+      return nullptr;
+    }
+
+    auto start = reinterpret_cast<uintptr_t>(memory);
+    auto* next = new (memory) chunk_t;
+    next->prev_ = chunk;
+    next->end_ = start + chunk_bytes;
+    // 新块在发布前由当前线程独占，第一次分配直接完成
+    auto* ptr = reinterpret_cast<void*>(start + kHeader);
+    next->current_.store(start + kHeader + size, std::memory_order_relaxed);
+    current_.store(next, std::memory_order_release);
+    return ptr;
+  }
+
+  void FreeImpl([[maybe_unused]] void* addr,
+                [[maybe_unused]] size_t length) override {}
+
+  [[nodiscard]] auto AllocSizeImpl([[maybe_unused]] void* addr) const
+      -> size_t override {
+    return 0;
+  }
+};
+
+/**
+ * @brief RAII 风格的临时 arena
+ * @details 构造时记录 Arena 的分配位置，析构时回退，作用域内分配的内存
+ *          全部回收。可以嵌套使用，内层需先于外层析构
+ * @tparam Arena BumpAllocator 或 ChainedArena
+ */
+template <class Arena>
+class ScopedArena {
+ public:
+  explicit ScopedArena(Arena& arena) : arena_(arena), mark_(arena.Mark()) {}
+
+  ScopedArena(const ScopedArena&) = delete;
+  ScopedArena(ScopedArena&&) = delete;
+  auto operator=(const ScopedArena&) -> ScopedArena& = delete;
+  auto operator=(ScopedArena&&) -> ScopedArena& = delete;
+
+  ~ScopedArena() { arena_.Rewind(mark_); }
+
+  /// 从 arena 分配内存，作用域结束时回收
+  [[nodiscard]] auto Alloc(size_t bytes) -> void* {
+    return arena_.Alloc(bytes);
+  }
+
+ private:
+  Arena& arena_;
+  ArenaCheckpoint mark_;
+};
+
 }  // namespace bmalloc
 
 #endif /* BMALLOC_SRC_INCLUDE_BUMP_HPP_ */
@@ -5,23 +5,36 @@
 #ifndef BMALLOC_SRC_INCLUDE_FIRST_FIT_HPP_
 #define BMALLOC_SRC_INCLUDE_FIRST_FIT_HPP_
 
-#include <bitset>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
 
 #include "allocator_base.hpp"
+#include "fit_policy.hpp"
 
 namespace bmalloc {
 
 /**
  * @brief First Fit 算法内存分配器
  * @details 使用位图来跟踪内存页的使用情况，支持分配和释放指定页数的内存。
+ *          位图按 64 位字处理，并使用摘要层（每一位表示一个已满的字）
+ *          跳过已满的区域。不超过 kInlinePages 页时位图位于对象内部，
+ *          否则位于调用者提供的缓冲区或管理内存的末尾。
+ * @tparam SearchPolicy 空闲页的搜索策略，见 fit_policy.hpp
+ * @tparam InlinePages 位图可以放在对象内部的最大页数，必须是 64 的正整数倍；
+ *         管理的页数固定时可以按目标调整，使位图总是位于对象内部
  */
-template <class LogFunc = std::nullptr_t, class Lock = LockBase>
-class FirstFit : public AllocatorBase<LogFunc, Lock> {
+template <class LogFunc = std::nullptr_t, class Lock = LockBase,
+          class SearchPolicy = FirstFitSearch, size_t InlinePages = 1024>
+class FirstFit
+    : public StaticAllocatorBase<
+          FirstFit<LogFunc, Lock, SearchPolicy, InlinePages>, LogFunc, Lock> {
  public:
-  using AllocatorBase<LogFunc, Lock>::Alloc;
-  using AllocatorBase<LogFunc, Lock>::Free;
+  using Dispatch =
+      StaticAllocatorBase<FirstFit<LogFunc, Lock, SearchPolicy, InlinePages>,
+                          LogFunc, Lock>;
+  using Dispatch::Alloc;
+  using Dispatch::Free;
   using AllocatorBase<LogFunc, Lock>::GetFreeCount;
   using AllocatorBase<LogFunc, Lock>::GetUsedCount;
 
@@ -30,12 +43,42 @@ class FirstFit : public AllocatorBase<LogFunc, Lock> {
    * @param name 分配器名称
    * @param start_addr 管理的内存起始地址
    * @param page_count 管理的页数
-   * @param log_func printf 风格的日志函数指针（可选）
+   * @note 页数超过 kInlinePages 时位图占用管理内存末尾的若干页，
+   *       这些页标记为已使用且不计入空闲页数
    */
   explicit FirstFit(const char* name, void* start_addr, size_t page_count)
-      : AllocatorBase<LogFunc, Lock>(name, start_addr, page_count) {
-    // 初始化位图为全0 (所有页面空闲)
-    bitmap_.reset();
+      : FirstFit(name, start_addr, page_count, nullptr) {}
+
+  /**
+   * @brief 构造First Fit分配器，位图位于调用者提供的缓冲区
+   * @param name 分配器名称
+   * @param start_addr 管理的内存起始地址
+   * @param page_count 管理的页数
+   * @param bitmap 至少 BitmapWords(page_count) 个字的缓冲区，
+   *        为 nullptr 时与三参数版本相同
+   */
+  explicit FirstFit(const char* name, void* start_addr, size_t page_count,
+                    uint64_t* bitmap)
+      : Dispatch(name, start_addr, page_count) {
+    size_t bitmap_pages = 0;
+    if (bitmap == nullptr && page_count > kInlinePages) {
+      // 位图放在管理内存的末尾
+      bitmap_pages =
+          (BitmapWords(page_count) * sizeof(uint64_t) + kPageSize - 1) /
+          kPageSize;
+      bitmap = reinterpret_cast<uint64_t*>(static_cast<char*>(start_addr) +
+                                           (page_count - bitmap_pages) *
+                                               kPageSize);
+    }
+    InitBitmap(bitmap);
+
+    // 位图占用的页标记为已使用
+    if (bitmap_pages != 0) {
+      MarkRange(page_count - bitmap_pages, bitmap_pages, true);
+      free_count_ -= bitmap_pages;
+    }
+
+    search_.Init(*this);
   }
 
   /// @name 构造/析构函数
@@ -48,11 +91,43 @@ class FirstFit : public AllocatorBase<LogFunc, Lock> {
   ~FirstFit() override = default;
   /// @}
 
+  /**
+   * @brief 计算管理指定页数所需的位图字数
+   * @param page_count 管理的页数
+   * @return size_t 位图与摘要层的总字数
+   */
+  static constexpr auto BitmapWords(size_t page_count) -> size_t {
+    size_t words = (page_count + kBitsPerWord - 1) / kBitsPerWord;
+    return words + (words + kBitsPerWord - 1) / kBitsPerWord;
+  }
+
  protected:
-  /// @todo 用 bitset 表示太浪费空间了
-  static constexpr size_t kMaxPages = 1024;
-  /// 位图，每一位表示一页内存，1 表示已使用，0 表示未使用
-  std::bitset<kMaxPages> bitmap_;
+  friend Dispatch;
+  friend SearchPolicy;
+
+  /// 每个位图字表示的页数
+  static constexpr size_t kBitsPerWord = 64;
+  /// 位图可以放在对象内部的最大页数
+  static constexpr size_t kInlinePages = InlinePages;
+  static_assert(kInlinePages > 0 && kInlinePages % kBitsPerWord == 0,
+                "InlinePages must be a positive multiple of 64");
+  /// 对象内部位图的字数（含摘要层）
+  static constexpr size_t kInlineWords =
+      kInlinePages / kBitsPerWord +
+      (kInlinePages / kBitsPerWord + kBitsPerWord - 1) / kBitsPerWord;
+  /// 每个位图字全部为 1
+  static constexpr uint64_t kFullWord = ~uint64_t{0};
+
+  /// 对象内部的位图，页数不超过 kInlinePages 时使用
+  uint64_t inline_bitmap_[kInlineWords]{};
+  /// 外部位图，nullptr 表示使用 inline_bitmap_
+  uint64_t* bitmap_ = nullptr;
+  /// 位图字数，每一位表示一页内存，1 表示已使用，0 表示未使用
+  size_t words_ = 0;
+  /// 摘要层字数，第 i 位为 1 表示第 i 个位图字已满
+  size_t summary_words_ = 0;
+  /// 搜索策略及其状态
+  SearchPolicy search_;
 
   using AllocatorBase<LogFunc, Lock>::Log;
   using AllocatorBase<LogFunc, Lock>::name_;
@@ -70,12 +145,12 @@ class FirstFit : public AllocatorBase<LogFunc, Lock> {
     if (page_count == 0 || page_count > free_count_) {
       Log("FirstFit allocator '%s' allocation failed: invalid page_count=%zu "
           "(free_count=%zu)\n",
-          name_, page_count, free_count_);
+          name_, page_count, static_cast<size_t>(free_count_));
       return nullptr;
     }
 
-    // 在位图中寻找连续的空闲页面
-    size_t start_idx = FindConsecutiveBits(page_count, false);
+    // 按搜索策略寻找连续的空闲页面
+    size_t start_idx = search_.Find(*this, page_count);
     if (start_idx == SIZE_MAX) {
       Log("FirstFit allocator '%s' allocation failed: no consecutive free "
           "pages "
@@ -85,9 +160,8 @@ class FirstFit : public AllocatorBase<LogFunc, Lock> {
     }
 
     // 标记这些页面为已使用
-    for (size_t i = start_idx; i < start_idx + page_count; ++i) {
-      bitmap_[i] = true;
-    }
+    MarkRange(start_idx, page_count, true);
+    search_.OnAlloc(*this, start_idx, page_count);
 
     // 计算实际物理地址
     void* allocated_addr = static_cast<char*>(const_cast<void*>(start_addr_)) +
@@ -135,9 +209,8 @@ class FirstFit : public AllocatorBase<LogFunc, Lock> {
     }
 
     // 标记页面为空闲
-    for (size_t i = start_idx; i < start_idx + page_count; ++i) {
-      bitmap_[i] = false;
-    }
+    MarkRange(start_idx, page_count, false);
+    search_.OnFree(*this, start_idx, page_count);
     // 更新统计信息
     free_count_ += page_count;
     used_count_ -= page_count;
@@ -158,29 +231,254 @@ class FirstFit : public AllocatorBase<LogFunc, Lock> {
       return SIZE_MAX;
     }
 
-    size_t count = 0;
-    size_t start_idx = 0;
+    size_t idx = FindRun(length, value, 0);
+    if (idx == SIZE_MAX) {
+      Log("FirstFit allocator '%s' search failed: no %zu consecutive %s "
+          "pages found\n",
+          name_, length, value ? "used" : "free");
+    }
+    return idx;
+  }
+
+  /**
+   * @brief 从指定位置开始查找连续的指定值的位序列
+   * @param length 需要连续的位数
+   * @param value 要查找的位值
+   * @param from 起始索引，之前的位不参与查找
+   * @return size_t 开始索引，如果未找到返回SIZE_MAX
+   */
+  [[nodiscard]] auto FindRun(size_t length, bool value, size_t from) const
+      -> size_t {
+    if (length == 0 || from >= length_ || length > length_ - from) {
+      return SIZE_MAX;
+    }
+
+    const uint64_t* words = Words();
+    // 当前连续段的长度与起始位置
+    size_t run = 0;
+    size_t run_start = 0;
 
-    // 遍历位图寻找连续的指定值位
-    for (size_t i = 0; i < length_; ++i) {
-      if (bitmap_[i] == value) {
-        if (count == 0) {
-          start_idx = i;
+    size_t idx = from / kBitsPerWord;
+    while (idx < words_) {
+      // 查找空闲页且不在连续段中时，通过摘要层跳过已满的字
+      if (!value && run == 0) {
+        idx = NextNonFullWord(idx);
+        if (idx >= words_) {
+          break;
         }
-        ++count;
-        if (count == length) {
-          return start_idx;
+      }
+
+      uint64_t match = value ? words[idx] : ~words[idx];
+      // 最后一个字中超出 length_ 的位不参与匹配
+      if (idx == words_ - 1 && length_ % kBitsPerWord != 0) {
+        match &= (uint64_t{1} << (length_ % kBitsPerWord)) - 1;
+      }
+      // 第一个字中 from 之前的位不参与匹配
+      if (idx == from / kBitsPerWord) {
+        match &= kFullWord << (from % kBitsPerWord);
+      }
+
+      if (run == 0) {
+        run_start = idx * kBitsPerWord;
+      }
+
+      // 整个字都匹配，连续段延续
+      if (match == kFullWord) {
+        run += kBitsPerWord;
+        if (run >= length) {
+          return run_start;
+        }
+        ++idx;
+        continue;
+      }
+
+      // 低位的连续匹配位与上一个字的连续段相接
+      if (run + std::countr_one(match) >= length) {
+        return run_start;
+      }
+
+      // 字内部的连续段
+      if (length < kBitsPerWord) {
+        size_t pos = FindRunInWord(match, length);
+        if (pos != kBitsPerWord) {
+          return idx * kBitsPerWord + pos;
         }
-      } else {
-        count = 0;
       }
+
+      // 高位的连续匹配位开始新的连续段
+      run = std::countl_one(match);
+      run_start = (idx + 1) * kBitsPerWord - run;
+      ++idx;
     }
 
-    Log("FirstFit allocator '%s' search failed: no %zu consecutive %s pages "
-        "found\n",
-        name_, length, value ? "used" : "free");
     return SIZE_MAX;
   }
+
+  /// 指定页是否空闲
+  [[nodiscard]] auto IsFree(size_t page) const -> bool {
+    return (Words()[page / kBitsPerWord] >> (page % kBitsPerWord) & 1) == 0;
+  }
+
+  /**
+   * @brief 查找包含指定空闲页的空闲区间的起始页
+   * @param page 空闲页索引
+   * @return size_t 起始页索引
+   */
+  [[nodiscard]] auto RunBegin(size_t page) const -> size_t {
+    const auto* words = Words();
+    size_t idx = page / kBitsPerWord;
+    size_t bit = page % kBitsPerWord;
+    // page 及其之前的已使用位
+    uint64_t used = words[idx] & (bit == kBitsPerWord - 1
+                                      ? kFullWord
+                                      : (uint64_t{1} << (bit + 1)) - 1);
+    while (used == 0) {
+      if (idx == 0) {
+        return 0;
+      }
+      used = words[--idx];
+    }
+    return idx * kBitsPerWord + kBitsPerWord - std::countl_zero(used);
+  }
+
+  /**
+   * @brief 查找从指定空闲页开始的空闲区间的结束页
+   * @param page 空闲页索引
+   * @return size_t 空闲区间之后第一个已使用页的索引，最大为 length_
+   */
+  [[nodiscard]] auto RunEnd(size_t page) const -> size_t {
+    const auto* words = Words();
+    size_t idx = page / kBitsPerWord;
+    uint64_t used = words[idx] & (kFullWord << (page % kBitsPerWord));
+    while (used == 0) {
+      if (++idx >= words_) {
+        return length_;
+      }
+      used = words[idx];
+    }
+    size_t end = idx * kBitsPerWord + std::countr_zero(used);
+    return end < length_ ? end : length_;
+  }
+
+  /// 页索引对应的地址
+  [[nodiscard]] auto PageAddress(size_t page) const -> void* {
+    return static_cast<char*>(const_cast<void*>(start_addr_)) +
+           kPageSize * page;
+  }
+
+  /// 位图起始地址
+  [[nodiscard]] auto Words() -> uint64_t* {
+    return bitmap_ != nullptr ? bitmap_ : inline_bitmap_;
+  }
+  [[nodiscard]] auto Words() const -> const uint64_t* {
+    return bitmap_ != nullptr ? bitmap_ : inline_bitmap_;
+  }
+
+  /// 摘要层起始地址，紧跟在位图之后
+  [[nodiscard]] auto Summary() -> uint64_t* { return Words() + words_; }
+  [[nodiscard]] auto Summary() const -> const uint64_t* {
+    return Words() + words_;
+  }
+
+  /**
+   * @brief 初始化位图与摘要层
+   * @param bitmap 外部位图，nullptr 表示使用对象内部的位图
+   */
+  void InitBitmap(uint64_t* bitmap) {
+    bitmap_ = bitmap;
+    words_ = (length_ + kBitsPerWord - 1) / kBitsPerWord;
+    summary_words_ = (words_ + kBitsPerWord - 1) / kBitsPerWord;
+
+    // 所有页面空闲，最后一个字中超出 length_ 的位标记为已使用
+    auto* words = Words();
+    for (size_t i = 0; i < words_; ++i) {
+      words[i] = 0;
+    }
+    if (length_ % kBitsPerWord != 0) {
+      words[words_ - 1] = kFullWord << (length_ % kBitsPerWord);
+    }
+
+    // 超出 words_ 的摘要位标记为已满
+    auto* summary = Summary();
+    for (size_t i = 0; i < summary_words_; ++i) {
+      summary[i] = 0;
+    }
+    if (words_ % kBitsPerWord != 0) {
+      summary[summary_words_ - 1] = kFullWord << (words_ % kBitsPerWord);
+    }
+  }
+
+  /**
+   * @brief 将一段连续页面标记为已使用或空闲，并更新摘要层
+   * @param start 起始页索引
+   * @param count 页数
+   * @param used true 表示已使用，false 表示空闲
+   */
+  void MarkRange(size_t start, size_t count, bool used) {
+    auto* words = Words();
+    auto* summary = Summary();
+    size_t idx = start / kBitsPerWord;
+    size_t bit = start % kBitsPerWord;
+    while (count > 0) {
+      size_t n = count < kBitsPerWord - bit ? count : kBitsPerWord - bit;
+      uint64_t mask = n == kBitsPerWord ? kFullWord
+                                        : ((uint64_t{1} << n) - 1) << bit;
+      if (used) {
+        words[idx] |= mask;
+      } else {
+        words[idx] &= ~mask;
+      }
+
+      uint64_t summary_bit = uint64_t{1} << (idx % kBitsPerWord);
+      if (words[idx] == kFullWord) {
+        summary[idx / kBitsPerWord] |= summary_bit;
+      } else {
+        summary[idx / kBitsPerWord] &= ~summary_bit;
+      }
+
+      count -= n;
+      ++idx;
+      bit = 0;
+    }
+  }
+
+  /**
+   * @brief 通过摘要层查找从 idx 开始的第一个未满的位图字
+   * @param idx 起始字索引
+   * @return size_t 字索引，不存在时返回不小于 words_ 的值
+   */
+  [[nodiscard]] auto NextNonFullWord(size_t idx) const -> size_t {
+    const auto* summary = Summary();
+    size_t s = idx / kBitsPerWord;
+    if (s >= summary_words_) {
+      return words_;
+    }
+    uint64_t candidates = ~summary[s] & (kFullWord << (idx % kBitsPerWord));
+    while (candidates == 0) {
+      if (++s >= summary_words_) {
+        return words_;
+      }
+      candidates = ~summary[s];
+    }
+    return s * kBitsPerWord + std::countr_zero(candidates);
+  }
+
+  /**
+   * @brief 在一个字中查找长度为 length 的连续 1
+   * @param bits 要查找的字
+   * @param length 连续段长度，小于 kBitsPerWord
+   * @return size_t 最低的起始位，不存在时返回 kBitsPerWord
+   */
+  static auto FindRunInWord(uint64_t bits, size_t length) -> size_t {
+    // 每轮之后 bits 的第 i 位表示从 i 开始至少有 covered 个连续的 1
+    size_t covered = 1;
+    while (covered < length && bits != 0) {
+      size_t shift = covered < length - covered ? covered : length - covered;
+      bits &= bits >> shift;
+      covered += shift;
+    }
+    return bits == 0 ? kBitsPerWord : std::countr_zero(bits);
+  }
 };
 
 }  // namespace bmalloc
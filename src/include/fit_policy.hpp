@@ -0,0 +1,272 @@
+/**
+ * Copyright The bmalloc Contributors
+ */
+
+#ifndef BMALLOC_SRC_INCLUDE_FIT_POLICY_HPP_
+#define BMALLOC_SRC_INCLUDE_FIT_POLICY_HPP_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace bmalloc {
+
+/**
+ * @brief FirstFit 的搜索策略
+ * @details 每个策略提供以下接口，由 FirstFit 在持有锁时调用：
+ *          - Init(allocator)：位图初始化完成后调用
+ *          - Find(allocator, length)：返回 length 个连续空闲页的起始页索引，
+ *            失败时返回 SIZE_MAX
+ *          - OnAlloc(allocator, start, count)：页面标记为已使用后调用
+ *          - OnFree(allocator, start, count)：页面标记为空闲后调用
+ */
+
+/**
+ * @brief 首次适应：每次从第 0 页开始查找
+ */
+struct FirstFitSearch {
+  template <class Allocator>
+  void Init(Allocator&) {}
+
+  template <class Allocator>
+  [[nodiscard]] auto Find(const Allocator& allocator, size_t length) const
+      -> size_t {
+    return allocator.FindRun(length, false, 0);
+  }
+
+  template <class Allocator>
+  void OnAlloc(Allocator&, size_t, size_t) {}
+
+  template <class Allocator>
+  void OnFree(Allocator&, size_t, size_t) {}
+};
+
+/**
+ * @brief 循环首次适应：从上次分配结束的位置开始查找，到末尾后回绕
+ * @details 长期存在的分配不会让每次查找都重新扫描区域开头
+ */
+struct NextFitSearch {
+  template <class Allocator>
+  void Init(Allocator&) {
+    cursor_ = 0;
+  }
+
+  template <class Allocator>
+  [[nodiscard]] auto Find(const Allocator& allocator, size_t length) const
+      -> size_t {
+    size_t idx = allocator.FindRun(length, false, cursor_);
+    if (idx == SIZE_MAX && cursor_ != 0) {
+      idx = allocator.FindRun(length, false, 0);
+    }
+    return idx;
+  }
+
+  template <class Allocator>
+  void OnAlloc(Allocator& allocator, size_t start, size_t count) {
+    cursor_ = start + count;
+    if (cursor_ >= allocator.length_) {
+      cursor_ = 0;
+    }
+  }
+
+  template <class Allocator>
+  void OnFree(Allocator&, size_t, size_t) {}
+
+  /// 下一次查找的起始页索引
+  size_t cursor_ = 0;
+};
+
+/**
+ * @brief 最佳适应：选择不小于请求的最小空闲区间
+ * @details 空闲区间按长度分桶索引：小于 kExactLengths 页的区间每种长度一个桶，
+ *          更长的区间每个 2 倍区间划分为 kSubBuckets 个桶，并用位图记录非空的桶。
+ *          区间节点保存在该区间的第一个空闲页中，因此被管理的内存必须可写。
+ *          查找时在请求长度所在的桶中选择最小的足够大的区间，没有时通过位图
+ *          找到更高的第一个非空桶并选择其中最小的区间；分配与释放时通过位图
+ *          找到相邻的空闲区间进行拆分与合并。
+ */
+class BestFitSearch {
+ public:
+  template <class Allocator>
+  void Init(Allocator& allocator) {
+    for (auto& bucket : buckets_) {
+      bucket = nullptr;
+    }
+    for (auto& word : nonempty_) {
+      word = 0;
+    }
+    // 将位图中的每个空闲区间加入索引
+    size_t page = allocator.FindRun(1, false, 0);
+    while (page != SIZE_MAX) {
+      size_t end = allocator.RunEnd(page);
+      Insert(allocator, page, end - page);
+      page = end < allocator.length_ ? allocator.FindRun(1, false, end)
+                                     : SIZE_MAX;
+    }
+  }
+
+  template <class Allocator>
+  [[nodiscard]] auto Find(const Allocator&, size_t length) const -> size_t {
+    if (length == 0) {
+      return SIZE_MAX;
+    }
+    size_t k = BucketIndex(length);
+    const Extent* best = BestInBucket(k, length);
+    if (best == nullptr) {
+      // 更高的桶中所有区间都足够大
+      k = NextNonEmptyBucket(k + 1);
+      if (k < kBucketCount) {
+        best = BestInBucket(k, length);
+      }
+    }
+    return best != nullptr ? best->start_ : SIZE_MAX;
+  }
+
+  template <class Allocator>
+  void OnAlloc(Allocator& allocator, size_t start, size_t count) {
+    // 包含 [start, start + count) 的空闲区间从 begin 开始
+    size_t begin = start;
+    if (start > 0 && allocator.IsFree(start - 1)) {
+      begin = allocator.RunBegin(start - 1);
+    }
+    auto* extent = NodeAt(allocator, begin);
+    size_t end = extent->start_ + extent->length_;
+    Remove(extent);
+
+    // 剩余的部分重新加入索引
+    if (begin < start) {
+      Insert(allocator, begin, start - begin);
+    }
+    if (start + count < end) {
+      Insert(allocator, start + count, end - start - count);
+    }
+  }
+
+  template <class Allocator>
+  void OnFree(Allocator& allocator, size_t start, size_t count) {
+    size_t begin = start;
+    size_t end = start + count;
+    // 与左侧的空闲区间合并
+    if (start > 0 && allocator.IsFree(start - 1)) {
+      begin = allocator.RunBegin(start - 1);
+      Remove(NodeAt(allocator, begin));
+    }
+    // 与右侧的空闲区间合并
+    if (end < allocator.length_ && allocator.IsFree(end)) {
+      auto* right = NodeAt(allocator, end);
+      end = right->start_ + right->length_;
+      Remove(right);
+    }
+    Insert(allocator, begin, end - begin);
+  }
+
+ private:
+  /// 空闲区间节点，位于区间的第一页
+  struct Extent {
+    size_t start_;
+    size_t length_;
+    Extent* next_;
+    Extent* prev_;
+  };
+
+  /// 小于该长度的区间每种长度一个桶
+  static constexpr size_t kExactLengths = 64;
+  /// 每个 2 倍区间划分的桶数
+  static constexpr size_t kSubBuckets = 8;
+  /// 桶的数量
+  static constexpr size_t kBucketCount =
+      kExactLengths +
+      (64 - std::bit_width(kExactLengths - 1)) * kSubBuckets;
+  /// 非空桶位图的字数
+  static constexpr size_t kNonEmptyWords = (kBucketCount + 63) / 64;
+
+  static constexpr auto BucketIndex(size_t length) -> size_t {
+    if (length < kExactLengths) {
+      return length;
+    }
+    size_t shift = std::bit_width(length) - 1;
+    size_t sub = (length >> (shift - std::bit_width(kSubBuckets - 1))) &
+                 (kSubBuckets - 1);
+    return kExactLengths +
+           (shift - std::bit_width(kExactLengths - 1)) * kSubBuckets + sub;
+  }
+
+  /// 在第 k 个桶中选择不小于 length 的最小区间
+  [[nodiscard]] auto BestInBucket(size_t k, size_t length) const
+      -> const Extent* {
+    const Extent* best = nullptr;
+    for (auto* extent = buckets_[k]; extent != nullptr;
+         extent = extent->next_) {
+      if (extent->length_ >= length &&
+          (best == nullptr || extent->length_ < best->length_)) {
+        best = extent;
+        // 按长度精确分桶时第一个区间就是最佳的
+        if (k < kExactLengths || best->length_ == length) {
+          break;
+        }
+      }
+    }
+    return best;
+  }
+
+  /// 查找从第 k 个桶开始的第一个非空桶，不存在时返回 kBucketCount
+  [[nodiscard]] auto NextNonEmptyBucket(size_t k) const -> size_t {
+    size_t idx = k / 64;
+    if (idx >= kNonEmptyWords) {
+      return kBucketCount;
+    }
+    uint64_t bits = nonempty_[idx] & (~uint64_t{0} << (k % 64));
+    while (bits == 0) {
+      if (++idx >= kNonEmptyWords) {
+        return kBucketCount;
+      }
+      bits = nonempty_[idx];
+    }
+    return idx * 64 + std::countr_zero(bits);
+  }
+
+  template <class Allocator>
+  static auto NodeAt(Allocator& allocator, size_t page) -> Extent* {
+    return static_cast<Extent*>(allocator.PageAddress(page));
+  }
+
+  template <class Allocator>
+  void Insert(Allocator& allocator, size_t start, size_t length) {
+    auto* extent = NodeAt(allocator, start);
+    size_t k = BucketIndex(length);
+    auto& head = buckets_[k];
+    extent->start_ = start;
+    extent->length_ = length;
+    extent->prev_ = nullptr;
+    extent->next_ = head;
+    if (head != nullptr) {
+      head->prev_ = extent;
+    }
+    head = extent;
+    nonempty_[k / 64] |= uint64_t{1} << (k % 64);
+  }
+
+  void Remove(Extent* extent) {
+    if (extent->prev_ != nullptr) {
+      extent->prev_->next_ = extent->next_;
+    } else {
+      size_t k = BucketIndex(extent->length_);
+      buckets_[k] = extent->next_;
+      if (buckets_[k] == nullptr) {
+        nonempty_[k / 64] &= ~(uint64_t{1} << (k % 64));
+      }
+    }
+    if (extent->next_ != nullptr) {
+      extent->next_->prev_ = extent->prev_;
+    }
+  }
+
+  /// 按长度分桶的空闲区间链表
+  Extent* buckets_[kBucketCount]{};
+  /// 第 k 位为 1 表示第 k 个桶非空
+  uint64_t nonempty_[kNonEmptyWords]{};
+};
+
+}  // namespace bmalloc
+
+#endif /* BMALLOC_SRC_INCLUDE_FIT_POLICY_HPP_ */
@@ -0,0 +1,567 @@
+/**
+ * Copyright The bmalloc Contributors
+ */
+
+#ifndef BMALLOC_SRC_INCLUDE_HUGE_PAGE_HPP_
+#define BMALLOC_SRC_INCLUDE_HUGE_PAGE_HPP_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include "allocator_base.hpp"
+
+namespace bmalloc {
+
+/**
+ * @brief 大页的打包策略
+ * @details 策略提供以下成员：
+ *          - kClassCount：共享大页的分组数
+ *          - Class(bytes)：小于一个大页的请求所属的分组，
+ *            一个非空的共享大页只容纳同一分组的请求
+ *          - kFullestFirst：为 true 时选择空闲页最少的可用大页，
+ *            否则选择地址最低的可用大页
+ */
+
+/**
+ * @brief 默认的打包策略
+ * @details 不超过 kSmallLimit 的请求（slab 页等小对象的内存）与更大的请求
+ *          分别使用各自的共享大页，并优先放入空闲页最少的大页：
+ *          生命周期短的小对象反复申请与释放的页集中在已经被占用的大页中，
+ *          少量使用的大页得以完全释放，不会因为一个存活的对象而被钉住；
+ *          中等大小的长期缓冲区也不会钉住小对象所在的大页
+ */
+struct DensePacking {
+  static constexpr size_t kClassCount = 2;
+  /// 不超过该大小的请求属于小对象分组
+  static constexpr size_t kSmallLimit = kPageSize * 16;
+  static constexpr bool kFullestFirst = true;
+
+  static constexpr auto Class(size_t bytes) -> size_t {
+    return bytes <= kSmallLimit ? 0 : 1;
+  }
+};
+
+/**
+ * @brief 按地址顺序打包
+ * @details 所有请求共用一个分组，选择地址最低的可用大页，用于对比
+ */
+struct AddressOrderPacking {
+  static constexpr size_t kClassCount = 1;
+  static constexpr bool kFullestFirst = false;
+
+  static constexpr auto Class([[maybe_unused]] size_t bytes) -> size_t {
+    return 0;
+  }
+};
+
+/**
+ * @brief 大页感知的页分配器
+ * @details 将管理的内存划分为按 HugePageSize 对齐的大页（extent），
+ *          调用者可以用大页映射每个 extent。
+ *          - 不小于一个大页的请求占用连续的整个大页，从高地址开始查找
+ *          - 更小的请求在同一分组的共享大页中按页分配，起始页按请求页数
+ *            向上取整到 2 的幂对齐（与 buddy 块一样自然对齐）；
+ *            没有可用的共享大页时从低地址开始取一个空的大页
+ *          - 共享大页的页全部释放后重新变为空的大页
+ *          每个大页的页位图与块结束位图保存在区域起始处，
+ *          第一个大页从元数据之后的第一个大页边界开始。
+ *          构造参数与 Buddy 相同，可以作为 Slab 与 Bmalloc 的页分配器。
+ *          分配时线性扫描大页元数据，适合大页数不多的堆
+ * @tparam LogFunc printf 风格的日志函数类型
+ * @tparam Lock 锁类型
+ * @tparam PackingPolicy 共享大页的打包策略
+ * @tparam HugePageSize 大页大小，必须是 kPageSize 的 2 的幂倍
+ *         且不少于 64 页
+ */
+template <class LogFunc = std::nullptr_t, class Lock = LockBase,
+          class PackingPolicy = DensePacking,
+          size_t HugePageSize = size_t{2} << 20>
+class HugePageAllocator
+    : public StaticAllocatorBase<
+          HugePageAllocator<LogFunc, Lock, PackingPolicy, HugePageSize>,
+          LogFunc, Lock> {
+ public:
+  using Dispatch = StaticAllocatorBase<
+      HugePageAllocator<LogFunc, Lock, PackingPolicy, HugePageSize>, LogFunc,
+      Lock>;
+  using Dispatch::Alloc;
+  using Dispatch::AllocSize;
+  using Dispatch::Free;
+  using Dispatch::Realloc;
+
+  /// 大页大小
+  static constexpr size_t kHugePageSize = HugePageSize;
+  /// 每个大页的页数
+  static constexpr size_t kPagesPerExtent = kHugePageSize / kPageSize;
+
+  static_assert(std::has_single_bit(kHugePageSize) &&
+                    kHugePageSize % kPageSize == 0 &&
+                    kPagesPerExtent % 64 == 0,
+                "huge page must be a power of 2 holding at least 64 pages");
+  static_assert(PackingPolicy::kClassCount > 0);
+
+  /**
+   * @brief 构造大页分配器
+   * @param name 分配器名称
+   * @param addr 管理的内存起始地址
+   * @param bytes 管理的字节数；起始地址之后第一个大页边界之前的内存与
+   *        末尾不足一个大页的内存不被使用
+   * @param zeroed 内存是否已全部清零，为 true 时 AllocZeroed()
+   *        对从未分配过的页不再清零
+   */
+  explicit HugePageAllocator(const char* name, void* addr, size_t bytes,
+                             bool zeroed = false)
+      : Dispatch(name, addr, bytes), zeroed_(zeroed) {
+    auto start = reinterpret_cast<uintptr_t>(addr);
+    auto end = start + bytes;
+    size_t count = bytes / kHugePageSize;
+    while (count > 0 &&
+           AlignUp(start + count * sizeof(extent_t), kHugePageSize) +
+                   count * kHugePageSize >
+               end) {
+      count--;
+    }
+    this->free_count_ = count * kHugePageSize;
+    if (count == 0) {
+      Log("HugePageAllocator %s: %zu bytes at %p hold no huge page\n", name,
+          bytes, addr);
+      return;
+    }
+    extents_ = reinterpret_cast<extent_t*>(addr);
+    extent_count_ = count;
+    base_ = AlignUp(start + count * sizeof(extent_t), kHugePageSize);
+    for (size_t i = 0; i < count; i++) {
+      new (&extents_[i]) extent_t{};
+    }
+    Log("HugePageAllocator %s: %zu huge pages at %p\n", name, count,
+        reinterpret_cast<void*>(base_));
+  }
+
+  /// @name 构造/析构函数
+  /// @{
+  HugePageAllocator() = default;
+  HugePageAllocator(const HugePageAllocator&) = delete;
+  HugePageAllocator(HugePageAllocator&&) = default;
+  auto operator=(const HugePageAllocator&) -> HugePageAllocator& = delete;
+  auto operator=(HugePageAllocator&&) -> HugePageAllocator& = default;
+  ~HugePageAllocator() override = default;
+  /// @}
+
+  /**
+   * @brief 分配内存并保证前 bytes 字节为 0
+   * @details 构造时声明内存已清零时，内存块覆盖的页都从未分配过则跳过清零；
+   *          否则在锁外清零
+   * @param bytes 要分配的字节数
+   * @return void* 分配到的地址，失败时返回 nullptr
+   */
+  [[nodiscard]] auto AllocZeroed(size_t bytes) -> void* {
+    void* ptr = nullptr;
+    bool clean = false;
+    {
+      LockGuard guard(this->lock_);
+      ptr = AllocBlock(bytes, &clean);
+      this->Record(TraceOp::kAlloc, ptr, bytes);
+    }
+    if (ptr != nullptr && !clean) {
+      std::memset(ptr, 0, bytes);
+    }
+    return ptr;
+  }
+
+  /// 管理的大页数
+  [[nodiscard]] auto GetExtentCount() const -> size_t { return extent_count_; }
+
+  /// 没有任何页被使用的大页数
+  [[nodiscard]] auto GetFreeExtentCount() -> size_t {
+    LockGuard guard(this->lock_);
+    size_t n = 0;
+    for (size_t i = 0; i < extent_count_; i++) {
+      n += extents_[i].kind_ == kEmpty ? 1 : 0;
+    }
+    return n;
+  }
+
+  /// 第一个大页的起始地址，按 kHugePageSize 对齐
+  [[nodiscard]] auto GetExtentBase() const -> void* {
+    return reinterpret_cast<void*>(base_);
+  }
+
+ protected:
+  friend Dispatch;
+
+  using AllocatorBase<LogFunc, Lock>::Log;
+  using AllocatorBase<LogFunc, Lock>::name_;
+
+  /// 每个大页位图的字数
+  static constexpr size_t kWords = kPagesPerExtent / 64;
+
+  /// 大页的状态
+  enum ExtentKind : uint8_t {
+    /// 没有被使用
+    kEmpty = 0,
+    /// 按页分配的共享大页
+    kShared = 1,
+    /// 整页分配的第一个大页
+    kWholeHead = 2,
+    /// 整页分配的其余大页
+    kWholeTail = 3,
+  };
+
+  /// 一个大页的元数据
+  struct extent_t {
+    /// 第 i 位为 1 表示第 i 页已使用
+    uint64_t used_[kWords];
+    /// 第 i 位为 1 表示第 i 页是一个内存块的最后一页
+    uint64_t ends_[kWords];
+    /// 第 i 位为 1 表示第 i 页分配过，可能不为 0（只在 zeroed_ 时维护）
+    uint64_t dirty_[kWords];
+    /// 空闲页数
+    uint32_t free_pages_ = kPagesPerExtent;
+    /// 整页分配时占用的大页数（只对 kWholeHead 有效）
+    uint32_t run_ = 0;
+    /// 大页的状态
+    ExtentKind kind_ = kEmpty;
+    /// 共享大页所属的分组
+    uint8_t class_ = 0;
+  };
+
+  /// 大页元数据数组，位于管理区域的起始处
+  extent_t* extents_ = nullptr;
+  /// 大页数
+  size_t extent_count_ = 0;
+  /// 第一个大页的起始地址
+  uintptr_t base_ = 0;
+  /// 管理的内存是否已清零
+  bool zeroed_ = false;
+
+  static constexpr auto AlignUp(uintptr_t value, size_t align) -> uintptr_t {
+    return (value + align - 1) & ~(uintptr_t{align} - 1);
+  }
+
+  /// [first, first + count) 页在位图中对应的每个字调用 op(字下标, 掩码)
+  template <class Op>
+  static auto ForEachWord(size_t first, size_t count, Op op) -> bool {
+    while (count > 0) {
+      size_t bit = first % 64;
+      size_t n = 64 - bit < count ? 64 - bit : count;
+      uint64_t mask =
+          n == 64 ? ~uint64_t{0} : ((uint64_t{1} << n) - 1) << bit;
+      if (!op(first / 64, mask)) {
+        return false;
+      }
+      first += n;
+      count -= n;
+    }
+    return true;
+  }
+
+  [[nodiscard]] auto ExtentAddr(size_t index) const -> uintptr_t {
+    return base_ + index * kHugePageSize;
+  }
+
+  /// 地址所在的大页下标，不在管理范围内时返回 extent_count_
+  [[nodiscard]] auto ExtentIndex(const void* addr) const -> size_t {
+    auto value = reinterpret_cast<uintptr_t>(addr);
+    if (extent_count_ == 0 || value < base_ ||
+        value >= ExtentAddr(extent_count_)) {
+      return extent_count_;
+    }
+    return (value - base_) / kHugePageSize;
+  }
+
+  [[nodiscard]] static auto PagesOf(size_t bytes) -> size_t {
+    return (bytes + kPageSize - 1) / kPageSize;
+  }
+
+  /// 在大页中查找 pages 个连续空闲页，起始页按 align 页对齐
+  [[nodiscard]] static auto FindRun(const extent_t& extent, size_t pages,
+                                    size_t align) -> size_t {
+    for (size_t first = 0; first + pages <= kPagesPerExtent; first += align) {
+      if (ForEachWord(first, pages, [&](size_t word, uint64_t mask) {
+            return (extent.used_[word] & mask) == 0;
+          })) {
+        return first;
+      }
+    }
+    return kPagesPerExtent;
+  }
+
+  /// 在共享大页中标记 [first, first + pages) 为一个已使用的内存块
+  void TakePages(extent_t& extent, size_t first, size_t pages, bool* clean) {
+    bool untouched = zeroed_;
+    ForEachWord(first, pages, [&](size_t word, uint64_t mask) {
+      extent.used_[word] |= mask;
+      if (zeroed_) {
+        untouched = untouched && (extent.dirty_[word] & mask) == 0;
+        extent.dirty_[word] |= mask;
+      }
+      return true;
+    });
+    size_t last = first + pages - 1;
+    extent.ends_[last / 64] |= uint64_t{1} << (last % 64);
+    extent.free_pages_ -= static_cast<uint32_t>(pages);
+    if (clean != nullptr) {
+      *clean = untouched;
+    }
+  }
+
+  /// 释放共享大页中从 first 开始的 pages 页
+  void ReleasePages(extent_t& extent, size_t first, size_t pages) {
+    ForEachWord(first, pages, [&](size_t word, uint64_t mask) {
+      extent.used_[word] &= ~mask;
+      return true;
+    });
+    extent.free_pages_ += static_cast<uint32_t>(pages);
+    if (extent.free_pages_ == kPagesPerExtent) {
+      extent.kind_ = kEmpty;
+    }
+  }
+
+  /// 共享大页中从 first 开始的内存块的页数，first 不是块的起始页时返回 0
+  [[nodiscard]] static auto BlockPages(const extent_t& extent, size_t first)
+      -> size_t {
+    if ((extent.used_[first / 64] & (uint64_t{1} << (first % 64))) == 0) {
+      return 0;
+    }
+    // 前一页属于同一个内存块时 first 不是起始页
+    if (first > 0) {
+      size_t prev = first - 1;
+      uint64_t bit = uint64_t{1} << (prev % 64);
+      if ((extent.used_[prev / 64] & bit) != 0 &&
+          (extent.ends_[prev / 64] & bit) == 0) {
+        return 0;
+      }
+    }
+    for (size_t word = first / 64; word < kWords; word++) {
+      uint64_t ends = extent.ends_[word];
+      if (word == first / 64) {
+        ends &= ~uint64_t{0} << (first % 64);
+      }
+      if (ends != 0) {
+        return word * 64 + std::countr_zero(ends) - first + 1;
+      }
+    }
+    return 0;
+  }
+
+  /// 在共享大页中分配小于一个大页的内存块
+  auto AllocPages(size_t bytes, bool* clean) -> void* {
+    size_t pages = PagesOf(bytes);
+    size_t align = std::bit_ceil(pages);
+    auto kind = static_cast<uint8_t>(PackingPolicy::Class(bytes));
+
+    // 在同一分组的共享大页中按策略选择，没有时取地址最低的空大页
+    size_t best = extent_count_;
+    size_t best_first = 0;
+    size_t empty = extent_count_;
+    for (size_t i = 0; i < extent_count_; i++) {
+      auto& extent = extents_[i];
+      if (extent.kind_ == kEmpty) {
+        if (empty == extent_count_) {
+          empty = i;
+        }
+        continue;
+      }
+      if (extent.kind_ != kShared || extent.class_ != kind ||
+          extent.free_pages_ < pages) {
+        continue;
+      }
+      if (best != extent_count_ &&
+          (!PackingPolicy::kFullestFirst ||
+           extent.free_pages_ >= extents_[best].free_pages_)) {
+        continue;
+      }
+      size_t first = FindRun(extent, pages, align);
+      if (first == kPagesPerExtent) {
+        continue;
+      }
+      best = i;
+      best_first = first;
+      if (!PackingPolicy::kFullestFirst) {
+        break;
+      }
+    }
+
+    if (best == extent_count_) {
+      if (empty == extent_count_) {
+        return nullptr;
+      }
+      best = empty;
+      best_first = 0;
+      extents_[best].kind_ = kShared;
+      extents_[best].class_ = kind;
+    }
+    TakePages(extents_[best], best_first, pages, clean);
+    return reinterpret_cast<void*>(ExtentAddr(best) + best_first * kPageSize);
+  }
+
+  /// 从高地址开始查找 run 个连续的空大页并整页分配
+  auto AllocExtents(size_t bytes, bool* clean) -> void* {
+    size_t run = (bytes + kHugePageSize - 1) / kHugePageSize;
+    if (run > extent_count_) {
+      return nullptr;
+    }
+    size_t found = 0;
+    for (size_t i = extent_count_; i-- > 0;) {
+      found = extents_[i].kind_ == kEmpty ? found + 1 : 0;
+      if (found < run) {
+        continue;
+      }
+      bool untouched = zeroed_;
+      for (size_t j = i; j < i + run; j++) {
+        auto& extent = extents_[j];
+        extent.kind_ = j == i ? kWholeHead : kWholeTail;
+        extent.free_pages_ = 0;
+        if (zeroed_) {
+          for (size_t word = 0; word < kWords; word++) {
+            untouched = untouched && extent.dirty_[word] == 0;
+            extent.dirty_[word] = ~uint64_t{0};
+          }
+        }
+      }
+      extents_[i].run_ = static_cast<uint32_t>(run);
+      if (clean != nullptr) {
+        *clean = untouched;
+      }
+      return reinterpret_cast<void*>(ExtentAddr(i));
+    }
+    return nullptr;
+  }
+
+  /// 按大小选择整页或共享大页分配，并更新使用计数
+  auto AllocBlock(size_t bytes, bool* clean) -> void* {
+    if (bytes == 0) {
+      return nullptr;
+    }
+    void* ptr = bytes < kHugePageSize ? AllocPages(bytes, clean)
+                                      : AllocExtents(bytes, clean);
+    if (ptr == nullptr) {
+      Log("HugePageAllocator %s failed to allocate %zu bytes\n", name_, bytes);
+      return nullptr;
+    }
+    size_t size = AllocSizeImpl(ptr);
+    this->used_count_ += size;
+    this->free_count_ -= size;
+    return ptr;
+  }
+
+  [[nodiscard]] auto AllocImpl(size_t bytes) -> void* override {
+    return AllocBlock(bytes, nullptr);
+  }
+
+  /**
+   * @brief 释放内存块
+   * @details 内存块的页数由块结束位图确定，bytes 不参与释放
+   */
+  void FreeImpl(void* addr, [[maybe_unused]] size_t bytes = 0) override {
+    size_t index = ExtentIndex(addr);
+    if (index == extent_count_) {
+      return;
+    }
+    auto& extent = extents_[index];
+    size_t offset = reinterpret_cast<uintptr_t>(addr) - ExtentAddr(index);
+    if (extent.kind_ == kWholeHead && offset == 0) {
+      size_t run = extent.run_;
+      for (size_t j = index; j < index + run; j++) {
+        // 整页分配时已将所有页标记为分配过，释放后保持不变
+        auto& whole = extents_[j];
+        whole.free_pages_ = kPagesPerExtent;
+        whole.run_ = 0;
+        whole.kind_ = kEmpty;
+      }
+      this->used_count_ -= run * kHugePageSize;
+      this->free_count_ += run * kHugePageSize;
+      return;
+    }
+    if (extent.kind_ != kShared || offset % kPageSize != 0) {
+      return;
+    }
+    size_t first = offset / kPageSize;
+    size_t pages = BlockPages(extent, first);
+    if (pages == 0) {
+      return;
+    }
+    size_t last = first + pages - 1;
+    extent.ends_[last / 64] &= ~(uint64_t{1} << (last % 64));
+    ReleasePages(extent, first, pages);
+    this->used_count_ -= pages * kPageSize;
+    this->free_count_ += pages * kPageSize;
+  }
+
+  /**
+   * @brief 在所属的共享大页中原位调整内存块大小
+   * @details 缩小时释放尾部的页；增长时要求之后的页空闲且仍在同一大页中。
+   *          整页分配的内存块只在大页数不变时原位返回，其它情况返回 nullptr
+   */
+  [[nodiscard]] auto ReallocImpl(void* addr, size_t bytes) -> void* override {
+    size_t index = ExtentIndex(addr);
+    if (index == extent_count_ || bytes == 0) {
+      return nullptr;
+    }
+    auto& extent = extents_[index];
+    size_t offset = reinterpret_cast<uintptr_t>(addr) - ExtentAddr(index);
+    if (extent.kind_ == kWholeHead && offset == 0) {
+      size_t run = (bytes + kHugePageSize - 1) / kHugePageSize;
+      return run == extent.run_ ? addr : nullptr;
+    }
+    if (extent.kind_ != kShared || bytes >= kHugePageSize) {
+      return nullptr;
+    }
+    size_t first = offset / kPageSize;
+    size_t pages = BlockPages(extent, first);
+    size_t wanted = PagesOf(bytes);
+    if (pages == 0 || first + wanted > kPagesPerExtent) {
+      return nullptr;
+    }
+    if (wanted > pages &&
+        !ForEachWord(first + pages, wanted - pages,
+                     [&](size_t word, uint64_t mask) {
+                       return (extent.used_[word] & mask) == 0;
+                     })) {
+      return nullptr;
+    }
+    if (wanted == pages) {
+      return addr;
+    }
+
+    size_t last = first + pages - 1;
+    extent.ends_[last / 64] &= ~(uint64_t{1} << (last % 64));
+    if (wanted < pages) {
+      ReleasePages(extent, first + wanted, pages - wanted);
+      this->used_count_ -= (pages - wanted) * kPageSize;
+      this->free_count_ += (pages - wanted) * kPageSize;
+    } else {
+      TakePages(extent, first + pages, wanted - pages, nullptr);
+      this->used_count_ += (wanted - pages) * kPageSize;
+      this->free_count_ -= (wanted - pages) * kPageSize;
+    }
+    if (wanted < pages) {
+      last = first + wanted - 1;
+      extent.ends_[last / 64] |= uint64_t{1} << (last % 64);
+    }
+    return addr;
+  }
+
+  [[nodiscard]] size_t AllocSizeImpl(void* addr) const override {
+    size_t index = ExtentIndex(addr);
+    if (index == extent_count_) {
+      return 0;
+    }
+    const auto& extent = extents_[index];
+    size_t offset = reinterpret_cast<uintptr_t>(addr) - ExtentAddr(index);
+    if (extent.kind_ == kWholeHead && offset == 0) {
+      return extent.run_ * kHugePageSize;
+    }
+    if (extent.kind_ != kShared || offset % kPageSize != 0) {
+      return 0;
+    }
+    return BlockPages(extent, offset / kPageSize) * kPageSize;
+  }
+};
+
+}  // namespace bmalloc
+
+#endif /* BMALLOC_SRC_INCLUDE_HUGE_PAGE_HPP_ */
@@ -0,0 +1,439 @@
+/**
+ * Copyright The bmalloc Contributors
+ */
+
+#ifndef BMALLOC_SRC_INCLUDE_LOCK_HPP_
+#define BMALLOC_SRC_INCLUDE_LOCK_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "allocator_base.hpp"
+
+namespace bmalloc {
+
+/**
+ * @brief 自旋等待时的暂停指令
+ * @details x86 上为 pause，AArch64 上为 yield，其它架构为空操作。
+ *          可以替换为内核的 cpu_relax() 或用户态的 sched_yield()
+ */
+struct CpuRelax {
+  void operator()() const {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#elif defined(__riscv)
+    asm volatile(".insn i 0x0F, 0, x0, x0, 0x010" ::: "memory");
+#endif
+  }
+};
+
+/**
+ * @brief 锁的竞争统计
+ * @details acquisitions_ 为获取锁的次数，contentions_ 为获取时锁已被占用、
+ *          需要等待的次数
+ */
+struct LockStats {
+  uint64_t acquisitions_ = 0;
+  uint64_t contentions_ = 0;
+};
+
+/**
+ * @brief 提供竞争统计的锁类型
+ */
+template <class T>
+concept LockWithStats = requires(const T& lock) {
+  { lock.GetLockStats() } -> std::same_as<LockStats>;
+};
+
+/**
+ * @brief 支持共享（读）锁的锁类型
+ */
+template <class T>
+concept SharedLockable = Lockable<T> && requires(T& lock) {
+  lock.LockShared();
+  lock.UnlockShared();
+};
+
+/**
+ * @brief 支持非阻塞获取的锁类型
+ * @details TryLock() 在锁空闲时获取锁并返回 true，否则立即返回 false
+ */
+template <class T>
+concept TryLockable = Lockable<T> && requires(T& lock) {
+  { lock.TryLock() } -> std::same_as<bool>;
+};
+
+/**
+ * @brief RAII 风格的共享锁守卫
+ * @details 锁类型支持共享锁时获取共享锁，否则退化为独占锁，
+ *          因此只读路径可以统一使用本守卫
+ * @tparam L 锁类型
+ */
+template <Lockable L>
+class SharedLockGuard {
+ public:
+  explicit SharedLockGuard(L& lock) : lock_(lock) {
+    if constexpr (SharedLockable<L>) {
+      lock_.LockShared();
+    } else {
+      lock_.Lock();
+    }
+  }
+
+  ~SharedLockGuard() {
+    if constexpr (SharedLockable<L>) {
+      lock_.UnlockShared();
+    } else {
+      lock_.Unlock();
+    }
+  }
+
+  SharedLockGuard(const SharedLockGuard&) = delete;
+  SharedLockGuard(SharedLockGuard&&) = delete;
+  auto operator=(const SharedLockGuard&) -> SharedLockGuard& = delete;
+  auto operator=(SharedLockGuard&&) -> SharedLockGuard& = delete;
+
+ private:
+  L& lock_;
+};
+
+/**
+ * @brief 锁的竞争计数器
+ * @details 计数只由持有锁的线程修改，使用 relaxed 的读写即可，
+ *          与锁状态位于同一缓存行，不会引入额外的缓存行迁移
+ */
+class LockCounters {
+ public:
+  /// 记录一次获取，contended 表示获取前发生了等待
+  void Record(bool contended) {
+    acquisitions_.store(acquisitions_.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
+    if (contended) {
+      contentions_.store(contentions_.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] auto Get() const -> LockStats {
+    return {acquisitions_.load(std::memory_order_relaxed),
+            contentions_.load(std::memory_order_relaxed)};
+  }
+
+ protected:
+  std::atomic<uint64_t> acquisitions_{0};
+  std::atomic<uint64_t> contentions_{0};
+};
+
+/**
+ * @brief test-and-test-and-set 自旋锁，带指数退避
+ * @details 等待时只读取锁状态，锁被释放后才尝试交换，
+ *          失败后等待的暂停次数加倍（最多 MaxBackoff 次），
+ *          减少竞争时缓存行在核心之间的迁移
+ * @tparam Pause 自旋等待时执行的暂停操作
+ * @tparam MaxBackoff 单次退避的最大暂停次数
+ */
+template <class Pause = CpuRelax, size_t MaxBackoff = 1024>
+class alignas(kCacheLineSize) SpinLock final : public LockBase {
+ public:
+  void Lock() override {
+    if (!locked_.exchange(true, std::memory_order_acquire)) {
+      counters_.Record(false);
+      return;
+    }
+    size_t backoff = 1;
+    do {
+      while (locked_.load(std::memory_order_relaxed)) {
+        for (size_t i = 0; i < backoff; i++) {
+          Pause{}();
+        }
+        if (backoff < MaxBackoff) {
+          backoff <<= 1;
+        }
+      }
+    } while (locked_.exchange(true, std::memory_order_acquire));
+    counters_.Record(true);
+  }
+
+  void Unlock() override { locked_.store(false, std::memory_order_release); }
+
+  /// 尝试获取锁，不等待
+  auto TryLock() -> bool {
+    if (locked_.load(std::memory_order_relaxed) ||
+        locked_.exchange(true, std::memory_order_acquire)) {
+      return false;
+    }
+    counters_.Record(false);
+    return true;
+  }
+
+  [[nodiscard]] auto GetLockStats() const -> LockStats {
+    return counters_.Get();
+  }
+
+ private:
+  std::atomic<bool> locked_{false};
+  LockCounters counters_;
+};
+
+/**
+ * @brief 排队（ticket）自旋锁
+ * @details 按申请顺序获得锁，保证公平；等待时按前面排队的线程数成比例退避
+ * @tparam Pause 自旋等待时执行的暂停操作
+ */
+template <class Pause = CpuRelax>
+class alignas(kCacheLineSize) TicketLock final : public LockBase {
+ public:
+  void Lock() override {
+    auto ticket = next_.fetch_add(1, std::memory_order_relaxed);
+    auto serving = serving_.load(std::memory_order_acquire);
+    if (serving == ticket) {
+      counters_.Record(false);
+      return;
+    }
+    do {
+      // 前面的线程越多，等待越久
+      for (uint32_t i = 0; i < ticket - serving; i++) {
+        Pause{}();
+      }
+      serving = serving_.load(std::memory_order_acquire);
+    } while (serving != ticket);
+    counters_.Record(true);
+  }
+
+  void Unlock() override {
+    // 只有持有锁的线程修改 serving_
+    serving_.store(serving_.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_release);
+  }
+
+  /// 尝试获取锁，不等待：没有线程持有或排队时才领取号码
+  auto TryLock() -> bool {
+    auto serving = serving_.load(std::memory_order_acquire);
+    auto ticket = serving;
+    if (!next_.compare_exchange_strong(ticket, serving + 1,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+      return false;
+    }
+    counters_.Record(false);
+    return true;
+  }
+
+  [[nodiscard]] auto GetLockStats() const -> LockStats {
+    return counters_.Get();
+  }
+
+ private:
+  std::atomic<uint32_t> next_{0};
+  std::atomic<uint32_t> serving_{0};
+  LockCounters counters_;
+};
+
+/**
+ * @brief MCS 队列锁
+ * @details 等待的线程组成链表，每个线程只在自己的队列节点上自旋，
+ *          释放时只唤醒后继，竞争激烈时缓存行不会在所有核心之间迁移。
+ *          使用 K42 变体（见 Scott, Shared-Memory Synchronization 4.3.2）：
+ *          队列节点位于等待线程的栈上，获得锁后把后继转存到锁对象中，
+ *          因此 Lock/Unlock 不需要传入节点，可以直接作为 LockBase 使用
+ * @tparam Pause 自旋等待时执行的暂停操作
+ */
+template <class Pause = CpuRelax>
+class alignas(kCacheLineSize) McsLock final : public LockBase {
+ public:
+  void Lock() override {
+    while (true) {
+      auto* prev = lock_.tail_.load(std::memory_order_acquire);
+      if (prev == nullptr) {
+        // 锁空闲，用锁对象自身作为队尾标记
+        Node* expected = nullptr;
+        if (lock_.tail_.compare_exchange_weak(expected, &lock_,
+                                              std::memory_order_acquire,
+                                              std::memory_order_relaxed)) {
+          counters_.Record(false);
+          return;
+        }
+        continue;
+      }
+
+      Node node;
+      node.tail_.store(Waiting(), std::memory_order_relaxed);
+      if (!lock_.tail_.compare_exchange_weak(prev, &node,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_relaxed)) {
+        continue;
+      }
+      prev->next_.store(&node, std::memory_order_release);
+      while (node.tail_.load(std::memory_order_acquire) == Waiting()) {
+        Pause{}();
+      }
+
+      // 成为队首：把后继转存到锁对象中，之后不再访问栈上的节点
+      auto* succ = node.next_.load(std::memory_order_acquire);
+      if (succ == nullptr) {
+        lock_.next_.store(nullptr, std::memory_order_relaxed);
+        auto* expected = &node;
+        if (!lock_.tail_.compare_exchange_strong(expected, &lock_,
+                                                 std::memory_order_acq_rel,
+                                                 std::memory_order_relaxed)) {
+          // 有新的线程在本节点之后排队，等待它写入 next_
+          while ((succ = node.next_.load(std::memory_order_acquire)) ==
+                 nullptr) {
+            Pause{}();
+          }
+          lock_.next_.store(succ, std::memory_order_relaxed);
+        }
+      } else {
+        lock_.next_.store(succ, std::memory_order_relaxed);
+      }
+      counters_.Record(true);
+      return;
+    }
+  }
+
+  void Unlock() override {
+    auto* succ = lock_.next_.load(std::memory_order_acquire);
+    if (succ == nullptr) {
+      auto* expected = &lock_;
+      if (lock_.tail_.compare_exchange_strong(expected, nullptr,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        return;
+      }
+      // 有线程正在排队，等待它链接到锁对象
+      while ((succ = lock_.next_.load(std::memory_order_acquire)) == nullptr) {
+        Pause{}();
+      }
+    }
+    succ->tail_.store(nullptr, std::memory_order_release);
+  }
+
+  /// 尝试获取锁，不等待：只在队列为空时获取
+  auto TryLock() -> bool {
+    Node* expected = nullptr;
+    if (!lock_.tail_.compare_exchange_strong(expected, &lock_,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+      return false;
+    }
+    counters_.Record(false);
+    return true;
+  }
+
+  [[nodiscard]] auto GetLockStats() const -> LockStats {
+    return counters_.Get();
+  }
+
+ private:
+  /// 队列节点：tail_ 在等待节点中表示是否仍在等待，在锁对象中表示队尾
+  struct Node {
+    std::atomic<Node*> tail_{nullptr};
+    std::atomic<Node*> next_{nullptr};
+  };
+
+  /// 等待状态标记，不会与任何节点地址相同
+  static auto Waiting() -> Node* { return reinterpret_cast<Node*>(1); }
+
+  Node lock_;
+  LockCounters counters_;
+};
+
+/**
+ * @brief 读写自旋锁（写者优先）
+ * @details 多个读者可以同时持有共享锁；写者到达后阻止新的读者进入，
+ *          等待已有的读者退出，避免写者饥饿。适用于读多写少的查找路径
+ * @tparam Pause 自旋等待时执行的暂停操作
+ */
+template <class Pause = CpuRelax>
+class alignas(kCacheLineSize) RwLock final : public LockBase {
+ public:
+  /// 获取独占（写）锁
+  void Lock() override {
+    bool contended = false;
+    // 先占有写者位，阻止新的读者
+    auto state = state_.load(std::memory_order_relaxed);
+    while (true) {
+      if ((state & kWriter) == 0 &&
+          state_.compare_exchange_weak(state, state | kWriter,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        break;
+      }
+      contended = true;
+      Pause{}();
+      state = state_.load(std::memory_order_relaxed);
+    }
+    // 等待已有的读者退出
+    while ((state_.load(std::memory_order_acquire) & kReaders) != 0) {
+      contended = true;
+      Pause{}();
+    }
+    counters_.Record(contended);
+  }
+
+  void Unlock() override {
+    state_.fetch_and(~kWriter, std::memory_order_release);
+  }
+
+  /// 尝试获取独占锁，不等待：没有写者与读者时才获取
+  auto TryLock() -> bool {
+    uint32_t expected = 0;
+    if (!state_.compare_exchange_strong(expected, kWriter,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+      return false;
+    }
+    counters_.Record(false);
+    return true;
+  }
+
+  /// 获取共享（读）锁
+  void LockShared() {
+    bool contended = false;
+    while (true) {
+      auto state = state_.fetch_add(kReader, std::memory_order_acquire);
+      if ((state & kWriter) == 0) {
+        break;
+      }
+      // 有写者持有或正在等待，撤销并等待写者完成
+      state_.fetch_sub(kReader, std::memory_order_relaxed);
+      contended = true;
+      while ((state_.load(std::memory_order_relaxed) & kWriter) != 0) {
+        Pause{}();
+      }
+    }
+    shared_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    if (contended) {
+      shared_contentions_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void UnlockShared() { state_.fetch_sub(kReader, std::memory_order_release); }
+
+  /// 独占与共享获取的合计统计
+  [[nodiscard]] auto GetLockStats() const -> LockStats {
+    auto stats = counters_.Get();
+    stats.acquisitions_ +=
+        shared_acquisitions_.load(std::memory_order_relaxed);
+    stats.contentions_ += shared_contentions_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  static constexpr uint32_t kWriter = 1;
+  static constexpr uint32_t kReader = 2;
+  static constexpr uint32_t kReaders = ~kWriter;
+
+  std::atomic<uint32_t> state_{0};
+  LockCounters counters_;
+  /// 多个读者同时修改，需要原子加
+  std::atomic<uint64_t> shared_acquisitions_{0};
+  std::atomic<uint64_t> shared_contentions_{0};
+};
+
+}  // namespace bmalloc
+
+#endif /* BMALLOC_SRC_INCLUDE_LOCK_HPP_ */
@@ -0,0 +1,268 @@
+/**
+ * Copyright The bmalloc Contributors
+ */
+
+#ifndef BMALLOC_SRC_INCLUDE_REGION_BUDDY_HPP_
+#define BMALLOC_SRC_INCLUDE_REGION_BUDDY_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include "allocator_base.hpp"
+#include "buddy.hpp"
+
+namespace bmalloc {
+
+/**
+ * @brief 管理多个不连续内存区域的 Buddy 页分配器
+ * @details 每个区域是一个独立的 Buddy arena，并标记所属的 NUMA 节点。
+ *          分配时优先使用当前节点的区域，依次尝试同节点的各个区域，
+ *          都失败时按添加顺序回退到其它节点；释放时按地址找到所属区域。
+ *          区域可以在运行时通过 AddRegion() 添加。
+ *          构造参数与 Buddy 相同，可以直接作为 Slab<PageAllocator> 的
+ *          页分配器，slab 页从当前节点分配；热添加的区域不在 Slab 的
+ *          页描述符表覆盖范围内，其中对象的释放退回遍历 slab 链表查找
+ * @tparam LogFunc printf 风格的日志函数类型
+ * @tparam Lock 锁类型，保护区域表与所有区域
+ * @tparam NodeIdFunc 返回当前 NUMA 节点编号的函数对象类型，
+ *         为 std::nullptr_t 时所有分配都视为在节点 0 上发起
+ * @tparam kMaxRegions 最多管理的区域数
+ */
+template <class LogFunc = std::nullptr_t, class Lock = LockBase,
+          class NodeIdFunc = std::nullptr_t, size_t kMaxRegions = 8>
+class RegionBuddy
+    : public StaticAllocatorBase<
+          RegionBuddy<LogFunc, Lock, NodeIdFunc, kMaxRegions>, LogFunc, Lock> {
+ public:
+  using Dispatch =
+      StaticAllocatorBase<RegionBuddy<LogFunc, Lock, NodeIdFunc, kMaxRegions>,
+                          LogFunc, Lock>;
+  using Dispatch::Alloc;
+  using Dispatch::AllocSize;
+  using Dispatch::Free;
+  using Dispatch::Realloc;
+
+  /// 每个区域使用的 Buddy，由 RegionBuddy 的锁保护，自身不加锁
+  using RegionAllocator = Buddy<LogFunc, NullLock>;
+
+  /// 未找到区域时 GetNode() 的返回值
+  static constexpr size_t kInvalidNode = SIZE_MAX;
+
+  /**
+   * @brief 构造区域分配器，第一个区域属于节点 0
+   * @param name 分配器名称
+   * @param addr 第一个区域的起始地址
+   * @param bytes 第一个区域的字节数
+   */
+  explicit RegionBuddy(const char* name, void* addr, size_t bytes)
+      : Dispatch(name, addr, bytes) {
+    AddRegionImpl(addr, bytes, 0);
+  }
+
+  /// @name 构造/析构函数
+  /// @{
+  RegionBuddy(const RegionBuddy&) = delete;
+  RegionBuddy(RegionBuddy&&) = delete;
+  auto operator=(const RegionBuddy&) -> RegionBuddy& = delete;
+  auto operator=(RegionBuddy&&) -> RegionBuddy& = delete;
+  ~RegionBuddy() override {
+    auto count = region_count_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; i++) {
+      std::destroy_at(regions_[i].Get());
+    }
+  }
+  /// @}
+
+  /**
+   * @brief 添加一个内存区域，可以在分配器使用期间调用
+   * @param addr 区域起始地址，不能与已有区域重叠
+   * @param bytes 区域字节数
+   * @param node 区域所属的 NUMA 节点
+   * @return bool 成功返回 true；区域表已满或 Buddy 初始化失败时返回 false
+   */
+  auto AddRegion(void* addr, size_t bytes, size_t node) -> bool {
+    LockGuard guard(this->lock_);
+    return AddRegionImpl(addr, bytes, node);
+  }
+
+  /**
+   * @brief 在指定节点上分配内存，节点内存不足时回退到其它节点
+   * @param bytes 要分配的字节数
+   * @param node 优先使用的节点
+   * @return void* 分配到的地址，失败时返回 nullptr
+   */
+  [[nodiscard]] auto AllocOnNode(size_t bytes, size_t node) -> void* {
+    LockGuard guard(this->lock_);
+    void* addr = AllocFrom(bytes, node);
+    this->Record(TraceOp::kAlloc, addr, bytes);
+    return addr;
+  }
+
+  /**
+   * @brief 获取内存块所属区域的节点
+   * @param addr 内存地址
+   * @return size_t 节点编号，地址不在任何区域中时返回 kInvalidNode
+   */
+  [[nodiscard]] auto GetNode(const void* addr) const -> size_t {
+    const auto* region = FindRegion(addr);
+    return region != nullptr ? region->node_ : kInvalidNode;
+  }
+
+  /// 已添加的区域数
+  [[nodiscard]] auto GetRegionCount() const -> size_t {
+    return region_count_.load(std::memory_order_acquire);
+  }
+
+ protected:
+  friend Dispatch;
+
+  using AllocatorBase<LogFunc, Lock>::Log;
+  using AllocatorBase<LogFunc, Lock>::name_;
+
+  /// 一个内存区域
+  struct region_t {
+    /// 区域起始地址
+    uintptr_t start_ = 0;
+    /// 区域结束地址（开区间）
+    uintptr_t end_ = 0;
+    /// 所属节点
+    size_t node_ = 0;
+    /// 区域的 Buddy，由 AddRegionImpl 构造
+    alignas(RegionAllocator) std::byte storage_[sizeof(RegionAllocator)];
+
+    [[nodiscard]] auto Get() -> RegionAllocator* {
+      return std::launder(reinterpret_cast<RegionAllocator*>(storage_));
+    }
+    [[nodiscard]] auto Get() const -> const RegionAllocator* {
+      return std::launder(reinterpret_cast<const RegionAllocator*>(storage_));
+    }
+  };
+
+  region_t regions_[kMaxRegions];
+  /// 已添加的区域数，只在持有锁时增加；槽位构造完成后以 release 发布，
+  /// 不加锁的读者以 acquire 读取后可以访问前 region_count_ 个槽位
+  std::atomic<size_t> region_count_{0};
+
+  /// 当前线程所在的节点
+  [[nodiscard]] static auto CurrentNode() -> size_t {
+    if constexpr (std::is_same_v<NodeIdFunc, std::nullptr_t>) {
+      return 0;
+    } else {
+      return NodeIdFunc{}();
+    }
+  }
+
+  auto AddRegionImpl(void* addr, size_t bytes, size_t node) -> bool {
+    auto count = region_count_.load(std::memory_order_relaxed);
+    if (count == kMaxRegions) {
+      Log("RegionBuddy %s: region table full, dropping %zu bytes at %p\n",
+          name_, bytes, addr);
+      return false;
+    }
+    auto& region = regions_[count];
+    auto* allocator = std::construct_at(region.Get(), name_, addr, bytes);
+    // Buddy 初始化失败（区域太小等）时分配总是返回 nullptr，不登记该区域
+    if (!Usable(*allocator)) {
+      std::destroy_at(allocator);
+      return false;
+    }
+    region.start_ = reinterpret_cast<uintptr_t>(addr);
+    region.end_ = region.start_ + bytes;
+    region.node_ = node;
+    region_count_.store(count + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Buddy 是否初始化成功
+  [[nodiscard]] static auto Usable(RegionAllocator& allocator) -> bool {
+    void* probe = allocator.Alloc(1);
+    if (probe == nullptr) {
+      return false;
+    }
+    allocator.Free(probe);
+    return true;
+  }
+
+  [[nodiscard]] auto FindRegion(const void* addr) -> region_t* {
+    auto target = reinterpret_cast<uintptr_t>(addr);
+    auto count = region_count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+      if (target >= regions_[i].start_ && target < regions_[i].end_) {
+        return &regions_[i];
+      }
+    }
+    return nullptr;
+  }
+
+  [[nodiscard]] auto FindRegion(const void* addr) const -> const region_t* {
+    return const_cast<RegionBuddy*>(this)->FindRegion(addr);
+  }
+
+  /// 先在 node 的区域中分配，失败时按添加顺序尝试其它节点的区域
+  [[nodiscard]] auto AllocFrom(size_t bytes, size_t node) -> void* {
+    auto count = region_count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+      if (regions_[i].node_ == node) {
+        if (void* ptr = regions_[i].Get()->Alloc(bytes); ptr != nullptr) {
+          return ptr;
+        }
+      }
+    }
+    for (size_t i = 0; i < count; i++) {
+      if (regions_[i].node_ != node) {
+        if (void* ptr = regions_[i].Get()->Alloc(bytes); ptr != nullptr) {
+          return ptr;
+        }
+      }
+    }
+    Log("RegionBuddy %s failed to allocate %zu bytes\n", name_, bytes);
+    return nullptr;
+  }
+
+  [[nodiscard]] auto AllocImpl(size_t bytes) -> void* override {
+    return AllocFrom(bytes, CurrentNode());
+  }
+
+  void FreeImpl(void* addr, [[maybe_unused]] size_t bytes = 0) override {
+    if (auto* region = FindRegion(addr); region != nullptr) {
+      region->Get()->Free(addr);
+    }
+  }
+
+  /**
+   * @brief 调整内存块大小
+   * @details 先在所属区域内调整（可能原位完成）；区域内无法满足时
+   *          从其它区域分配新块并复制数据，失败时原内存块保持不变。
+   *          bytes 为 0 时不调整并返回 nullptr：区域的 Buddy 会释放内存块，
+   *          与返回 nullptr 时原内存块保持不变的约定冲突
+   */
+  [[nodiscard]] auto ReallocImpl(void* addr, size_t bytes) -> void* override {
+    auto* region = FindRegion(addr);
+    if (region == nullptr || bytes == 0) {
+      return nullptr;
+    }
+    if (void* ptr = region->Get()->Realloc(addr, bytes); ptr != nullptr) {
+      return ptr;
+    }
+    void* ptr = AllocFrom(bytes, region->node_);
+    if (ptr != nullptr) {
+      size_t old_size = region->Get()->AllocSize(addr);
+      std::memcpy(ptr, addr, old_size < bytes ? old_size : bytes);
+      region->Get()->Free(addr);
+    }
+    return ptr;
+  }
+
+  [[nodiscard]] size_t AllocSizeImpl(void* addr) const override {
+    const auto* region = FindRegion(addr);
+    return region != nullptr ? region->Get()->AllocSize(addr) : 0;
+  }
+};
+
+}  // namespace bmalloc
+
+#endif /* BMALLOC_SRC_INCLUDE_REGION_BUDDY_HPP_ */
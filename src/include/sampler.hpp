@@ -0,0 +1,262 @@
+/**
+ * Copyright The bmalloc Contributors
+ */
+
+#ifndef BMALLOC_SRC_INCLUDE_SAMPLER_HPP_
+#define BMALLOC_SRC_INCLUDE_SAMPLER_HPP_
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "trace.hpp"
+
+namespace bmalloc {
+
+/**
+ * @brief 一次采样事件
+ * @details 释放事件的 size_、weight_ 与 tag_ 来自匹配到的分配
+ */
+struct SampleEvent {
+  /// TraceOp::kAlloc 或 TraceOp::kFree
+  TraceOp op_;
+  /// 内存块地址
+  const void* address_;
+  /// 分配时请求的长度，单位与分配器一致
+  size_t size_;
+  /// 这次采样近似代表的分配量，为 max(size_, 采样间隔)
+  size_t weight_;
+  /// 分配时由 TagFunc 获取的标签（如调用栈编号），未提供时为 0
+  uintptr_t tag_;
+};
+
+/**
+ * @brief 采样分配的记录槽位
+ * @details 由调用者提供数组，构造时需零初始化（如 SampleEntry entries[N]{}）
+ */
+struct SampleEntry {
+  /// 内存块地址，0 表示空闲
+  std::atomic<uintptr_t> address_;
+  size_t size_;
+  uintptr_t tag_;
+};
+
+/**
+ * @brief 采样堆分析器
+ * @details 按分配量而不是次数采样：每次分配从倒计数中减去请求的长度，
+ *          倒计数越过 0 的分配被采样，然后重新抽取服从几何分布
+ *          （均值为 interval）的倒计数，平均每 interval 个单位采样一次，
+ *          大的分配更容易被采样。
+ *          被采样的分配记录在调用者提供的槽位表中，释放时查表匹配，
+ *          匹配成功时同样回调；表中没有空槽位时仍然回调，但不再匹配释放。
+ *          所有操作无锁，可以由多个线程同时调用；回调可能被并发调用，
+ *          在分配器的锁内调用时不能再调用同一个分配器
+ */
+class HeapSampler {
+ public:
+  /// 采样回调
+  using Callback = void (*)(const SampleEvent& event, void* context);
+  /// 采样分配时获取标签（如记录调用栈并返回编号）
+  using TagFunc = uintptr_t (*)(void* context);
+
+  /// interval 的上限，保证定点运算不溢出
+  static constexpr size_t kMaxInterval = size_t{1} << 40;
+  /// 查找槽位时最多探测的槽位数
+  static constexpr size_t kMaxProbe = 8;
+
+  /**
+   * @brief 构造采样器
+   * @param entries 记录采样分配的槽位数组
+   * @param capacity 槽位数
+   * @param interval 平均采样间隔，单位与分配器一致，为 0 时采样每次分配
+   * @param callback 采样回调
+   * @param context 传给 callback 与 tag 的参数
+   * @param tag 获取标签的函数，可以为 nullptr
+   * @param seed 随机数种子
+   */
+  HeapSampler(SampleEntry* entries, size_t capacity, size_t interval,
+              Callback callback, void* context = nullptr,
+              TagFunc tag = nullptr, uint64_t seed = 0x853C49E6748FEA9BULL)
+      : entries_(entries),
+        capacity_(capacity),
+        interval_(interval < kMaxInterval ? interval : kMaxInterval),
+        callback_(callback),
+        context_(context),
+        tag_(tag),
+        random_(seed) {
+    countdown_.store(NextCountdown(), std::memory_order_relaxed);
+  }
+
+  HeapSampler(const HeapSampler&) = delete;
+  HeapSampler(HeapSampler&&) = delete;
+  auto operator=(const HeapSampler&) -> HeapSampler& = delete;
+  auto operator=(HeapSampler&&) -> HeapSampler& = delete;
+  ~HeapSampler() = default;
+
+  /**
+   * @brief 记录一次分配，倒计数越过 0 时采样
+   * @param addr 分配结果，为 nullptr 时忽略
+   * @param size 请求的长度
+   */
+  void RecordAlloc(const void* addr, size_t size) {
+    if (addr == nullptr) {
+      return;
+    }
+    auto length = static_cast<int64_t>(size < kMaxInterval ? size
+                                                           : kMaxInterval);
+    auto remaining = countdown_.fetch_sub(length, std::memory_order_relaxed);
+    if (remaining <= 0 || remaining > length) [[likely]] {
+      return;
+    }
+
+    // 只有越过 0 的线程补充倒计数，补充后仍不大于 0 时继续补充
+    int64_t next = 0;
+    do {
+      next = NextCountdown();
+    } while (countdown_.fetch_add(next, std::memory_order_relaxed) + next <=
+             0);
+
+    uintptr_t tag = tag_ != nullptr ? tag_(context_) : 0;
+    samples_.fetch_add(1, std::memory_order_relaxed);
+    if (!Insert(addr, size, tag)) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    Report(TraceOp::kAlloc, addr, size, tag);
+  }
+
+  /**
+   * @brief 记录一次释放，addr 是被采样的分配时回调
+   * @details 需在内存块归还分配器之前调用，避免地址被重新分配后误匹配
+   * @param addr 要释放的地址
+   */
+  void RecordFree(const void* addr) {
+    if (live_.load(std::memory_order_relaxed) == 0 || addr == nullptr)
+        [[likely]] {
+      return;
+    }
+    auto key = reinterpret_cast<uintptr_t>(addr);
+    auto home = Home(key);
+    for (size_t i = 0; i < Probes(); i++) {
+      auto& entry = entries_[(home + i) % capacity_];
+      if (entry.address_.load(std::memory_order_acquire) != key) {
+        continue;
+      }
+      auto size = entry.size_;
+      auto tag = entry.tag_;
+      auto expected = key;
+      if (entry.address_.compare_exchange_strong(
+              expected, 0, std::memory_order_acq_rel)) {
+        live_.fetch_sub(1, std::memory_order_relaxed);
+        Report(TraceOp::kFree, addr, size, tag);
+      }
+      return;
+    }
+  }
+
+  /// 平均采样间隔
+  [[nodiscard]] auto GetInterval() const -> size_t { return interval_; }
+
+  /// 采样的分配数
+  [[nodiscard]] auto Samples() const -> uint64_t {
+    return samples_.load(std::memory_order_relaxed);
+  }
+
+  /// 尚未释放的采样分配数
+  [[nodiscard]] auto Live() const -> size_t {
+    return live_.load(std::memory_order_relaxed);
+  }
+
+  /// 因槽位表已满而没有记录的采样分配数，这些分配的释放不会回调
+  [[nodiscard]] auto Dropped() const -> uint64_t {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  SampleEntry* entries_;
+  size_t capacity_;
+  size_t interval_;
+  Callback callback_;
+  void* context_;
+  TagFunc tag_;
+  /// 距离下一次采样剩余的长度
+  std::atomic<int64_t> countdown_{0};
+  /// 随机数生成器的状态，每次抽取加上固定的增量
+  std::atomic<uint64_t> random_;
+  std::atomic<uint64_t> samples_{0};
+  std::atomic<size_t> live_{0};
+  std::atomic<uint64_t> dropped_{0};
+
+  /// 地址在槽位表中的起始位置
+  [[nodiscard]] auto Home(uintptr_t key) const -> size_t {
+    return static_cast<size_t>(((key >> 4) * 0x9E3779B97F4A7C15ULL) >> 32) %
+           capacity_;
+  }
+
+  [[nodiscard]] auto Probes() const -> size_t {
+    return capacity_ < kMaxProbe ? capacity_ : kMaxProbe;
+  }
+
+  /// 在起始位置之后的 kMaxProbe 个槽位中记录采样分配
+  auto Insert(const void* addr, size_t size, uintptr_t tag) -> bool {
+    if (capacity_ == 0) {
+      return false;
+    }
+    auto key = reinterpret_cast<uintptr_t>(addr);
+    auto home = Home(key);
+    for (size_t i = 0; i < Probes(); i++) {
+      auto& entry = entries_[(home + i) % capacity_];
+      uintptr_t expected = 0;
+      if (entry.address_.compare_exchange_strong(
+              expected, key, std::memory_order_acq_rel)) {
+        // 地址返回给调用者之前不会被释放，可以在占用槽位后再写入
+        entry.size_ = size;
+        entry.tag_ = tag;
+        live_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Report(TraceOp op, const void* addr, size_t size, uintptr_t tag) {
+    if (callback_ == nullptr) {
+      return;
+    }
+    SampleEvent event{op, addr, size, size > interval_ ? size : interval_,
+                      tag};
+    callback_(event, context_);
+  }
+
+  /**
+   * @brief 抽取服从指数分布（均值为 interval_）的倒计数
+   * @details 不使用浮点运算：-ln(u) = -log2(u) * ln2，log2 的整数部分
+   *          由最高位得到，小数部分用 x + 0.3466 * x * (1 - x) 近似
+   *          （误差小于 0.01），以 16 位定点数计算
+   */
+  auto NextCountdown() -> int64_t {
+    // splitmix64
+    uint64_t z = random_.fetch_add(0x9E3779B97F4A7C15ULL,
+                                   std::memory_order_relaxed) +
+                 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+
+    // u = r / 2^53，r 属于 [1, 2^53]
+    uint64_t r = (z >> 11) + 1;
+    auto exponent = static_cast<uint64_t>(std::bit_width(r) - 1);
+    uint64_t fraction = ((r << (63 - exponent)) >> 47) & 0xFFFF;
+    uint64_t log2_r = (exponent << 16) + fraction +
+                      (((fraction * (0x10000 - fraction)) >> 16) * 22713 >>
+                       16);
+    uint64_t neg_log2_u = (uint64_t{53} << 16) - log2_r;
+    // ln2 = 45426 / 2^16
+    uint64_t next = (((interval_ * neg_log2_u) >> 16) * 45426) >> 16;
+    return next > 0 ? static_cast<int64_t>(next) : 1;
+  }
+};
+
+}  // namespace bmalloc
+
+#endif /* BMALLOC_SRC_INCLUDE_SAMPLER_HPP_ */
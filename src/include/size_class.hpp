@@ -0,0 +1,127 @@
+/**
+ * Copyright The bmalloc Contributors
+ */
+
+#ifndef BMALLOC_SRC_INCLUDE_SIZE_CLASS_HPP_
+#define BMALLOC_SRC_INCLUDE_SIZE_CLASS_HPP_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace bmalloc {
+
+/**
+ * @brief 2 的幂次方大小分级
+ * @details 32, 64, 128, ..., 131072，共 13 级。
+ *          最坏情况下内部碎片接近 50%（如 65 字节使用 128 字节的对象）。
+ */
+struct PowerOfTwoSizeClass {
+  /// 最小对象大小
+  static constexpr size_t kMinSize = 32;
+  /// 最大对象大小
+  static constexpr size_t kMaxSize = 131072;
+  /// 分级数量
+  static constexpr size_t kCount =
+      std::bit_width(kMaxSize) - std::bit_width(kMinSize) + 1;
+
+  /**
+   * @brief 计算请求大小对应的分级下标
+   * @param bytes 请求的字节数，范围为 [1, kMaxSize]
+   * @return size_t 向上取整到 2 的幂次方后对应的下标
+   */
+  static constexpr auto Index(size_t bytes) -> size_t {
+    if (bytes <= kMinSize) {
+      return 0;
+    }
+    return std::bit_width(bytes - 1) - std::bit_width(kMinSize - 1);
+  }
+
+  /**
+   * @brief 计算分级下标对应的对象大小
+   * @param index 分级下标
+   * @return size_t 对象大小
+   */
+  static constexpr auto Size(size_t index) -> size_t {
+    return kMinSize << index;
+  }
+};
+
+/**
+ * @brief 每个 2 倍区间划分为 4 级的大小分级（jemalloc/tcmalloc 风格）
+ * @details 区间 (2^k, 2^(k+1)] 按 2^(k-2) 的步长划分为 4 级，
+ *          如 64, 80, 96, 112, 128, 160, 192, 224, 256, ...
+ *          步长不小于 16 字节以保证 16 字节对齐，因此 (32, 64] 只有 48、64
+ *          两级。最坏情况下内部碎片约为 20%。
+ */
+struct QuarterSizeClass {
+  /// 最小对象大小
+  static constexpr size_t kMinSize = 32;
+  /// 最大对象大小
+  static constexpr size_t kMaxSize = 131072;
+  /// 最小步长（对象对齐要求）
+  static constexpr size_t kQuantum = 16;
+  /// 每个 2 倍区间的分级数
+  static constexpr size_t kClassesPerDoubling = 4;
+  /// 开始按 kClassesPerDoubling 划分的大小（步长恰好等于 kQuantum）
+  static constexpr size_t kGroupBase = kQuantum * kClassesPerDoubling;
+  /// 小于等于 kGroupBase 的分级数
+  static constexpr size_t kSmallCount = kGroupBase / kQuantum - 1;
+  /// 分级数量
+  static constexpr size_t kCount =
+      kSmallCount + (std::bit_width(kMaxSize) - std::bit_width(kGroupBase)) *
+                        kClassesPerDoubling;
+
+  /**
+   * @brief 计算请求大小对应的分级下标
+   * @param bytes 请求的字节数，范围为 [1, kMaxSize]
+   * @return size_t 对应的下标
+   */
+  static constexpr auto Index(size_t bytes) -> size_t {
+    if (bytes <= kMinSize) {
+      return 0;
+    }
+    if (bytes <= kGroupBase) {
+      return (bytes + kQuantum - 1) / kQuantum - kMinSize / kQuantum;
+    }
+    // 2^shift < bytes <= 2^(shift+1)
+    size_t shift = std::bit_width(bytes - 1) - 1;
+    size_t step_shift = shift - std::bit_width(kClassesPerDoubling - 1);
+    size_t pos =
+        (bytes - (size_t{1} << shift) + (size_t{1} << step_shift) - 1) >>
+        step_shift;
+    return kSmallCount +
+           (shift - (std::bit_width(kGroupBase) - 1)) * kClassesPerDoubling +
+           pos - 1;
+  }
+
+  /**
+   * @brief 计算分级下标对应的对象大小
+   * @param index 分级下标
+   * @return size_t 对象大小
+   */
+  static constexpr auto Size(size_t index) -> size_t {
+    if (index < kSmallCount) {
+      return kMinSize + index * kQuantum;
+    }
+    size_t group = (index - kSmallCount) / kClassesPerDoubling;
+    size_t pos = (index - kSmallCount) % kClassesPerDoubling + 1;
+    size_t shift = std::bit_width(kGroupBase) - 1 + group;
+    size_t step_shift = shift - std::bit_width(kClassesPerDoubling - 1);
+    return (size_t{1} << shift) + pos * (size_t{1} << step_shift);
+  }
+};
+
+static_assert(PowerOfTwoSizeClass::Size(PowerOfTwoSizeClass::kCount - 1) ==
+              PowerOfTwoSizeClass::kMaxSize);
+static_assert(PowerOfTwoSizeClass::Index(65) == 2);
+static_assert(QuarterSizeClass::Size(QuarterSizeClass::kCount - 1) ==
+              QuarterSizeClass::kMaxSize);
+static_assert(QuarterSizeClass::Size(QuarterSizeClass::Index(48)) == 48);
+static_assert(QuarterSizeClass::Size(QuarterSizeClass::Index(65)) == 80);
+static_assert(QuarterSizeClass::Size(QuarterSizeClass::Index(161)) == 192);
+static_assert(QuarterSizeClass::Size(QuarterSizeClass::Index(2049)) == 2560);
+
+}  // namespace bmalloc
+
+#endif /* BMALLOC_SRC_INCLUDE_SIZE_CLASS_HPP_ */
@@ -5,29 +5,102 @@
 #ifndef BMALLOC_SRC_INCLUDE_SLAB_HPP_
 #define BMALLOC_SRC_INCLUDE_SLAB_HPP_
 
+#include <array>
+#include <bit>
+
 #include "allocator_base.hpp"
+#include "lock.hpp"
+#include "size_class.hpp"
 
 namespace bmalloc {
 
+/**
+ * @brief Slab 分配器的编译期配置
+ * @details 作为 Slab 的 Config 模板参数，嵌入式目标可以继承后覆盖
+ *          其中的部分常量。通用 cache 的 slab 布局由这些常量与 SizeClass
+ *          在编译期计算，构造时不再搜索 order
+ */
+struct DefaultSlabConfig {
+  /// 缓存行大小，决定 cache 内部分组的对齐与颜色偏移的单位；
+  /// 默认与锁的对齐（BMALLOC_CACHE_LINE_SIZE）相同
+  static constexpr size_t kCacheLineSize = bmalloc::kCacheLineSize;
+  /// cache 名称的最大长度（含结尾的 '\0'）
+  static constexpr size_t kNameLength = 20;
+  /// 为减少浪费而允许提升到的最大 order（对象本身更大时以对象为准）
+  static constexpr uint32_t kMaxOrder = 3;
+  /// slab 尾部浪费的上限为 slab 大小的 1/kWasteFraction
+  static constexpr size_t kWasteFraction = 8;
+  /// 释放对象后每个 cache 默认保留的空闲 slab 数量
+  static constexpr size_t kMinFreeSlabs = 1;
+  /// 每个 magazine 能保存的对象数量
+  static constexpr size_t kMagazineSize = 14;
+  /// 支持 magazine 的最大 CPU 数量
+  static constexpr size_t kMaxCpus = 16;
+};
+static_assert(DefaultSlabConfig::kCacheLineSize == kCacheLineSize,
+              "default slab cache line must match the lock alignment");
+
+/**
+ * @brief Slab 分配器
+ * @tparam PageAllocator 页级分配器
+ * @tparam LogFunc printf 风格的日志函数类型
+ * @tparam Lock 锁类型，支持 TryLock（TryLockable）时启用无锁的远程释放
+ * @tparam SizeClass 通用 cache 的大小分级策略
+ * @tparam CpuIdFunc 返回当前 CPU 编号的函数对象类型，
+ *         为 std::nullptr_t 时不启用 per-CPU magazine 层。
+ *         返回的编号在调用者使用期间必须为其独占（如内核中关闭抢占，
+ *         或用户态中使用线程编号），编号不小于 CACHE_MAX_CPUS 时退回 slab 层
+ * @tparam Config 编译期配置，见 DefaultSlabConfig
+ */
 template <class PageAllocator, class LogFunc = std::nullptr_t,
-          class Lock = LockBase>
+          class Lock = LockBase, class SizeClass = PowerOfTwoSizeClass,
+          class CpuIdFunc = std::nullptr_t, class Config = DefaultSlabConfig>
   requires std::derived_from<PageAllocator, AllocatorBase<LogFunc, Lock>>
-class Slab : public AllocatorBase<LogFunc, Lock> {
+class Slab
+    : public StaticAllocatorBase<
+          Slab<PageAllocator, LogFunc, Lock, SizeClass, CpuIdFunc, Config>,
+          LogFunc, Lock> {
  public:
-  using AllocatorBase<LogFunc, Lock>::Alloc;
-  using AllocatorBase<LogFunc, Lock>::Free;
+  using Dispatch = StaticAllocatorBase<
+      Slab<PageAllocator, LogFunc, Lock, SizeClass, CpuIdFunc, Config>,
+      LogFunc, Lock>;
+  using Dispatch::Alloc;
+  using Dispatch::AllocBulk;
+  using Dispatch::Free;
+  using Dispatch::FreeBulk;
   using AllocatorBase<LogFunc, Lock>::GetFreeCount;
   using AllocatorBase<LogFunc, Lock>::GetUsedCount;
+  using Dispatch::Realloc;
+
+  /// 通用 cache 的最小对象大小
+  static constexpr size_t kMinObjectSize = SizeClass::kMinSize;
+  /// 通用 cache 的最大对象大小
+  static constexpr size_t kMaxObjectSize = SizeClass::kMaxSize;
 
   /**
    * @brief 构造 Slab 分配器
    * @param name 分配器名称
    * @param addr 管理的内存起始地址
    * @param bytes 管理的字节数
+   * @param page_args 转发给页分配器构造函数的其余参数
    */
-  explicit Slab(const char *name, void *addr, size_t bytes)
-      : AllocatorBase<LogFunc, Lock>(name, addr, bytes),
-        page_allocator_(name, addr, bytes) {
+  template <class... PageArgs>
+  explicit Slab(const char *name, void *addr, size_t bytes,
+                PageArgs &&...page_args)
+      : Dispatch(name, addr, bytes),
+        page_allocator_(name, addr, ArenaBytes(addr, bytes),
+                        std::forward<PageArgs>(page_args)...) {
+    // 页描述符表位于管理区域的末尾，之前的内存交给 page_allocator_，
+    // 使页分配器的起始地址保持 addr 本身的对齐
+    if (PageMapBytes(bytes) != 0) {
+      page_map_ = reinterpret_cast<slab_t **>(static_cast<char *>(addr) +
+                                              ArenaBytes(addr, bytes));
+      page_map_pages_ = bytes / kPageSize;
+      for (size_t i = 0; i < page_map_pages_; i++) {
+        page_map_[i] = nullptr;
+      }
+    }
+
     // 为cache_cache分配第一个slab
     void *ptr = page_allocator_.Alloc(kPageSize);
     if (ptr == nullptr) {
@@ -38,42 +111,42 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
 
     // 初始化 cache_cache_ 的 slab 链表
     cache_cache_.slabs_free_ = slab;
+    cache_cache_.num_free_slabs_ = 1;
 
     // 设置 cache_cache_ 的基本属性
     strcpy(cache_cache_.name_, "kmem_cache");
     cache_cache_.objectSize_ = sizeof(kmem_cache_t);
 
     // 初始化 slab 结构
+    slab->page_ = ptr;
     slab->freeList_ =
         reinterpret_cast<int *>(static_cast<char *>(ptr) + sizeof(slab_t));
     slab->myCache_ = &cache_cache_;
 
-    // 计算每个 slab 能容纳的对象数量
-    long memory = (1 << cache_cache_.order_) * kPageSize;
-    memory -= sizeof(slab_t);
-    int n = 0;
-    while ((long)(memory - sizeof(uint32_t) - cache_cache_.objectSize_) >= 0) {
-      n++;
-      memory -= sizeof(uint32_t) + cache_cache_.objectSize_;
-    }
+    // 每个 slab 能容纳的对象数量在编译期计算，
+    // 对象按 kmem_cache_t 的对齐要求放置
+    constexpr auto kCacheCacheLayout =
+        order_layout(sizeof(kmem_cache_t), CACHE_CACHE_ORDER, sizeof(slab_t),
+                     sizeof(uint32_t), alignof(kmem_cache_t));
+    static_assert(kCacheCacheLayout.objects_ > 0,
+                  "kmem_cache_t must fit in one page");
+    cache_cache_.align_ = alignof(kmem_cache_t);
+    size_t n = kCacheCacheLayout.objects_;
 
     // 设置对象数组起始位置
-    slab->objects = static_cast<void *>(static_cast<char *>(ptr) +
-                                        sizeof(slab_t) + sizeof(uint32_t) * n);
-    auto *list = static_cast<kmem_cache_t *>(slab->objects);
+    slab->objects = static_cast<void *>(
+        static_cast<char *>(ptr) +
+        align_up(sizeof(slab_t) + sizeof(uint32_t) * n, cache_cache_.align_));
+    // 空闲链表与 kmem_cache_t 对象在分配时才初始化
 
-    // 初始化空闲对象链表
-    for (int i = 0; i < n; i++) {
-      new (&list[i]) kmem_cache_t;
-      slab->freeList_[i] = i + 1;
-    }
+    map_slab(slab, cache_cache_.order_);
 
     // 设置 cache_cache_ 的对象统计信息
     cache_cache_.objectsInSlab_ = n;
     cache_cache_.num_allocations_ = n;
 
     // 设置缓存行对齐参数
-    cache_cache_.colour_max_ = memory / CACHE_L1_LINE_SIZE;
+    cache_cache_.colour_max_ = kCacheCacheLayout.colour_max_;
     if (cache_cache_.colour_max_ > 0) {
       cache_cache_.colour_next_ = 1;
     } else {
@@ -82,6 +155,26 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
 
     // 将 cache_cache_ 加入全局 cache 链表
     all_kmem_cache_ = &cache_cache_;
+
+    // 创建保存 magazine 的内部 cache
+    if constexpr (kMagazineEnabled) {
+      magazine_cache_ = find_create_kmem_cache(
+          "kmem_magazine", sizeof(magazine_t), nullptr, nullptr);
+    }
+
+    // 预先创建所有通用 cache，命名为 "size-XXX"，布局在编译期计算
+    constexpr auto kLayouts = size_class_layouts();
+    for (size_t i = 0; i < kSizeClassCount; i++) {
+      char num[7];
+      char cache_name[CACHE_NAMELEN]{};
+      strcpy(cache_name, "size-");
+      itoa(SizeClassSize(i), num);
+      strcat(cache_name, num);
+      // 通用 cache 的对象按自然对齐，aligned_alloc 无需额外填充
+      size_caches_[i] = find_create_kmem_cache(
+          cache_name, SizeClassSize(i), nullptr, nullptr,
+          natural_align(SizeClassSize(i)), &kLayouts[i]);
+    }
   }
 
   /// @name 构造/析构函数
@@ -112,40 +205,483 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
     return 0;
   }
 
+  /**
+   * @brief 判断内存是否由 bytes 对应的通用 cache 分配
+   * @details 只查询一次页描述符表、不比较 cache 名称，
+   *          供已知大小的释放路径确认内存所属的层
+   * @param ptr 内存指针
+   * @param bytes 分配时的大小
+   * @return bool 属于该 cache 时返回 true
+   */
+  [[nodiscard]] auto IsSizeCacheObject(const void *ptr, size_t bytes)
+      -> bool {
+    auto cache = sized_cache(bytes);
+    if (cache == nullptr) {
+      return false;
+    }
+    auto slab = find_slab(ptr);
+    return slab != nullptr && slab->myCache_ == cache;
+  }
+
+  /**
+   * @brief 获取通用 cache 的统计快照
+   * @details 不加锁，可以在其它线程中周期性调用。通用 cache 在分配器的
+   *          生命周期内不会被销毁，因此不需要遍历受锁保护的 cache 链表
+   * @param stats 保存结果的数组
+   * @param capacity 数组能容纳的数量，不小于 SizeClass::kCount 时
+   *        包括所有通用 cache
+   * @return size_t 写入的数量
+   */
+  [[nodiscard]] auto GetCacheStats(CacheStats *stats, size_t capacity) const
+      -> size_t {
+    size_t n = 0;
+    for (size_t i = 0; i < kSizeClassCount && n < capacity; i++) {
+      if (size_caches_[i] != nullptr) {
+        fill_cache_stats(*size_caches_[i], stats[n++]);
+      }
+    }
+    return n;
+  }
+
+  /**
+   * @brief 分配按 alignment 对齐的内存
+   * @details 通用 cache 的对象按自然对齐，因此选择不小于 max(bytes, alignment)
+   *          且对齐满足要求的第一个分级，不需要额外填充，
+   *          返回的内存可以直接使用 Free 释放
+   * @param alignment 对齐字节数，必须是 2 的幂且不超过 kPageSize
+   * @param bytes 请求的字节数
+   * @return void* 成功返回内存指针，失败返回 nullptr
+   * @note 对齐以 slab 页为基准，管理的内存按 kPageSize 对齐时为绝对地址对齐
+   */
+  [[nodiscard]] auto AllocAligned(size_t alignment, size_t bytes) -> void * {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 ||
+        alignment > kPageSize) {
+      return nullptr;
+    }
+    auto size = bytes > alignment ? bytes : alignment;
+    if (size < kMinObjectSize) {
+      size = kMinObjectSize;
+    }
+
+    // 与 Alloc 一样在锁内记录，失败时记录地址为 nullptr 的分配
+    LockGuard guard(lock_);
+    void *ptr = nullptr;
+    auto index =
+        size <= kMaxObjectSize ? SizeClassIndex(size) : kSizeClassCount;
+    while (index < kSizeClassCount && size_caches_[index] != nullptr &&
+           size_caches_[index]->align_ < alignment) {
+      index++;
+    }
+    if (index < kSizeClassCount) {
+      ptr = size_cache_alloc(size_caches_[index], bytes);
+      if (ptr != nullptr &&
+          (reinterpret_cast<uintptr_t>(ptr) & (alignment - 1)) != 0) {
+        // slab 页本身未按 alignment 对齐
+        FreeImpl(ptr, 0);
+        ptr = nullptr;
+      }
+    }
+    this->Record(TraceOp::kAlloc, ptr, bytes);
+    return ptr;
+  }
+
+  /**
+   * @brief 获取 slab 使用的页分配器
+   * @return PageAllocator& 页分配器，可以直接分配超过 kMaxObjectSize 的内存，
+   *         这些内存不属于任何 slab，find_slab 对其返回 nullptr
+   */
+  [[nodiscard]] auto GetPageAllocator() -> PageAllocator & {
+    return page_allocator_;
+  }
+
+  /**
+   * @brief 回收所有 cache 中的空闲 slab，供内存紧张时调用
+   * @details 依次清空每个 cache 的 depot 与当前 CPU 的 magazine，
+   *          然后释放全部空闲 slab（忽略 min_free_slabs_）。
+   *          不能与 kmem_cache_destroy 并发调用
+   * @return size_t 归还给页分配器的页数
+   */
+  auto Reclaim() -> size_t {
+    LockGuard guard(lock_);
+    size_t pages = 0;
+    kmem_cache_t *cachep = nullptr;
+    {
+      SharedLockGuard guard2(cache_cache_.cache_lock_);
+      cachep = all_kmem_cache_;
+    }
+    // 避免在持有 cache_cache_ 锁时获取其它 cache 的锁
+    while (cachep != nullptr) {
+      kmem_cache_drain(cachep);
+      pages += kmem_cache_reap(cachep, 0);
+      SharedLockGuard guard2(cache_cache_.cache_lock_);
+      cachep = cachep->next_;
+    }
+    return pages;
+  }
+
  protected:
+  friend Dispatch;
   struct kmem_cache_t;
-  static constexpr size_t CACHE_L1_LINE_SIZE = 64;
+  static constexpr size_t CACHE_L1_LINE_SIZE = Config::kCacheLineSize;
   // 缓存名称的最大长度
-  static constexpr size_t CACHE_NAMELEN = 20;
+  static constexpr size_t CACHE_NAMELEN = Config::kNameLength;
   // cache_cache_ 的 order 值，表示管理 kmem_cache_t 结构体的 cache
   // 使用的内存块大小
   static constexpr size_t CACHE_CACHE_ORDER = 0;
+  // 为减少浪费而允许提升到的最大 order（对象本身更大时以对象为准）
+  static constexpr uint32_t CACHE_MAX_ORDER = Config::kMaxOrder;
+  // order 的上限，避免对象过大时 kPageSize << order 溢出
+  static constexpr uint32_t CACHE_ORDER_LIMIT = 32;
+  // slab 尾部浪费的上限为 slab 大小的 1/CACHE_WASTE_FRACTION
+  static constexpr size_t CACHE_WASTE_FRACTION = Config::kWasteFraction;
+  // 对象不小于该值时 slab 管理结构存放在 slab 之外（off-slab）
+  static constexpr size_t CACHE_OFF_SLAB_LIMIT = kPageSize / 8;
+  // 释放对象后每个 cache 默认保留的空闲 slab 数量
+  static constexpr size_t CACHE_MIN_FREE_SLABS = Config::kMinFreeSlabs;
+  // 每个 magazine 能保存的对象数量
+  static constexpr size_t CACHE_MAGAZINE_SIZE = Config::kMagazineSize;
+  // 支持 magazine 的最大 CPU 数量
+  static constexpr size_t CACHE_MAX_CPUS = Config::kMaxCpus;
+  // 是否启用 per-CPU magazine 层
+  static constexpr bool kMagazineEnabled =
+      !std::is_same_v<CpuIdFunc, std::nullptr_t>;
+  // 是否启用远程释放：锁支持 TryLock 时，锁被占用的释放操作不等待锁，
+  // 而是无锁地放入对象所属 slab 的远程释放链表
+  static constexpr bool kRemoteFreeEnabled = TryLockable<Lock>;
+  // 通用 cache 的数量，由 SizeClass 决定
+  static constexpr size_t kSizeClassCount = SizeClass::kCount;
+
+  static_assert(std::has_single_bit(CACHE_L1_LINE_SIZE),
+                "cache line size must be a power of 2");
+  // 锁按 BMALLOC_CACHE_LINE_SIZE 对齐，超过配置的缓存行时 kmem_cache_t 的
+  // 冷热分组与配置不符，需要以相同的值定义 BMALLOC_CACHE_LINE_SIZE
+  static_assert(alignof(Lock) <= CACHE_L1_LINE_SIZE,
+                "Lock alignment exceeds Config::kCacheLineSize, define "
+                "BMALLOC_CACHE_LINE_SIZE to the configured line size");
+  static_assert(std::has_single_bit(kPageSize) &&
+                    kPageSize >= CACHE_L1_LINE_SIZE,
+                "page size must be a power of 2 and hold a cache line");
+  // 通用 cache 的名称为 "size-" 加上最多 6 位的对象大小
+  static_assert(kMaxObjectSize < 1000000 &&
+                    CACHE_NAMELEN >= sizeof("size-") + 6,
+                "cache names must hold the size cache names");
+  static_assert(kMinObjectSize >= sizeof(void *) && CACHE_MAGAZINE_SIZE > 0 &&
+                    CACHE_WASTE_FRACTION > 0,
+                "invalid slab configuration");
+
+  /**
+   * 计算请求大小对应的通用 cache 下标
+   *
+   * @param bytes 请求的字节数，范围为 [1, kMaxObjectSize]
+   * @return 向上取整到所属分级后对应的下标
+   */
+  static constexpr auto SizeClassIndex(size_t bytes) -> size_t {
+    return SizeClass::Index(bytes);
+  }
+
+  /**
+   * 计算通用 cache 下标对应的对象大小
+   *
+   * @param index 通用 cache 下标
+   * @return 对象大小
+   */
+  static constexpr auto SizeClassSize(size_t index) -> size_t {
+    return SizeClass::Size(index);
+  }
+
+  /**
+   * 计算 2^order 页大小的 slab 能容纳的对象数量
+   *
+   * @param size 对象大小
+   * @param order slab 的 order 值
+   * @param header slab 页中位于对象之前的管理结构字节数
+   * @param per_object slab 页中每个对象额外占用的空闲链表字节数
+   * @param align 对象数组起始位置相对 slab 页的对齐字节数
+   * @return 对象数量
+   */
+  static constexpr auto slab_objects(size_t size, uint32_t order,
+                                     size_t header = sizeof(slab_t),
+                                     size_t per_object = sizeof(uint32_t),
+                                     size_t align = 1) -> size_t {
+    size_t memory = kPageSize << order;
+    if (memory < header) {
+      return 0;
+    }
+    size_t n = (memory - header) / (per_object + size);
+    // 对齐对象数组起始位置后放不下时减少对象数量
+    while (n > 0 &&
+           align_up(header + per_object * n, align) + n * size > memory) {
+      n--;
+    }
+    return n;
+  }
+
+  /**
+   * 将 value 向上对齐到 align 的整数倍
+   *
+   * @param value 要对齐的值
+   * @param align 对齐字节数，必须是 2 的幂
+   * @return 对齐后的值
+   */
+  static constexpr auto align_up(size_t value, size_t align) -> size_t {
+    return (value + align - 1) & ~(align - 1);
+  }
+
+  /**
+   * 计算 2^order 页大小的 slab 末尾无法容纳对象的字节数
+   *
+   * @param size 对象大小
+   * @param order slab 的 order 值
+   * @param header slab 页中位于对象之前的管理结构字节数
+   * @param per_object slab 页中每个对象额外占用的空闲链表字节数
+   * @param align 对象数组起始位置相对 slab 页的对齐字节数
+   * @return 浪费的字节数
+   */
+  static constexpr auto slab_leftover(size_t size, uint32_t order,
+                                      size_t header = sizeof(slab_t),
+                                      size_t per_object = sizeof(uint32_t),
+                                      size_t align = 1) -> size_t {
+    auto n = slab_objects(size, order, header, per_object, align);
+    return (kPageSize << order) - align_up(header + per_object * n, align) -
+           n * size;
+  }
+
+  /**
+   * 计算 cache 的 slab order 值（参考 Linux 的 calculate_slab_order）
+   *
+   * @param size 对象大小
+   * @param header slab 页中位于对象之前的管理结构字节数
+   * @param per_object slab 页中每个对象额外占用的空闲链表字节数
+   * @param align 对象数组起始位置相对 slab 页的对齐字节数
+   * @return slab 的 order 值
+   *
+   * 功能：
+   * 1. 最小 order 保证一个 slab 至少容纳一个对象
+   * 2. 从最小 order 到 max(最小 order, CACHE_MAX_ORDER) 中选择第一个
+   *    尾部浪费不超过 slab 大小 1/CACHE_WASTE_FRACTION 的 order
+   * 3. 都不满足时选择浪费比例最小的 order
+   */
+  static constexpr auto calculate_slab_order(
+      size_t size, size_t header = sizeof(slab_t),
+      size_t per_object = sizeof(uint32_t), size_t align = 1) -> uint32_t {
+    uint32_t order = 0;
+    while (slab_objects(size, order, header, per_object, align) == 0 &&
+           order < CACHE_ORDER_LIMIT) {
+      order++;
+    }
+
+    auto max_order = order > CACHE_MAX_ORDER ? order : CACHE_MAX_ORDER;
+    auto best = order;
+    for (; order <= max_order; order++) {
+      auto leftover = slab_leftover(size, order, header, per_object, align);
+      if (leftover * CACHE_WASTE_FRACTION <= (kPageSize << order)) {
+        return order;
+      }
+      // leftover / slab 大小 更小时更新 best
+      if (leftover * (kPageSize << best) <
+          slab_leftover(size, best, header, per_object, align) *
+              (kPageSize << order)) {
+        best = order;
+      }
+    }
+    return best;
+  }
+
+  /**
+   * 计算通用 cache 对象的自然对齐（对象大小的最低有效位，最大为 kPageSize）
+   *
+   * @param size 对象大小
+   * @return 对齐字节数
+   */
+  static constexpr auto natural_align(size_t size) -> size_t {
+    size_t align = size & (~size + 1);
+    return align < kPageSize ? align : kPageSize;
+  }
+
+  /**
+   * 计算颜色偏移的单位，不小于缓存行大小且保持对象对齐
+   *
+   * @param align 对象的对齐字节数
+   * @return 颜色偏移的单位
+   */
+  static constexpr auto colour_unit(size_t align) -> size_t {
+    return align > CACHE_L1_LINE_SIZE ? align : CACHE_L1_LINE_SIZE;
+  }
+
+  /**
+   * Slab 布局 - 一个 cache 的 order、每个 slab 的对象数量与颜色偏移乘数
+   *
+   * 通用 cache 的布局由 size_class_layouts() 在编译期计算
+   */
+  struct slab_layout_t {
+    // order of one slab - slab 的 order 值
+    uint32_t order_ = 0;
+    // maximum colour multiplier - 最大颜色偏移乘数
+    uint32_t colour_max_ = 0;
+    // num of objects in one slab - 每个 slab 中的对象数量
+    size_t objects_ = 0;
+    // size cache holding off-slab slab_t - 保存 off-slab 管理结构的通用
+    // cache 下标，kSizeClassCount 表示管理结构位于 slab 页内
+    size_t slab_cache_index_ = kSizeClassCount;
+  };
+
+  /**
+   * 计算 order 固定时的 slab 布局
+   *
+   * @param size 对象大小
+   * @param order slab 的 order 值
+   * @param header slab 页中位于对象之前的管理结构字节数
+   * @param per_object slab 页中每个对象额外占用的空闲链表字节数
+   * @param align 对象数组起始位置相对 slab 页的对齐字节数
+   * @return slab 布局
+   */
+  static constexpr auto order_layout(size_t size, uint32_t order,
+                                     size_t header, size_t per_object,
+                                     size_t align) -> slab_layout_t {
+    slab_layout_t layout;
+    layout.order_ = order;
+    layout.objects_ = slab_objects(size, order, header, per_object, align);
+    layout.colour_max_ = static_cast<uint32_t>(
+        slab_leftover(size, order, header, per_object, align) /
+        colour_unit(align));
+    return layout;
+  }
+
+  /**
+   * 按 calculate_slab_order 选择 order 并计算 slab 布局
+   *
+   * @param size 对象大小
+   * @param header slab 页中位于对象之前的管理结构字节数
+   * @param per_object slab 页中每个对象额外占用的空闲链表字节数
+   * @param align 对象数组起始位置相对 slab 页的对齐字节数
+   * @return slab 布局
+   */
+  static constexpr auto slab_layout(size_t size, size_t header,
+                                    size_t per_object, size_t align)
+      -> slab_layout_t {
+    return order_layout(size,
+                        calculate_slab_order(size, header, per_object, align),
+                        header, per_object, align);
+  }
+
+  /**
+   * 在编译期计算所有通用 cache 的 slab 布局
+   *
+   * @return 以通用 cache 下标索引的布局表
+   *
+   * 与运行时创建 cache 的过程一致：通用 cache 没有构造/析构函数，
+   * 空闲链表索引内嵌在对象中；对象不小于 CACHE_OFF_SLAB_LIMIT 时
+   * 管理结构放在更小的、管理结构位于 slab 页内的通用 cache 中
+   * （见 setup_off_slab）
+   */
+  static constexpr auto size_class_layouts()
+      -> std::array<slab_layout_t, kSizeClassCount> {
+    std::array<slab_layout_t, kSizeClassCount> layouts{};
+    for (size_t i = 0; i < kSizeClassCount; i++) {
+      size_t size = SizeClassSize(i);
+      size_t align = natural_align(size);
+      layouts[i] = slab_layout(size, sizeof(slab_t), 0, align);
+      if (size < CACHE_OFF_SLAB_LIMIT ||
+          sizeof(slab_t) >= CACHE_OFF_SLAB_LIMIT ||
+          sizeof(slab_t) > kMaxObjectSize) {
+        continue;
+      }
+      size_t index = SizeClassIndex(sizeof(slab_t));
+      if (index < i && layouts[index].slab_cache_index_ == kSizeClassCount) {
+        layouts[i] = slab_layout(size, 0, 0, align);
+        layouts[i].slab_cache_index_ = index;
+      }
+    }
+    return layouts;
+  }
+
+  /**
+   * Magazine 结构体 - 保存空闲对象的定长栈（Bonwick magazine）
+   *
+   * 每个 CPU 持有 loaded_ 与 previous_ 两个 magazine，分配与释放只操作
+   * 本 CPU 的 magazine，不需要加锁；magazine 满或空时与 cache 的 depot
+   * 交换
+   */
+  struct magazine_t {
+    // next magazine in depot - depot 链表中的下一个 magazine
+    magazine_t *next_ = nullptr;
+    // num of objects in magazine - 当前保存的对象数量
+    size_t rounds_ = 0;
+    // objects - 保存的对象
+    void *objects_[CACHE_MAGAZINE_SIZE]{};
+  };
+
+  // magazine 相关数据的对齐：启用时独占缓存行，未启用时不额外填充
+  static constexpr size_t kMagazineLineSize =
+      kMagazineEnabled ? CACHE_L1_LINE_SIZE : alignof(void *);
+  // 远程释放链表的对齐：启用时独占缓存行，未启用时不额外填充
+  static constexpr size_t kRemoteLineSize =
+      kRemoteFreeEnabled ? CACHE_L1_LINE_SIZE : alignof(void *);
+
+  // 每个 CPU 的 magazine 对，启用 magazine 时独占缓存行，
+  // 避免不同 CPU 的 magazine 指针互相伪共享
+  struct alignas(kMagazineLineSize) cpu_cache_t {
+    // magazine in use - 当前使用的 magazine
+    magazine_t *loaded_ = nullptr;
+    // previously loaded magazine - 上一个使用的 magazine
+    magazine_t *previous_ = nullptr;
+    // allocs served by magazines - 由 magazine 满足的分配次数
+    StatCounter<> allocs_;
+    // frees into magazines - 放入 magazine 的释放次数
+    StatCounter<> frees_;
+  };
+
+  // per-CPU magazine 的数量，未启用时只保留一个占位
+  static constexpr size_t kCpuCacheCount =
+      kMagazineEnabled ? CACHE_MAX_CPUS : 1;
 
   /**
    * Slab 结构体 - 表示一个内存 slab
    *
-   * 每个 slab 包含多个相同大小的对象，通过链表管理空闲对象
+   * 每个 slab 包含多个相同大小的对象，通过链表管理空闲对象。
+   * 空闲链表有两种形式：
+   * - freeList_ 数组：第 i 项保存对象 i 之后的空闲对象索引
+   * - 内嵌索引（freeList_ 为 nullptr）：索引保存在空闲对象自身的起始处
+   * slab_t 与 freeList_ 默认位于 slab 页的起始处，off-slab cache 的
+   * slab_t 与 freeList_ 则从 kmem_cache_t::slab_cache_ 中分配
+   *
+   * 空闲链表只包含释放过的对象；[bump_, 对象数) 中的对象从未分配过，
+   * 链表为空时按 bump_ 顺序取出并调用构造函数
+   *
+   * remote_free_ 是其它线程无锁释放的对象组成的栈（next 指针保存在对象
+   * 起始处），由持有 cache_lock_ 的线程一次性取走并放回空闲链表
    */
   struct slab_t {
     // offset for this slab - 用于缓存行对齐的偏移量
     uint32_t colouroff_ = 0;
+    // starting adress of slab pages - slab 页的起始地址
+    void *page_ = nullptr;
     // starting adress of objects - 对象数组的起始地址
     void *objects = nullptr;
-    // list of free objects - 空闲对象索引列表
+    // list of free objects - 空闲对象索引列表，内嵌索引时为 nullptr
     int *freeList_ = nullptr;
-    // next free object - 下一个空闲对象的索引
-    int nextFreeObj_ = 0;
+    // next free object - 下一个释放过的空闲对象的索引，-1 表示链表为空
+    int nextFreeObj_ = -1;
     // number of active objects in this slab - 当前使用的对象数量
     uint32_t inuse_ = 0;
+    // objects handed out at least once - 分配过的对象数，其后的对象尚未初始化
+    uint32_t bump_ = 0;
     // next slab in chain - 链表中的下一个slab
     slab_t *next_ = nullptr;
     // previous slab in chain - 链表中的前一个slab
     slab_t *prev_ = nullptr;
     // cache - owner - 拥有此slab的cache
     kmem_cache_t *myCache_ = nullptr;
+    // objects freed without cache_lock_ - 无锁释放、尚未收回的对象栈
+    std::atomic<void *> remote_free_{nullptr};
+    // next slab in kmem_cache_t::remote_slabs_ - 远程释放 slab 链表中的下一个
+    slab_t *remote_next_ = nullptr;
 
     /**
      * @brief slab_t 构造函数
+     * @details 只计算管理结构与对象数组的位置，不写入空闲链表，也不调用
+     *          构造函数。对象在第一次分配时才按 bump_ 顺序初始化，
+     *          因此新增 slab 的代价与对象数无关，未分配过的对象不会被读入缓存
      * @param cache 拥有此slab的cache指针
      * @param addr slab的内存起始地址
      * @param object_count 此slab中的对象数量
@@ -154,44 +690,77 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
     slab_t(kmem_cache_t *cache, void *addr, size_t object_count,
            uint32_t colour_offset)
         : colouroff_(colour_offset),
-          nextFreeObj_(0),
+          page_(addr),
+          nextFreeObj_(-1),
           inuse_(0),
           next_(nullptr),
           prev_(nullptr),
           myCache_(cache) {
       // 设置freeList位置（紧跟在slab_t结构后面）
-      freeList_ =
-          reinterpret_cast<int *>(static_cast<char *>(addr) + sizeof(slab_t));
-
-      // 设置对象数组位置（考虑缓存行对齐）
-      objects = static_cast<void *>(static_cast<char *>(addr) + sizeof(slab_t) +
-                                    sizeof(uint32_t) * object_count +
-                                    CACHE_L1_LINE_SIZE * colouroff_);
-
-      // 初始化空闲对象链表
-      for (size_t i = 0; i < object_count; i++) {
-        freeList_[i] = i + 1;
-      }
-      // 最后一个对象的索引设为-1，表示链表结束
-      if (object_count > 0) {
-        freeList_[object_count - 1] = -1;
+      auto *management = reinterpret_cast<char *>(this) + sizeof(slab_t);
+      size_t freelist_bytes = 0;
+      if (!cache->embedded_free_) {
+        freeList_ = reinterpret_cast<int *>(management);
+        freelist_bytes = sizeof(uint32_t) * object_count;
       }
 
-      // 初始化所有对象（调用构造函数）
-      if (cache && cache->ctor_) {
-        void *obj = objects;
-        for (size_t i = 0; i < object_count; i++) {
-          cache->ctor_(obj);
-          obj = static_cast<void *>(static_cast<char *>(obj) +
-                                    cache->objectSize_);
-        }
+      // 设置对象数组位置（考虑对象对齐与缓存行对齐），off-slab 时对象从页
+      // 起始处开始；对齐以 slab 页为基准，页按 align_ 对齐时对象也按其对齐
+      auto *page = static_cast<char *>(addr);
+      size_t offset = 0;
+      if (cache->slab_cache_ == nullptr) {
+        offset = align_up(management + freelist_bytes - page, cache->align_);
       }
+      objects = static_cast<void *>(page + offset +
+                                    cache->colour_unit() * colouroff_);
     }
 
     /**
      * @brief 默认构造函数（保持向后兼容）
      */
     slab_t() = default;
+
+    /**
+     * @brief 取出一个空闲对象的索引（调用者需持有 cache_lock_，并保证
+     *        inuse_ 小于对象数）
+     * @details 优先复用释放过的对象；空闲链表为空时取出第 bump_ 个从未
+     *          分配过的对象，并在此时调用 cache 的构造函数
+     * @return size_t 对象索引
+     */
+    size_t take_free() {
+      if (nextFreeObj_ >= 0) {
+        auto idx = static_cast<size_t>(nextFreeObj_);
+        nextFreeObj_ = next_free(idx);
+        return idx;
+      }
+      size_t idx = bump_++;
+      if (myCache_->ctor_ != nullptr) {
+        myCache_->ctor_(object_at(idx));
+      }
+      return idx;
+    }
+
+    // 获取空闲对象 idx 之后的空闲对象索引
+    int next_free(size_t idx) const {
+      if (freeList_ != nullptr) {
+        return freeList_[idx];
+      }
+      return *static_cast<const int *>(object_at(idx));
+    }
+
+    // 设置空闲对象 idx 之后的空闲对象索引
+    void set_next_free(size_t idx, int next) {
+      if (freeList_ != nullptr) {
+        freeList_[idx] = next;
+      } else {
+        *static_cast<int *>(object_at(idx)) = next;
+      }
+    }
+
+    // 获取第 idx 个对象的地址
+    void *object_at(size_t idx) const {
+      return static_cast<char *>(objects) + idx * myCache_->objectSize_;
+    }
   };
 
   /**
@@ -201,71 +770,151 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
    * - slabs_full_: 完全使用的 slab
    * - slabs_partial_: 部分使用的 slab
    * - slabs_free_: 完全空闲的 slab
+   *
+   * kmem_cache_t 作为对象连续存放在 cache_cache_ 的 slab 中，因此按缓存行
+   * 对齐，并按访问方式分组，每组从新的缓存行开始：
+   * - 创建后只读的配置（对象大小、order、构造/析构函数等）
+   * - cache_lock_ 保护的 slab 链表与计数器
+   * - 每个 CPU 的 magazine（启用时每项独占缓存行）
+   * - depot_lock_ 保护的 depot
+   * - 其它线程写入的远程释放 slab 链表（启用时）
+   * 相邻 cache 与同一 cache 的不同分组之间不共享缓存行，一个 cache 的锁竞争
+   * 不会使其它 cache 或只读配置所在的缓存行失效
    */
-  struct kmem_cache_t {
-    // list of full slabs - 满 slab 链表
-    slab_t *slabs_full_ = nullptr;
-    // list of partial slabs - 部分使用 slab 链表
-    slab_t *slabs_partial_ = nullptr;
-    // list of free slabs - 空闲 slab 链表
-    slab_t *slabs_free_ = nullptr;
+  struct alignas(CACHE_L1_LINE_SIZE) alignas(Lock) kmem_cache_t {
+    // ---- read-mostly configuration - 创建后只读的配置 ----
     // cache name_ - 缓存名称
     char name_[CACHE_NAMELEN]{};
     // size of one object - 单个对象大小
     size_t objectSize_ = 0;
+    // alignment of objects - 对象起始地址的对齐字节数
+    size_t align_ = 1;
     // num of objects in one slab - 每个 slab 中的对象数量
     size_t objectsInSlab_ = 0;
-    // num of active objects in cache - 活跃对象数量
-    size_t num_active_ = 0;
-    // num of total objects in cache - 总对象数量
-    size_t num_allocations_ = 0;
-    // mutex (uses to lock the cache) - 缓存互斥锁
-    Lock cache_lock_;
     // order of one slab (one slab has 2^order blocks) - slab 的 order 值
     uint32_t order_ = CACHE_CACHE_ORDER;
     // maximum multiplier for offset of first object in slab - 最大颜色偏移乘数
     uint32_t colour_max_ = 0;
-    // multiplier for next slab offset - 下一个 slab 的颜色偏移
-    uint32_t colour_next_ = 0;
-    // false - cache is not growing_ / true - cache is growing_ - 是否正在增长
-    bool growing_ = false;
     // objects constructor - 对象构造函数
     void (*ctor_)(void *) = nullptr;
     // objects destructor - 对象析构函数
     void (*dtor_)(void *) = nullptr;
+    // free index stored inside free objects - 空闲链表索引是否内嵌在对象中
+    bool embedded_free_ = false;
+    // free slabs kept resident after free - 释放对象后保留的空闲 slab 数量
+    size_t min_free_slabs_ = CACHE_MIN_FREE_SLABS;
+    // cache of off-slab slab_t - off-slab 管理结构所在的 cache，nullptr
+    // 表示管理结构位于 slab 页内
+    kmem_cache_t *slab_cache_ = nullptr;
+    // next cache in chain - 下一个 cache（由 cache_cache_ 的锁保护）
+    kmem_cache_t *next_ = nullptr;
+
+    // ---- hot state guarded by cache_lock_ - cache_lock_ 保护的状态 ----
+    // mutex (uses to lock the cache) - 缓存互斥锁
+    alignas(CACHE_L1_LINE_SIZE) alignas(Lock) Lock cache_lock_;
+    // list of full slabs - 满 slab 链表
+    slab_t *slabs_full_ = nullptr;
+    // list of partial slabs - 部分使用 slab 链表
+    slab_t *slabs_partial_ = nullptr;
+    // list of free slabs - 空闲 slab 链表
+    slab_t *slabs_free_ = nullptr;
+    // num of slabs in slabs_free_ - 空闲 slab 数量
+    size_t num_free_slabs_ = 0;
+    // num of active objects in cache - 活跃对象数量
+    StatCounter<size_t> num_active_ = 0;
+    // num of total objects in cache - 总对象数量
+    StatCounter<size_t> num_allocations_ = 0;
+    // high watermark of num_active_ - 活跃对象数量的最大值
+    StatCounter<size_t> peak_active_ = 0;
+    // objects taken from slabs - 从 slab 层取出的对象数
+    StatCounter<> num_slab_allocs_;
+    // objects returned to slabs - 归还 slab 层的对象数
+    StatCounter<> num_slab_frees_;
+    // objects flushed from magazines to slabs - 从 magazine 归还 slab 层的
+    // 对象数（已计入 magazine 的释放次数）
+    StatCounter<> num_flushed_;
+    // slabs taken from page allocator - 获取新 slab 的次数
+    StatCounter<> num_grows_;
+    // slabs returned to page allocator - 归还空闲 slab 的次数
+    StatCounter<> num_shrinks_;
+    // num of requests served by AllocImpl - 通用分配接口的请求次数
+    // （在分配器锁内更新）
+    StatCounter<size_t> num_requests_ = 0;
+    // sum of requested bytes - 通用分配接口请求的总字节数（在分配器锁内更新）
+    StatCounter<size_t> requested_bytes_ = 0;
+    // multiplier for next slab offset - 下一个 slab 的颜色偏移
+    uint32_t colour_next_ = 0;
+    // false - cache is not growing_ / true - cache is growing_ - 是否正在增长
+    bool growing_ = false;
     // last error that happened while working with cache - 最后的错误码
     int error_code_ = 0;
-    // next cache in chain - 下一个 cache
-    kmem_cache_t *next_ = nullptr;
+
+    // ---- per-cpu magazines - 每个 CPU 的 magazine ----
+    // 未启用 magazine 时只是占位，不单独占用缓存行
+    cpu_cache_t cpu_caches_[kCpuCacheCount]{};
+
+    // ---- depot guarded by depot_lock_ - depot_lock_ 保护的 depot ----
+    // mutex (uses to lock the depot) - depot 互斥锁
+    alignas(kMagazineLineSize) alignas(Lock) Lock depot_lock_;
+    // depot of full magazines - depot 中装满对象的 magazine 链表
+    magazine_t *depot_full_ = nullptr;
+    // depot of empty magazines - depot 中空的 magazine 链表
+    magazine_t *depot_empty_ = nullptr;
+
+    // ---- remote frees - 远程释放 ----
+    // slabs with remote_free_ objects - remote_free_ 非空的 slab 链表
+    alignas(kRemoteLineSize) std::atomic<slab_t *> remote_slabs_{nullptr};
 
     kmem_cache_t() = default;
     explicit kmem_cache_t(const char *name, size_t size, void (*ctor)(void *),
-                          void (*dtor)(void *))
-        : ctor_(ctor), dtor_(dtor), next_(nullptr) {
+                          void (*dtor)(void *), size_t align = 1)
+        : align_(align), ctor_(ctor), dtor_(dtor), next_(nullptr) {
       strcpy(name_, name);
 
-      // 计算新 cache 的 order 值（使一个 slab 能容纳至少一个对象）
-      long memory = kPageSize;
-      int order = 0;
-      while ((long)(memory - sizeof(slab_t) - sizeof(uint32_t) - size) < 0) {
-        order++;
-        memory *= 2;
-      }
+      // 没有构造/析构函数时，空闲对象可以保存空闲链表索引
+      embedded_free_ =
+          ctor == nullptr && dtor == nullptr && size >= sizeof(int);
 
-      objectSize_ = size;
-      order_ = order;
+      // 对象大小向上取整到对齐的整数倍，使每个对象都满足对齐；
+      // order 值与每个 slab 中的对象数量由创建者设置
+      objectSize_ = align_up(size, align);
+    }
 
-      // 计算每个 slab 中的对象数量
-      memory -= sizeof(slab_t);
-      int n = 0;
-      while ((long)(memory - sizeof(uint32_t) - size) >= 0) {
-        n++;
-        memory -= sizeof(uint32_t) + size;
-      }
-      objectsInSlab_ = n;
+    // 按 slab 页内的管理结构大小计算 order、对象数量与缓存行对齐参数
+    void set_layout(size_t header, size_t per_object) {
+      set_layout(slab_layout(objectSize_, header, per_object, align_));
+    }
+
+    // 使用预先计算的布局
+    void set_layout(const slab_layout_t &layout) {
+      order_ = layout.order_;
+      objectsInSlab_ = layout.objects_;
+      colour_max_ = layout.colour_max_;
+    }
+
+    // 颜色偏移的单位，不小于缓存行大小且保持对象对齐
+    size_t colour_unit() const { return Slab::colour_unit(align_); }
+
+    // slab 页中位于对象之前的管理结构字节数
+    size_t header_bytes() const {
+      return slab_cache_ != nullptr ? 0 : sizeof(slab_t);
+    }
+
+    // 对象能否远程释放：next 指针保存在对象中，要求对象没有构造/析构函数，
+    // 且能容纳一个指针
+    bool remote_free_ok() const {
+      return embedded_free_ && objectSize_ >= sizeof(void *);
+    }
+
+    // slab 页中每个对象额外占用的空闲链表字节数
+    size_t freelist_bytes() const {
+      return slab_cache_ == nullptr && !embedded_free_ ? sizeof(uint32_t) : 0;
+    }
 
-      // 设置缓存行对齐参数
-      colour_max_ = memory / CACHE_L1_LINE_SIZE;
+    // 记录从 slab 层取出的对象并更新高水位（调用者需持有 cache_lock_）
+    void note_slab_allocs(size_t count) {
+      num_slab_allocs_ += count;
+      peak_active_.Max(num_active_);
     }
 
     void add_slab(slab_t *slab) {
@@ -275,6 +924,7 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
         if (slabs_free_ != nullptr) {
           slabs_free_->prev_ = nullptr;
         }
+        num_free_slabs_--;
         // from free to partial
         if (slab->inuse_ != objectsInSlab_) {
           slab->next_ = slabs_partial_;
@@ -340,6 +990,7 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
         slabs_free_->prev_ = slab;
       }
       slabs_free_ = slab;
+      num_free_slabs_++;
     }
 
     // 将指定 slab 从 full 链表移动到 partial 链表
@@ -373,18 +1024,18 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
           slabs_free_->prev_ = slab;
         }
         slabs_free_ = slab;
+        num_free_slabs_++;
       }
     }
 
     // 在指定链表中寻找指定 slab
     slab_t *find_slab_in_slabs(const void *addr, const slab_t *slabs) const {
-      auto slab_size = kPageSize * (1 << order_);
+      auto slab_size = kPageSize << order_;
       auto slab = slabs;
       while (slab != nullptr) {
-        if (addr > slab && addr < static_cast<const void *>(
-                                      static_cast<const char *>(
-                                          static_cast<const void *>(slab)) +
-                                      slab_size)) {
+        if (addr >= slab->page_ &&
+            addr < static_cast<const void *>(
+                       static_cast<const char *>(slab->page_) + slab_size)) {
           return const_cast<slab_t *>(slab);
         }
         slab = slab->next_;
@@ -401,6 +1052,10 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
    * @param size 每个对象的大小（字节）
    * @param ctor 对象构造函数（可选）
    * @param dtor 对象析构函数（可选）
+   * @param align 对象起始地址的对齐字节数（可选），必须是 2 的幂且不超过
+   *        kPageSize，以 slab 页起始地址为基准
+   * @param layout 编译期计算的通用 cache 布局（可选），为 nullptr 时
+   *        在运行时计算
    * @return 成功返回 cache 指针，失败返回 nullptr
    *
    * 功能：
@@ -413,9 +1068,12 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
    */
   kmem_cache_t *find_create_kmem_cache(const char *name, size_t size,
                                        void (*ctor)(void *),
-                                       void (*dtor)(void *)) {
+                                       void (*dtor)(void *),
+                                       size_t align = 1,
+                                       const slab_layout_t *layout = nullptr) {
     // 参数验证
-    if (name == nullptr || *name == '\0' || (long)size <= 0) {
+    if (name == nullptr || *name == '\0' || (long)size <= 0 || align == 0 ||
+        (align & (align - 1)) != 0 || align > kPageSize) {
       cache_cache_.error_code_ = 1;
       return nullptr;
     }
@@ -434,7 +1092,8 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
     // 在全局 cache 链表中查找是否已存在相同的 cache
     auto ret = all_kmem_cache_;
     while (ret != nullptr) {
-      if (strcmp(ret->name_, name) == 0 && ret->objectSize_ == size) {
+      if (strcmp(ret->name_, name) == 0 &&
+          ret->objectSize_ == align_up(size, align)) {
         return ret;
       }
       ret = ret->next_;
@@ -442,16 +1101,31 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
 
     // 没有找到则新分配一个
     auto slab = find_alloc_slab(cache_cache_);
+    if (slab == nullptr) {
+      return nullptr;
+    }
     // 从slab中分配一个 kmem_cache_t 对象
     auto *list = static_cast<kmem_cache_t *>(slab->objects);
     // 初始化新 cache
-    ret = new (&list[slab->nextFreeObj_]) kmem_cache_t(name, size, ctor, dtor);
+    ret = new (&list[slab->take_free()])
+        kmem_cache_t(name, size, ctor, dtor, align);
+    if (layout != nullptr &&
+        (layout->slab_cache_index_ == kSizeClassCount ||
+         size_caches_[layout->slab_cache_index_] != nullptr)) {
+      if (layout->slab_cache_index_ != kSizeClassCount) {
+        ret->slab_cache_ = size_caches_[layout->slab_cache_index_];
+      }
+      ret->set_layout(*layout);
+    } else {
+      ret->set_layout(sizeof(slab_t), ret->freelist_bytes());
+      setup_off_slab(*ret);
+    }
     ret->next_ = all_kmem_cache_;
     all_kmem_cache_ = ret;
 
-    slab->nextFreeObj_ = slab->freeList_[slab->nextFreeObj_];
     slab->inuse_++;
     cache_cache_.num_active_++;
+    cache_cache_.note_slab_allocs(1);
     cache_cache_.add_slab(slab);
 
     return ret;
@@ -476,25 +1150,52 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
 
     int blocksFreed = 0;
     cachep->error_code_ = 0;
+    drain_remote_frees(*cachep);
     // 只有当存在空闲 slab 且 cache 不在增长时才收缩
-    if (cachep->slabs_free_ != nullptr && cachep->growing_ == false) {
-      // 每个 slab 包含的内存块数
-      int n = 1 << cachep->order_;
-      slab_t *slab;
-      while (cachep->slabs_free_ != nullptr) {
-        slab = cachep->slabs_free_;
-        cachep->slabs_free_ = slab->next_;
-        // 释放 slab 到 buddy 分配器
-        page_allocator_.Free(slab, cachep->order_);
-        blocksFreed += n;
-        cachep->num_allocations_ -= cachep->objectsInSlab_;
-      }
+    if (cachep->growing_ == false) {
+      blocksFreed = release_free_slabs(*cachep, 0);
     }
     // 重置增长标志
     cachep->growing_ = false;
     return blocksFreed;
   }
 
+  /**
+   * 回收 cache 中超出保留数量的空闲 slab
+   *
+   * @param cachep cache 指针
+   * @param keep 保留的空闲 slab 数量
+   * @return 释放的内存块数量
+   *
+   * 与 kmem_cache_shrink 不同，回收不受 growing_ 标志影响，
+   * 供释放路径按 min_free_slabs_ 限制空闲 slab，或在内存紧张时回收内存
+   */
+  int kmem_cache_reap(kmem_cache_t *cachep, size_t keep) {
+    if (cachep == nullptr) {
+      return 0;
+    }
+    LockGuard guard(cachep->cache_lock_);
+    cachep->error_code_ = 0;
+    drain_remote_frees(*cachep);
+    return release_free_slabs(*cachep, keep);
+  }
+
+  /**
+   * 设置 cache 释放对象后保留的空闲 slab 数量
+   *
+   * @param cachep cache 指针
+   * @param count 保留的空闲 slab 数量，0 表示 slab 空闲后立即归还页
+   *
+   * 保留空闲 slab 可以避免在 slab 边界反复分配、释放对象时频繁申请与归还页
+   */
+  void kmem_cache_set_min_free(kmem_cache_t *cachep, size_t count) {
+    if (cachep == nullptr) {
+      return;
+    }
+    LockGuard guard(cachep->cache_lock_);
+    cachep->min_free_slabs_ = count;
+  }
+
   /**
    * 从 cache 分配一个对象
    *
@@ -507,26 +1208,49 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
    * 3. 从slab中分配一个对象
    * 4. 更新slab链表状态（free->partial->full）
    * 5. 调用对象构造函数（如果存在）
+   *
+   * 启用 magazine 层时优先从当前 CPU 的 magazine 中无锁分配
    */
   void *kmem_cache_alloc(kmem_cache_t *cachep) {
     if (cachep == nullptr || *cachep->name_ == '\0') {
       return nullptr;
     }
 
+    if constexpr (kMagazineEnabled) {
+      auto cpu_cache = get_cpu_cache(cachep);
+      if (cpu_cache != nullptr) {
+        auto objp = magazine_alloc(cachep, *cpu_cache);
+        if (objp != nullptr) {
+          return objp;
+        }
+      }
+    }
+
+    return slab_alloc(cachep);
+  }
+
+  /**
+   * 从 slab 层分配一个对象
+   *
+   * @param cachep cache 指针
+   * @return 成功返回对象指针，失败返回 nullptr
+   */
+  void *slab_alloc(kmem_cache_t *cachep) {
     LockGuard guard(cachep->cache_lock_);
 
     cachep->error_code_ = 0;
 
     auto slab = find_alloc_slab(*cachep);
+    if (slab == nullptr) {
+      return nullptr;
+    }
 
     // 从slab中分配对象
-    auto retObject =
-        static_cast<void *>(static_cast<char *>(slab->objects) +
-                            slab->nextFreeObj_ * cachep->objectSize_);
+    auto retObject = slab->object_at(slab->take_free());
 
-    slab->nextFreeObj_ = slab->freeList_[slab->nextFreeObj_];
     slab->inuse_++;
     cachep->num_active_++;
+    cachep->note_slab_allocs(1);
     cachep->add_slab(slab);
 
     return retObject;
@@ -537,6 +1261,8 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
    *
    * @param cachep cache指针
    * @param objp 要释放的对象指针
+   * @param owned 调用者已确定对象属于 cachep（如按分配大小选出的通用
+   *        cache）时为 true，放入 magazine 前不再检查对象的归属
    *
    * 功能：
    * 1. 查找对象所属的slab
@@ -544,59 +1270,330 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
    * 3. 将对象返回到slab的空闲链表
    * 4. 调用对象析构函数（如果存在）
    * 5. 更新slab链表状态（full->partial->free）
+   *
+   * 启用 magazine 层时优先无锁放入当前 CPU 的 magazine，此时对象保持
+   * 已构造状态，析构函数在对象归还 slab 层时调用
    */
-  void kmem_cache_free(kmem_cache_t *cachep, void *objp) {
+  void kmem_cache_free(kmem_cache_t *cachep, void *objp, bool owned = false) {
     if (cachep == nullptr || *cachep->name_ == '\0' || objp == nullptr) {
       return;
     }
 
-    LockGuard guard(cachep->cache_lock_);
+    if constexpr (kMagazineEnabled) {
+      auto cpu_cache = get_cpu_cache(cachep);
+      if (cpu_cache != nullptr && (owned || is_cache_object(cachep, objp)) &&
+          magazine_free(cachep, *cpu_cache, objp)) {
+        return;
+      }
+    }
 
-    cachep->error_code_ = 0;
+    slab_free(cachep, objp);
+  }
 
-    // 标记slab是否在full链表中
-    bool inFullList = true;
+  /**
+   * 将一个对象释放回 slab 层
+   *
+   * @param cachep cache指针
+   * @param objp 要释放的对象指针
+   */
+  void slab_free(kmem_cache_t *cachep, void *objp) {
+    if constexpr (kRemoteFreeEnabled) {
+      // 锁被占用时不等待，交给持有锁的线程在之后收回
+      if (!cachep->cache_lock_.TryLock()) {
+        if (remote_free(cachep, objp)) {
+          return;
+        }
+        cachep->cache_lock_.Lock();
+      }
+      cachep->error_code_ = 0;
+      free_object(cachep, objp);
+      cachep->cache_lock_.Unlock();
+    } else {
+      LockGuard guard(cachep->cache_lock_);
 
-    // 首先在full链表中查找
-    auto slab = cachep->find_slab_in_full(objp);
+      cachep->error_code_ = 0;
 
-    // 如果在full链表中没找到，在partial链表中查找
-    if (slab == nullptr) {
-      inFullList = false;
-      slab = cachep->find_slab_in_partial(objp);
+      free_object(cachep, objp);
     }
+  }
 
-    // 没找到对应的slab
-    if (slab == nullptr) {
-      cachep->error_code_ = 6;
+  /**
+   * 将对象无锁地放入所属 slab 的远程释放链表（mimalloc 风格的 MPSC 栈）
+   *
+   * @param cachep cache 指针
+   * @param objp 要释放的对象指针
+   * @return 成功返回 true，cache 不支持远程释放或对象不属于该 cache 时
+   *         返回 false
+   *
+   * 对象压入 slab 的 remote_free_ 只需要一次 CAS；使链表由空变为非空的
+   * 线程再把 slab 压入 cache 的 remote_slabs_，因此 slab 在其中最多出现
+   * 一次。对象被收回前仍计入 slab 的 inuse_，slab 不会在收回前被释放
+   */
+  bool remote_free(kmem_cache_t *cachep, void *objp) {
+    if (!cachep->remote_free_ok()) {
+      return false;
+    }
+    auto slab = find_slab(objp);
+    if (slab == nullptr || slab->myCache_ != cachep) {
+      return false;
+    }
+    auto offset =
+        static_cast<char *>(objp) - static_cast<char *>(slab->objects);
+    if (offset < 0 ||
+        static_cast<size_t>(offset) >=
+            cachep->objectsInSlab_ * cachep->objectSize_ ||
+        offset % cachep->objectSize_ != 0) {
+      return false;
+    }
+
+    // 对象不一定按指针对齐，使用 memcpy 读写 next 指针
+    auto head = slab->remote_free_.load(std::memory_order_relaxed);
+    do {
+      memcpy(objp, &head, sizeof(head));
+    } while (!slab->remote_free_.compare_exchange_weak(
+        head, objp, std::memory_order_release, std::memory_order_relaxed));
+
+    if (head == nullptr) {
+      auto first = cachep->remote_slabs_.load(std::memory_order_relaxed);
+      do {
+        slab->remote_next_ = first;
+      } while (!cachep->remote_slabs_.compare_exchange_weak(
+          first, slab, std::memory_order_release, std::memory_order_relaxed));
+    }
+    return true;
+  }
+
+  /**
+   * 收回远程释放的对象，放回所属 slab 的空闲链表（调用者需持有 cache_lock_）
+   *
+   * @param cache 要收回的 cache
+   * @return 收回的对象数量
+   */
+  size_t drain_remote_frees(kmem_cache_t &cache) {
+    size_t drained = 0;
+    if constexpr (kRemoteFreeEnabled) {
+      auto slab = cache.remote_slabs_.exchange(nullptr,
+                                               std::memory_order_acquire);
+      while (slab != nullptr) {
+        // 取走对象后 slab 可能被其它线程重新压入，先读出链表中的下一个
+        auto next = slab->remote_next_;
+        auto objp = slab->remote_free_.exchange(nullptr,
+                                                std::memory_order_acquire);
+        // 重复释放会使链表成环，收回的对象数不超过 slab 中的活跃对象数
+        while (objp != nullptr && slab->inuse_ > 0) {
+          void *next_obj = nullptr;
+          memcpy(&next_obj, objp, sizeof(next_obj));
+          auto offset =
+              static_cast<char *>(objp) - static_cast<char *>(slab->objects);
+          release_object(&cache, slab, offset / cache.objectSize_);
+          objp = next_obj;
+          drained++;
+        }
+        if (objp != nullptr) {
+          cache.error_code_ = 7;
+        }
+        slab = next;
+      }
+    }
+    return drained;
+  }
+
+  /**
+   * 从 cache 批量分配对象
+   *
+   * @param cachep cache 指针
+   * @param count 要分配的对象数量
+   * @param ptrs 保存分配结果的数组
+   * @return 成功分配的对象数量 n，结果保存在 ptrs[0, n) 中
+   *
+   * 功能：
+   * 1. 启用 magazine 层时先从当前 CPU 的 magazine 中取出对象
+   * 2. 剩余的对象在一次加锁中从 slab 层分配，每个 slab 连续取到用尽为止
+   */
+  size_t kmem_cache_alloc_bulk(kmem_cache_t *cachep, size_t count,
+                               void **ptrs) {
+    if (cachep == nullptr || *cachep->name_ == '\0' || ptrs == nullptr) {
+      return 0;
+    }
+
+    size_t n = 0;
+    if constexpr (kMagazineEnabled) {
+      auto cpu_cache = get_cpu_cache(cachep);
+      if (cpu_cache != nullptr) {
+        while (n < count) {
+          auto objp = magazine_alloc(cachep, *cpu_cache);
+          if (objp == nullptr) {
+            break;
+          }
+          ptrs[n++] = objp;
+        }
+      }
+    }
+
+    if (n < count) {
+      n += slab_alloc_bulk(cachep, count - n, ptrs + n);
+    }
+    return n;
+  }
+
+  /**
+   * 批量释放 cache 中的对象
+   *
+   * @param cachep cache 指针
+   * @param ptrs 要释放的对象数组，nullptr 表项会被跳过
+   * @param count 对象数量
+   * @param owned 调用者已确定所有对象都属于 cachep 时为 true，
+   *        语义与 kmem_cache_free 相同
+   *
+   * 功能：
+   * 1. 启用 magazine 层时先放入当前 CPU 的 magazine
+   * 2. 剩余的对象在一次加锁中归还 slab 层
+   */
+  void kmem_cache_free_bulk(kmem_cache_t *cachep, void *const *ptrs,
+                            size_t count, bool owned = false) {
+    if (cachep == nullptr || *cachep->name_ == '\0' || ptrs == nullptr) {
       return;
     }
 
-    // 找到slab，将对象返回到slab中
-    slab->inuse_--;
-    cachep->num_active_--;
+    size_t i = 0;
+    if constexpr (kMagazineEnabled) {
+      auto cpu_cache = get_cpu_cache(cachep);
+      if (cpu_cache != nullptr) {
+        while (i < count &&
+               (ptrs[i] == nullptr ||
+                ((owned || is_cache_object(cachep, ptrs[i])) &&
+                 magazine_free(cachep, *cpu_cache, ptrs[i])))) {
+          i++;
+        }
+      }
+    }
+
+    if (i < count) {
+      slab_free_bulk(cachep, ptrs + i, count - i);
+    }
+  }
+
+  /**
+   * 在一次加锁中从 slab 层批量分配对象
+   *
+   * @param cachep cache 指针
+   * @param count 要分配的对象数量
+   * @param ptrs 保存分配结果的数组
+   * @return 成功分配的对象数量
+   */
+  size_t slab_alloc_bulk(kmem_cache_t *cachep, size_t count, void **ptrs) {
+    LockGuard guard(cachep->cache_lock_);
+
+    cachep->error_code_ = 0;
+
+    size_t n = 0;
+    while (n < count) {
+      auto slab = find_alloc_slab(*cachep);
+      if (slab == nullptr) {
+        break;
+      }
+
+      // 从同一个 slab 中连续取出对象，直到 slab 用尽
+      size_t taken = 0;
+      while (n < count && slab->inuse_ < cachep->objectsInSlab_) {
+        ptrs[n++] = slab->object_at(slab->take_free());
+        slab->inuse_++;
+        taken++;
+      }
+      cachep->num_active_ += taken;
+      cachep->note_slab_allocs(taken);
+      cachep->add_slab(slab);
+
+      if (taken == 0) {
+        break;
+      }
+    }
+
+    return n;
+  }
+
+  /**
+   * 在一次加锁中将多个对象归还 slab 层
+   *
+   * @param cachep cache 指针
+   * @param ptrs 要释放的对象数组，nullptr 表项会被跳过
+   * @param count 对象数量
+   * @param flush 对象来自 magazine（释放时已计数）时为 true
+   */
+  void slab_free_bulk(kmem_cache_t *cachep, void *const *ptrs, size_t count,
+                      bool flush = false) {
+    LockGuard guard(cachep->cache_lock_);
+
+    cachep->error_code_ = 0;
+
+    auto freed = cachep->num_slab_frees_.Load();
+    for (size_t i = 0; i < count; i++) {
+      if (ptrs[i] != nullptr) {
+        free_object(cachep, ptrs[i]);
+      }
+    }
+    if (flush) {
+      cachep->num_flushed_ += cachep->num_slab_frees_ - freed;
+    }
+  }
+
+  /**
+   * 将一个对象归还所属的 slab（调用者需持有 cache_lock_）
+   *
+   * @param cachep cache指针
+   * @param objp 要释放的对象指针
+   */
+  void free_object(kmem_cache_t *cachep, void *objp) {
+    // 通过页描述符表查找对象所属的 slab
+    auto slab = find_slab(objp);
+
+    // 没找到对应的slab，或 slab 不属于该 cache
+    if (slab == nullptr || slab->myCache_ != cachep) {
+      cachep->error_code_ = 6;
+      return;
+    }
 
     // 计算对象在数组中的索引
-    auto free_idx =
-        (static_cast<char *>(objp) - static_cast<char *>(slab->objects)) /
-        cachep->objectSize_;
+    auto offset =
+        static_cast<char *>(objp) - static_cast<char *>(slab->objects);
+    auto free_idx = offset / static_cast<long>(cachep->objectSize_);
 
-    // 验证对象地址是否对齐
-    if (objp != static_cast<void *>(static_cast<char *>(slab->objects) +
-                                    free_idx * cachep->objectSize_)) {
+    // 验证对象地址是否在 slab 对象数组内且对齐，slab 中是否有活跃对象
+    if (offset < 0 || static_cast<size_t>(free_idx) >= cachep->objectsInSlab_ ||
+        offset % cachep->objectSize_ != 0 || slab->inuse_ == 0) {
       cachep->error_code_ = 7;
       return;
     }
 
-    // 将对象加入空闲链表
-    slab->freeList_[free_idx] = slab->nextFreeObj_;
-    slab->nextFreeObj_ = free_idx;
-
-    // 调用析构函数
+    // 调用析构函数（在写入内嵌的空闲链表索引之前）
     if (cachep->dtor_ != nullptr) {
       cachep->dtor_(objp);
     }
 
+    release_object(cachep, slab, free_idx);
+  }
+
+  /**
+   * 将 slab 中的一个对象放回空闲链表并更新 slab 链表（调用者需持有
+   * cache_lock_）
+   *
+   * @param cachep cache 指针
+   * @param slab 对象所属的 slab
+   * @param free_idx 对象在 slab 中的索引
+   */
+  void release_object(kmem_cache_t *cachep, slab_t *slab, size_t free_idx) {
+    // slab 原本是否在 full 链表中
+    bool inFullList = slab->inuse_ == cachep->objectsInSlab_;
+
+    // 找到slab，将对象返回到slab中
+    slab->inuse_--;
+    cachep->num_active_--;
+    cachep->num_slab_frees_++;
+
+    // 将对象加入空闲链表
+    slab->set_next_free(free_idx, slab->nextFreeObj_);
+    slab->nextFreeObj_ = free_idx;
+
     // 检查slab现在是否为空闲或部分使用状态，并更新链表
     // slab原本在full链表中
     if (inFullList) {
@@ -610,6 +1607,223 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
     }
   }
 
+  // cache 是否经过 magazine 层，cache_cache_ 与 magazine_cache_ 自身除外
+  bool uses_magazine(const kmem_cache_t *cachep) const {
+    return magazine_cache_ != nullptr && cachep != &cache_cache_ &&
+           cachep != magazine_cache_;
+  }
+
+  /**
+   * 获取当前 CPU 在指定 cache 中的 magazine 对
+   *
+   * @param cachep cache 指针
+   * @return 成功返回 cpu_cache_t 指针，cache 不使用 magazine 或 CPU
+   *         编号超出范围时返回 nullptr
+   */
+  cpu_cache_t *get_cpu_cache(kmem_cache_t *cachep) {
+    if (!uses_magazine(cachep)) {
+      return nullptr;
+    }
+    size_t cpu = CpuIdFunc{}();
+    if (cpu >= CACHE_MAX_CPUS) {
+      return nullptr;
+    }
+    return &cachep->cpu_caches_[cpu];
+  }
+
+  /**
+   * 检查对象是否为 cache 中一个对象的起始地址（不加 cache 锁）
+   *
+   * @param cachep cache 指针
+   * @param objp 对象指针
+   * @return 是返回 true，否则返回 false
+   */
+  bool is_cache_object(kmem_cache_t *cachep, void *objp) {
+    auto slab = find_slab(objp);
+    if (slab == nullptr || slab->myCache_ != cachep) {
+      return false;
+    }
+    auto offset =
+        static_cast<char *>(objp) - static_cast<char *>(slab->objects);
+    return offset >= 0 &&
+           static_cast<size_t>(offset) <
+               cachep->objectsInSlab_ * cachep->objectSize_ &&
+           offset % cachep->objectSize_ == 0;
+  }
+
+  /**
+   * 从当前 CPU 的 magazine 中分配一个对象
+   *
+   * @param cachep cache 指针
+   * @param cpu_cache 当前 CPU 的 magazine 对
+   * @return 成功返回对象指针，magazine 与 depot 均为空时返回 nullptr
+   *
+   * 功能：
+   * 1. loaded_ 非空时直接弹出对象
+   * 2. previous_ 非空时交换 loaded_ 与 previous_
+   * 3. 否则从 depot 中取一个满的 magazine，并将空的 previous_ 归还 depot
+   */
+  void *magazine_alloc(kmem_cache_t *cachep, cpu_cache_t &cpu_cache) {
+    auto loaded = cpu_cache.loaded_;
+    if (loaded == nullptr || loaded->rounds_ == 0) {
+      auto previous = cpu_cache.previous_;
+      if (previous != nullptr && previous->rounds_ > 0) {
+        cpu_cache.previous_ = loaded;
+        cpu_cache.loaded_ = previous;
+      } else {
+        LockGuard guard(cachep->depot_lock_);
+        auto full = cachep->depot_full_;
+        if (full == nullptr) {
+          return nullptr;
+        }
+        cachep->depot_full_ = full->next_;
+        if (previous != nullptr) {
+          previous->next_ = cachep->depot_empty_;
+          cachep->depot_empty_ = previous;
+        }
+        cpu_cache.previous_ = loaded;
+        cpu_cache.loaded_ = full;
+      }
+      loaded = cpu_cache.loaded_;
+    }
+
+    loaded->rounds_--;
+    cpu_cache.allocs_++;
+    return loaded->objects_[loaded->rounds_];
+  }
+
+  /**
+   * 将一个对象放入当前 CPU 的 magazine
+   *
+   * @param cachep cache 指针
+   * @param cpu_cache 当前 CPU 的 magazine 对
+   * @param objp 要释放的对象指针
+   * @return 成功返回 true，无法获得空 magazine 时返回 false
+   *
+   * 功能：
+   * 1. loaded_ 未满时直接压入对象
+   * 2. previous_ 为空时交换 loaded_ 与 previous_
+   * 3. 否则从 depot（或 magazine_cache_）取一个空的 magazine，
+   *    并将满的 previous_ 归还 depot
+   */
+  bool magazine_free(kmem_cache_t *cachep, cpu_cache_t &cpu_cache,
+                     void *objp) {
+    auto loaded = cpu_cache.loaded_;
+    if (loaded == nullptr || loaded->rounds_ == CACHE_MAGAZINE_SIZE) {
+      auto previous = cpu_cache.previous_;
+      if (previous != nullptr && previous->rounds_ == 0) {
+        cpu_cache.previous_ = loaded;
+        cpu_cache.loaded_ = previous;
+      } else {
+        magazine_t *empty = nullptr;
+        {
+          LockGuard guard(cachep->depot_lock_);
+          empty = cachep->depot_empty_;
+          if (empty != nullptr) {
+            cachep->depot_empty_ = empty->next_;
+          }
+        }
+        if (empty == nullptr) {
+          auto ptr = slab_alloc(magazine_cache_);
+          if (ptr == nullptr) {
+            return false;
+          }
+          empty = new (ptr) magazine_t;
+        }
+        empty->next_ = nullptr;
+
+        if (previous != nullptr) {
+          LockGuard guard(cachep->depot_lock_);
+          previous->next_ = cachep->depot_full_;
+          cachep->depot_full_ = previous;
+        }
+        cpu_cache.previous_ = loaded;
+        cpu_cache.loaded_ = empty;
+      }
+      loaded = cpu_cache.loaded_;
+    }
+
+    loaded->objects_[loaded->rounds_] = objp;
+    loaded->rounds_++;
+    cpu_cache.frees_++;
+    return true;
+  }
+
+  /**
+   * 释放 magazine 链表
+   *
+   * @param cachep magazine 所属的 cache
+   * @param magazine magazine 链表头
+   * @param flush 为 true 时先将 magazine 中的对象归还 slab 层
+   */
+  void release_magazines(kmem_cache_t *cachep, magazine_t *magazine,
+                         bool flush) {
+    while (magazine != nullptr) {
+      auto next = magazine->next_;
+      if (flush && magazine->rounds_ > 0) {
+        slab_free_bulk(cachep, magazine->objects_, magazine->rounds_, true);
+      }
+      slab_free(magazine_cache_, magazine);
+      magazine = next;
+    }
+  }
+
+  /**
+   * 释放一个 CPU 的 magazine 对
+   *
+   * @param cachep magazine 所属的 cache
+   * @param cpu_cache 要释放的 magazine 对
+   * @param flush 为 true 时先将 magazine 中的对象归还 slab 层
+   */
+  void release_cpu_cache(kmem_cache_t *cachep, cpu_cache_t &cpu_cache,
+                         bool flush) {
+    if (cpu_cache.loaded_ != nullptr) {
+      cpu_cache.loaded_->next_ = nullptr;
+      release_magazines(cachep, cpu_cache.loaded_, flush);
+      cpu_cache.loaded_ = nullptr;
+    }
+    if (cpu_cache.previous_ != nullptr) {
+      cpu_cache.previous_->next_ = nullptr;
+      release_magazines(cachep, cpu_cache.previous_, flush);
+      cpu_cache.previous_ = nullptr;
+    }
+  }
+
+  /**
+   * 清空 cache 的 depot 与当前 CPU 的 magazine
+   *
+   * @param cachep cache 指针
+   *
+   * 功能：
+   * 1. 将当前 CPU 的 magazine 中的对象归还 slab 层
+   * 2. 将 depot 中所有 magazine 的对象归还 slab 层
+   * 3. 释放上述 magazine，之后可以通过 kmem_cache_shrink 回收空闲 slab
+   */
+  void kmem_cache_drain(kmem_cache_t *cachep) {
+    if constexpr (kMagazineEnabled) {
+      if (cachep == nullptr || *cachep->name_ == '\0') {
+        return;
+      }
+      auto cpu_cache = get_cpu_cache(cachep);
+      if (cpu_cache == nullptr) {
+        return;
+      }
+      release_cpu_cache(cachep, *cpu_cache, true);
+
+      magazine_t *full = nullptr;
+      magazine_t *empty = nullptr;
+      {
+        LockGuard guard(cachep->depot_lock_);
+        full = cachep->depot_full_;
+        empty = cachep->depot_empty_;
+        cachep->depot_full_ = nullptr;
+        cachep->depot_empty_ = nullptr;
+      }
+      release_magazines(cachep, full, true);
+      release_magazines(cachep, empty, true);
+    }
+  }
+
   /**
    * 查找包含指定对象的小内存缓冲区cache
    *
@@ -617,22 +1831,55 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
    * @return 成功返回cache指针，失败返回nullptr
    *
    * 功能：
-   * 1. 遍历所有cache，查找名称以"size-"开头的cache
-   * 2. 在每个小内存cache的slab中查找指定对象
+   * 1. 通过页描述符表找到对象所属的 slab
+   * 2. 检查 slab 所属的 cache 是否为小内存缓冲区cache（名称以"size-"开头）
    * 3. 检查对象地址是否在slab的地址范围内
    */
   kmem_cache_t *find_buffers_cache(const void *objp) {
-    LockGuard guard(cache_cache_.cache_lock_);
+    auto slab = find_slab(objp);
+    if (slab == nullptr || slab->myCache_ == nullptr) {
+      return nullptr;
+    }
 
-    auto curr = all_kmem_cache_;
+    auto cache = slab->myCache_;
+    if (strstr(cache->name_, "size-") != cache->name_) {
+      return nullptr;
+    }
+
+    return cache;
+  }
+
+  /**
+   * 查找包含指定地址的 slab
+   *
+   * @param addr 对象地址
+   * @return 成功返回 slab 指针，失败返回 nullptr
+   *
+   * 功能：
+   * 1. 地址在页描述符表覆盖范围内时，以页号为下标 O(1) 查表
+   * 2. 否则（page_allocator_ 返回了管理区域之外的内存）遍历所有 cache 的
+   *    full/partial 链表
+   */
+  slab_t *find_slab(const void *addr) {
+    if (addr == nullptr) {
+      return nullptr;
+    }
 
+    auto target = reinterpret_cast<uintptr_t>(addr);
+    auto start = reinterpret_cast<uintptr_t>(start_addr_);
+    if (target >= start && target - start < page_map_pages_ * kPageSize) {
+      return page_map_[(target - start) / kPageSize];
+    }
+
+    SharedLockGuard guard(cache_cache_.cache_lock_);
+    auto curr = all_kmem_cache_;
     while (curr != nullptr) {
-      // 找到小内存缓冲区cache
-      if (strstr(curr->name_, "size-") != nullptr) {
-        if (curr->find_slab_in_full(objp) != nullptr ||
-            curr->find_slab_in_partial(objp) != nullptr) {
-          return curr;
-        }
+      auto slab = curr->find_slab_in_full(addr);
+      if (slab == nullptr) {
+        slab = curr->find_slab_in_partial(addr);
+      }
+      if (slab != nullptr) {
+        return slab;
       }
       curr = curr->next_;
     }
@@ -640,6 +1887,43 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
     return nullptr;
   }
 
+  /**
+   * 在页描述符表中登记 slab 占用的所有页
+   *
+   * @param slab slab 指针
+   * @param order slab 的 order 值
+   */
+  void map_slab(slab_t *slab, size_t order) {
+    set_slab_pages(slab, order, slab);
+  }
+
+  /**
+   * 从页描述符表中移除 slab 占用的所有页
+   *
+   * @param slab slab 指针
+   * @param order slab 的 order 值
+   */
+  void unmap_slab(slab_t *slab, size_t order) {
+    set_slab_pages(slab, order, nullptr);
+  }
+
+  // 将 slab 占用的页在页描述符表中的表项设置为 value
+  void set_slab_pages(const slab_t *slab, size_t order, slab_t *value) {
+    auto target = reinterpret_cast<uintptr_t>(slab->page_);
+    auto start = reinterpret_cast<uintptr_t>(start_addr_);
+    if (target < start) {
+      return;
+    }
+    auto first = (target - start) / kPageSize;
+    auto last = first + (static_cast<size_t>(1) << order);
+    if (last > page_map_pages_) {
+      return;
+    }
+    for (auto i = first; i < last; i++) {
+      page_map_[i] = value;
+    }
+  }
+
   /**
    * 销毁cache - 释放cache及其所有slab
    *
@@ -657,113 +1941,167 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
       return;
     }
 
-    LockGuard guard1(cachep->cache_lock_);
-    LockGuard guard2(cache_cache_.cache_lock_);
-
-    cache_cache_.error_code_ = 0;
-
-    // 从 allCaches 链表删除 cache
-    kmem_cache_t *prev = nullptr;
-    kmem_cache_t *curr = all_kmem_cache_;
-    while (curr != cachep) {
-      prev = curr;
-      curr = curr->next_;
-    }
-    // cache 不在 cache 链中（意味着对象也不在cache_cache中）
-    if (curr == nullptr) {
-      cache_cache_.error_code_ = 5;
-      return;
-    }
-
-    if (prev == nullptr) {
-      all_kmem_cache_ = all_kmem_cache_->next_;
-    } else {
-      prev->next_ = curr->next_;
+    // 释放所有 CPU 与 depot 中的 magazine，其中的对象随 slab 一起释放
+    if constexpr (kMagazineEnabled) {
+      if (uses_magazine(cachep)) {
+        for (auto &cpu_cache : cachep->cpu_caches_) {
+          release_cpu_cache(cachep, cpu_cache, false);
+        }
+        release_magazines(cachep, cachep->depot_full_, false);
+        release_magazines(cachep, cachep->depot_empty_, false);
+        cachep->depot_full_ = nullptr;
+        cachep->depot_empty_ = nullptr;
+      }
     }
-    curr->next_ = nullptr;
 
     // 在 cache_cache 中查找拥有该 cache 对象的 slab
-    // 标记slab是否在full链表中
-    bool inFullList = true;
-    auto slab = cache_cache_.find_slab_in_full(cachep);
-
-    if (slab == nullptr) {
-      inFullList = false;
-      slab = cache_cache_.find_slab_in_partial(cachep);
-    }
-
-    // 在 cache_cache 中没找到拥有该 cache 的 slab
-    if (slab == nullptr) {
-      cache_cache_.error_code_ = 5;
-      return;
-    }
-
-    // 重置cache字段并更新cache_cache字段
-    slab->inuse_--;
-    cache_cache_.num_active_--;
-    auto free_idx = cachep - static_cast<kmem_cache_t *>(slab->objects);
-    slab->freeList_[free_idx] = slab->nextFreeObj_;
-    slab->nextFreeObj_ = free_idx;
-    // 清空cache名称
-    *cachep->name_ = '\0';
-    cachep->objectSize_ = 0;
+    // （查找可能需要加 cache_cache_ 锁，因此在加锁前进行）
+    auto slab = find_slab(cachep);
+
+    slab_t *slabs[3] = {};
+    uint32_t order = 0;
+    kmem_cache_t *slab_cache = nullptr;
+    {
+      LockGuard guard1(cachep->cache_lock_);
+      LockGuard guard2(cache_cache_.cache_lock_);
+
+      cache_cache_.error_code_ = 0;
+
+      // 从 allCaches 链表删除 cache
+      kmem_cache_t *prev = nullptr;
+      kmem_cache_t *curr = all_kmem_cache_;
+      while (curr != nullptr && curr != cachep) {
+        prev = curr;
+        curr = curr->next_;
+      }
+      // cache 不在 cache 链中（意味着对象也不在cache_cache中）
+      if (curr == nullptr) {
+        cache_cache_.error_code_ = 5;
+        return;
+      }
 
-    // 释放cache中使用的所有slab
+      if (prev == nullptr) {
+        all_kmem_cache_ = all_kmem_cache_->next_;
+      } else {
+        prev->next_ = curr->next_;
+      }
+      curr->next_ = nullptr;
 
-    // 释放full slab链表
-    slab_t *freeTemp = cachep->slabs_full_;
-    while (freeTemp != nullptr) {
-      auto ptr = freeTemp;
-      freeTemp = freeTemp->next_;
-      page_allocator_.Free(ptr, cachep->order_);
-    }
+      // 在 cache_cache 中没找到拥有该 cache 的 slab
+      if (slab == nullptr || slab->myCache_ != &cache_cache_) {
+        cache_cache_.error_code_ = 5;
+        return;
+      }
 
-    // 释放partial slab链表
-    freeTemp = cachep->slabs_partial_;
-    while (freeTemp != nullptr) {
-      auto ptr = freeTemp;
-      freeTemp = freeTemp->next_;
-      page_allocator_.Free(ptr, cachep->order_);
-    }
+      // 标记slab是否在full链表中
+      bool inFullList = slab->inuse_ == cache_cache_.objectsInSlab_;
+
+      // 重置cache字段并更新cache_cache字段
+      slab->inuse_--;
+      cache_cache_.num_active_--;
+      cache_cache_.num_slab_frees_++;
+      auto free_idx = cachep - static_cast<kmem_cache_t *>(slab->objects);
+      slab->set_next_free(free_idx, slab->nextFreeObj_);
+      slab->nextFreeObj_ = free_idx;
+      // 清空cache名称
+      *cachep->name_ = '\0';
+      cachep->objectSize_ = 0;
+
+      // 记录 cache 中使用的所有 slab，在释放锁后释放
+      slabs[0] = cachep->slabs_full_;
+      slabs[1] = cachep->slabs_partial_;
+      slabs[2] = cachep->slabs_free_;
+      // 未收回的远程释放对象随 slab 一起释放
+      cachep->remote_slabs_.store(nullptr, std::memory_order_relaxed);
+      order = cachep->order_;
+      slab_cache = cachep->slab_cache_;
+
+      // 检查cache_cache中的slab现在是否为空闲或部分使用状态
+      // slab原本在full链表中
+      if (inFullList) {
+        cache_cache_.from_full_to_partial(slab);
+      } else {
+        // slab原本在partial链表中
+        if (slab->inuse_ == 0) {
+          cache_cache_.from_partial_to_free(slab);
+        }
+      }
 
-    // 释放free slab链表
-    freeTemp = cachep->slabs_free_;
-    while (freeTemp != nullptr) {
-      auto ptr = freeTemp;
-      freeTemp = freeTemp->next_;
-      page_allocator_.Free(ptr, cachep->order_);
+      // 如果 free 链表中有多个 slab，保留一个空闲 slab，释放其余的
+      release_free_slabs(cache_cache_, 1);
     }
 
-    // 检查cache_cache中的slab现在是否为空闲或部分使用状态
-    // slab原本在full链表中
-    if (inFullList) {
-      cache_cache_.from_full_to_partial(slab);
-    } else {
-      // slab原本在partial链表中
-      if (slab->inuse_ == 0) {
-        cache_cache_.from_partial_to_free(slab);
+    // 释放cache中使用的所有slab（full、partial、free）
+    // 释放 off-slab 管理结构时可能需要加 cache_cache_ 锁查找 slab
+    for (auto freeTemp : slabs) {
+      while (freeTemp != nullptr) {
+        auto ptr = freeTemp;
+        freeTemp = freeTemp->next_;
+        release_slab(ptr, order, slab_cache);
       }
     }
+  }
 
-    // 如果 free 链表中有多个 slab，释放多余的 slab 以节省内存
-    if (cache_cache_.slabs_free_ != nullptr) {
-      slab = cache_cache_.slabs_free_;
-      auto i = 0;
-      while (slab != nullptr) {
-        i++;
-        slab = slab->next_;
-      }
-
-      // 保留一个空闲 slab，释放其余的
-      while (i > 1) {
-        i--;
-        slab = cache_cache_.slabs_free_;
-        cache_cache_.slabs_free_ = cache_cache_.slabs_free_->next_;
-        slab->next_ = nullptr;
-        cache_cache_.slabs_free_->prev_ = nullptr;
-        page_allocator_.Free(slab, cache_cache_.order_);
-        cache_cache_.num_allocations_ -= cache_cache_.objectsInSlab_;
-      }
+  /**
+   * 不加锁地填充一个 cache 的统计快照
+   *
+   * @param cache 要统计的 cache
+   * @param stats 保存结果的快照
+   *
+   * 分配次数为从 slab 层取出的对象数加上 magazine 命中数；释放次数为
+   * 归还 slab 层的对象数扣除从 magazine 刷回的部分，再加上放入 magazine 的
+   * 次数。计数器分别读取，并发时可能相差正在进行的操作
+   */
+  void fill_cache_stats(const kmem_cache_t &cache, CacheStats &stats) const {
+    stats = CacheStats{};
+    // 配置的名称长度超过快照时截断
+    constexpr size_t kNameBytes = CACHE_NAMELEN < CacheStats::kNameLength
+                                      ? CACHE_NAMELEN
+                                      : CacheStats::kNameLength - 1;
+    memcpy(stats.name_, cache.name_, kNameBytes);
+    stats.object_size_ = cache.objectSize_;
+
+    uint64_t magazine_allocs = 0;
+    uint64_t magazine_frees = 0;
+    for (const auto &cpu_cache : cache.cpu_caches_) {
+      magazine_allocs += cpu_cache.allocs_;
+      magazine_frees += cpu_cache.frees_;
+    }
+    uint64_t slab_frees = cache.num_slab_frees_;
+    uint64_t flushed = cache.num_flushed_;
+    stats.magazine_allocs_ = magazine_allocs;
+    stats.magazine_frees_ = magazine_frees;
+    stats.allocs_ = cache.num_slab_allocs_ + magazine_allocs;
+    stats.frees_ =
+        (slab_frees > flushed ? slab_frees - flushed : 0) + magazine_frees;
+
+    stats.active_objects_ = cache.num_active_;
+    stats.total_objects_ = cache.num_allocations_;
+    stats.peak_active_objects_ = cache.peak_active_;
+    stats.slab_grows_ = cache.num_grows_;
+    stats.slab_shrinks_ = cache.num_shrinks_;
+
+    uint64_t slab_bytes = 0;
+    if (cache.objectsInSlab_ != 0) {
+      slab_bytes = stats.total_objects_ / cache.objectsInSlab_ *
+                   (kPageSize << cache.order_);
+    }
+    uint64_t active_bytes = stats.active_objects_ * cache.objectSize_;
+    stats.fragmentation_bytes_ =
+        slab_bytes > active_bytes ? slab_bytes - active_bytes : 0;
+
+    stats.requests_ = cache.num_requests_;
+    stats.requested_bytes_ = cache.requested_bytes_;
+    uint64_t object_bytes = stats.requests_ * cache.objectSize_;
+    stats.internal_fragmentation_bytes_ =
+        object_bytes > stats.requested_bytes_
+            ? object_bytes - stats.requested_bytes_
+            : 0;
+
+    if constexpr (LockWithStats<Lock>) {
+      auto lock_stats = cache.cache_lock_.GetLockStats();
+      stats.lock_acquisitions_ = lock_stats.acquisitions_;
+      stats.lock_contentions_ = lock_stats.contentions_;
     }
   }
 
@@ -783,7 +2121,7 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
       return;
     }
 
-    LockGuard guard2(cachep->cache_lock_);
+    SharedLockGuard guard2(cachep->cache_lock_);
 
     int i = 0;
 
@@ -817,14 +2155,39 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
       perc = 100 * (double)cachep->num_active_ / cachep->num_allocations_;
     }
 
+    // 计算内部碎片：对象大小向上取整到分级后浪费的字节比例
+    double internal = 0;
+    if (cachep->num_requests_ > 0) {
+      internal = 100 * (1 - (double)cachep->requested_bytes_ /
+                                (cachep->num_requests_ * cachep->objectSize_));
+    }
+
+    // 计算每个 slab 末尾无法容纳对象的字节数
+    size_t tail_waste =
+        slab_leftover(cachep->objectSize_, cachep->order_,
+                      cachep->header_bytes(), cachep->freelist_bytes(),
+                      cachep->align_);
+
     // 打印cache信息
     Log("*** CACHE INFO: ***\n");
-    Log("Name:\t\t\t\t%slab\n", cachep->name_);
+    Log("Name:\t\t\t\t%s\n", cachep->name_);
     Log("Size of one object (in bytes):\t%zu\n", cachep->objectSize_);
     Log("Size of cache (in blocks):\t%d\n", cacheSize);
     Log("Number of slabs:\t\t%d\n", i);
-    Log("Number of objects in one slab:\t%d\n", cachep->objectsInSlab_);
+    Log("Number of objects in one slab:\t%zu\n", cachep->objectsInSlab_);
     Log("Percentage occupancy of cache:\t%.2f %%\n", perc);
+    Log("Internal fragmentation:\t\t%.2f %%\n", internal);
+    Log("Slab tail waste (in bytes):\t%zu\n", tail_waste);
+    Log("Off-slab management:\t\t%s\n",
+        cachep->slab_cache_ != nullptr ? "yes" : "no");
+    Log("Free slabs (kept/minimum):\t%zu/%zu\n", cachep->num_free_slabs_,
+        cachep->min_free_slabs_);
+    if constexpr (LockWithStats<Lock>) {
+      auto stats = cachep->cache_lock_.GetLockStats();
+      Log("Lock acquisitions/contended:\t%llu/%llu\n",
+          static_cast<unsigned long long>(stats.acquisitions_),
+          static_cast<unsigned long long>(stats.contentions_));
+    }
   }
 
   /**
@@ -905,6 +2268,7 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
   using AllocatorBase<LogFunc, Lock>::length_;
   using AllocatorBase<LogFunc, Lock>::free_count_;
   using AllocatorBase<LogFunc, Lock>::used_count_;
+  using AllocatorBase<LogFunc, Lock>::lock_;
 
   PageAllocator page_allocator_;
 
@@ -914,6 +2278,47 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
   // 所有cache的链表头
   kmem_cache_t *all_kmem_cache_ = nullptr;
 
+  // 保存 magazine_t 的内部 cache，未启用 magazine 层时为 nullptr
+  kmem_cache_t *magazine_cache_ = nullptr;
+
+  // 通用 cache，下标由 SizeClassIndex() 计算
+  kmem_cache_t *size_caches_[kSizeClassCount]{};
+
+  // 页描述符表，下标为 (addr - start_addr_) / kPageSize，记录该页所属的 slab
+  slab_t **page_map_ = nullptr;
+
+  // 页描述符表覆盖的页数
+  size_t page_map_pages_ = 0;
+
+  /**
+   * 计算页描述符表占用的字节数（按页向上取整）
+   *
+   * @param bytes 管理的字节数
+   * @return 页描述符表占用的字节数，区域过小无法容纳时返回 0
+   */
+  static constexpr auto PageMapBytes(size_t bytes) -> size_t {
+    auto map_bytes = (bytes / kPageSize) * sizeof(slab_t *);
+    map_bytes = (map_bytes + kPageSize - 1) & ~(kPageSize - 1);
+    return map_bytes < bytes ? map_bytes : 0;
+  }
+
+  /**
+   * 计算交给页分配器的字节数，页描述符表紧随其后
+   *
+   * @param addr 管理的内存起始地址
+   * @param bytes 管理的字节数
+   * @return 页分配器管理的字节数，没有页描述符表时为 bytes
+   */
+  static auto ArenaBytes(void *addr, size_t bytes) -> size_t {
+    auto map_bytes = PageMapBytes(bytes);
+    if (map_bytes == 0) {
+      return bytes;
+    }
+    auto start = reinterpret_cast<uintptr_t>(addr);
+    auto map = (start + bytes - map_bytes) & ~(alignof(slab_t *) - 1);
+    return map - start;
+  }
+
   // 复制字符串
   static char *strcpy(char *dest, const char *src) {
     char *address = dest;
@@ -1044,42 +2449,41 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
    * @return 成功返回内存指针，失败返回nullptr
    *
    * 功能：
-   * 1. 将请求大小向上舍入到2的幂次方
-   * 2. 创建或查找对应大小的cache（命名为"size-XXX"）
-   * 3. 从cache中分配对象
+   * 1. 通过 SizeClassIndex() 计算请求大小对应的通用 cache
+   * 2. 从cache中分配对象
    *
-   * 支持的大小范围：32字节到131072字节
+   * 支持的大小范围：[kMinObjectSize, kMaxObjectSize]，由 SizeClass 策略决定
    */
   [[nodiscard]] auto AllocImpl(size_t bytes) -> void * override {
-    /// @todo 修改大小限制
-    if (bytes < 32 || bytes > 131072) {
+    if (bytes < kMinObjectSize || bytes > kMaxObjectSize) {
       return nullptr;
     }
 
-    // 将size向上舍入到最近的2的幂次方
-    // int j = 1 << (int)(ceil(log2(bytes)));
-    size_t j = 32;
-    while (j < bytes) {
-      j <<= 1;
-    }
-
-    char num[7];
-    void *buff = nullptr;
-
-    // 生成cache名称，格式为"size-XXX"
-    char name[20]{};
-    strcpy(name, "size-");
-    itoa(j, num);
-    strcat(name, num);
+    return size_cache_alloc(size_caches_[SizeClassIndex(bytes)], bytes);
+  }
 
-    // 创建或获取对应大小的 cache
-    auto buffCachep = find_create_kmem_cache(name, j, nullptr, nullptr);
+  /**
+   * 从通用 cache 中分配对象并更新计数器
+   *
+   * @param buffCachep 通用 cache 指针，可以为 nullptr
+   * @param bytes 请求的字节数
+   * @return 成功返回内存指针，失败返回nullptr
+   */
+  auto size_cache_alloc(kmem_cache_t *buffCachep, size_t bytes) -> void * {
+    if (buffCachep == nullptr) {
+      return nullptr;
+    }
+    size_t j = buffCachep->objectSize_;
 
     // 从cache中分配对象
-    buff = kmem_cache_alloc(buffCachep);
+    void *buff = kmem_cache_alloc(buffCachep);
 
     // 更新计数器：分配成功时更新used_count_和free_count_
     if (buff != nullptr) {
+      // 调用者持有分配器锁，计数不需要再获取 cache 锁
+      buffCachep->num_requests_++;
+      buffCachep->requested_bytes_ += bytes;
+
       // 计算分配的页数（对象大小向上舍入到页大小）
       size_t pages_allocated = (j + kPageSize - 1) / kPageSize;
       if (pages_allocated == 0) pages_allocated = 1;
@@ -1093,47 +2497,259 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
     return buff;
   }
 
+  /**
+   * 批量分配小内存缓冲区
+   *
+   * @param bytes 每个缓冲区的大小（字节）
+   * @param count 要分配的数量
+   * @param ptrs 保存分配结果的数组
+   * @return 成功分配的数量
+   */
+  [[nodiscard]] auto AllocBulkImpl(size_t bytes, size_t count, void **ptrs)
+      -> size_t override {
+    if (bytes < kMinObjectSize || bytes > kMaxObjectSize) {
+      return 0;
+    }
+
+    auto buffCachep = size_caches_[SizeClassIndex(bytes)];
+    if (buffCachep == nullptr) {
+      return 0;
+    }
+    size_t j = buffCachep->objectSize_;
+
+    size_t n = kmem_cache_alloc_bulk(buffCachep, count, ptrs);
+
+    if (n > 0) {
+      buffCachep->num_requests_ += n;
+      buffCachep->requested_bytes_ += bytes * n;
+
+      size_t pages_allocated = (j + kPageSize - 1) / kPageSize * n;
+      used_count_ += pages_allocated;
+      if (free_count_ >= pages_allocated) {
+        free_count_ -= pages_allocated;
+      }
+    }
+
+    return n;
+  }
+
+  /**
+   * 原位调整小内存缓冲区的大小
+   *
+   * @param addr 由通用 cache 分配的对象
+   * @param bytes 新的大小
+   * @return 新大小与原对象属于同一个分级时返回 addr，否则返回 nullptr
+   */
+  [[nodiscard]] auto ReallocImpl(void *addr, size_t bytes) -> void * override {
+    if (bytes > kMaxObjectSize) {
+      return nullptr;
+    }
+
+    auto buffCachep = find_buffers_cache(addr);
+    if (buffCachep == nullptr) {
+      return nullptr;
+    }
+
+    if (bytes < kMinObjectSize) {
+      bytes = kMinObjectSize;
+    }
+    if (size_caches_[SizeClassIndex(bytes)] != buffCachep) {
+      return nullptr;
+    }
+    return addr;
+  }
+
+  /**
+   * 批量释放小内存缓冲区
+   *
+   * @param ptrs 要释放的对象数组
+   * @param count 对象数量
+   *
+   * @param bytes 分配时的大小，为 0 时逐个查找对象所属的 cache
+   *
+   * 功能：
+   * 1. 已知大小时所有对象直接归还对应的通用 cache
+   * 2. 否则将连续属于同一个 cache 的对象合并为一次 kmem_cache_free_bulk
+   * 3. 尝试收缩cache以节省内存
+   */
+  void FreeBulkImpl(void *const *ptrs, size_t count, size_t bytes) override {
+    if (ptrs == nullptr) {
+      return;
+    }
+
+    if (auto buffCachep = sized_cache(bytes); buffCachep != nullptr) {
+      kmem_cache_free_bulk(buffCachep, ptrs, count, true);
+      size_t n = 0;
+      for (size_t i = 0; i < count; i++) {
+        n += ptrs[i] != nullptr ? 1 : 0;
+      }
+      release_size_cache_pages(buffCachep, n);
+      return;
+    }
+
+    size_t i = 0;
+    while (i < count) {
+      auto buffCachep = find_buffers_cache(ptrs[i]);
+      if (buffCachep == nullptr) {
+        i++;
+        continue;
+      }
+
+      size_t j = i + 1;
+      while (j < count && find_buffers_cache(ptrs[j]) == buffCachep) {
+        j++;
+      }
+
+      kmem_cache_free_bulk(buffCachep, ptrs + i, j - i);
+      release_size_cache_pages(buffCachep, j - i);
+      i = j;
+    }
+  }
+
   /**
    * 释放小内存缓冲区 - 通用释放接口
    *
    * @param objp 要释放的对象指针
+   * @param bytes 分配时的大小，为 0 时通过页描述符表查找对象所属的 cache
    *
    * 功能：
-   * 1. 查找包含该对象的小内存cache
+   * 1. 已知大小时直接计算对应的通用 cache，否则查找包含该对象的小内存cache
    * 2. 释放对象到对应的cache
-   * 3. 尝试收缩cache以节省内存
+   * 3. 空闲 slab 超过 cache 的保留数量时回收多余的 slab
+   *
+   * @note bytes 必须与分配时的大小属于同一分级（AllocAligned 分配的对象为
+   *       max(bytes, alignment)），否则行为未定义
    */
-  void FreeImpl(void *addr, size_t) override {
+  void FreeImpl(void *addr, size_t bytes) override {
     if (addr == nullptr) {
       return;
     }
 
-    // 查找包含该对象的cache
-    auto buffCachep = find_buffers_cache(addr);
+    // 已知大小时不再查表与比较 cache 名称
+    auto buffCachep = sized_cache(bytes);
+    bool owned = buffCachep != nullptr;
+    if (!owned) {
+      buffCachep = find_buffers_cache(addr);
+    }
     if (buffCachep == nullptr) {
       return;
     }
 
-    // 获取对象大小用于更新计数器
-    size_t object_size = buffCachep->objectSize_;
-
     // 释放对象
-    kmem_cache_free(buffCachep, addr);
+    kmem_cache_free(buffCachep, addr, owned);
+    release_size_cache_pages(buffCachep, 1);
+  }
 
-    // 更新计数器：释放时更新used_count_和free_count_
+  /**
+   * 按分配时的大小计算通用 cache
+   *
+   * @param bytes 分配时的大小
+   * @return bytes 为 0 或超过 kMaxObjectSize 时返回 nullptr
+   */
+  kmem_cache_t *sized_cache(size_t bytes) const {
+    if (bytes == 0 || bytes > kMaxObjectSize) {
+      return nullptr;
+    }
+    return size_caches_[SizeClassIndex(bytes)];
+  }
+
+  /**
+   * 释放对象后更新计数器，并回收多余的空闲 slab
+   *
+   * @param buffCachep 通用 cache 指针
+   * @param count 释放的对象数量
+   */
+  void release_size_cache_pages(kmem_cache_t *buffCachep, size_t count) {
     // 计算释放的页数（对象大小向上舍入到页大小）
-    size_t pages_freed = (object_size + kPageSize - 1) / kPageSize;
-    if (pages_freed == 0) pages_freed = 1;
+    size_t pages_freed =
+        (buffCachep->objectSize_ + kPageSize - 1) / kPageSize * count;
 
     if (used_count_ >= pages_freed) {
       used_count_ -= pages_freed;
     }
     free_count_ += pages_freed;
 
-    // 如果 cache 有空闲 slab, 尝试收缩以节省内存
-    if (buffCachep->slabs_free_ != nullptr) {
-      kmem_cache_shrink(buffCachep);
+    // 空闲 slab 超过保留数量时才回收，避免在 slab 边界反复申请与归还页
+    if (buffCachep->num_free_slabs_ > buffCachep->min_free_slabs_) {
+      kmem_cache_reap(buffCachep, buffCachep->min_free_slabs_);
+    }
+  }
+
+  /**
+   * 为大对象 cache 启用 off-slab 管理结构
+   *
+   * @param cache 新创建的 cache
+   *
+   * 功能：
+   * 1. 对象不小于 CACHE_OFF_SLAB_LIMIT 时，按管理结构不占用 slab 页重新计算
+   *    order 与对象数量
+   * 2. 从通用 cache 中选择容纳 slab_t 与 freeList_ 的 cache 作为
+   *    slab_cache_；该 cache 必须位于 slab 页内，找不到时保持原布局
+   */
+  void setup_off_slab(kmem_cache_t &cache) {
+    if (cache.objectSize_ < CACHE_OFF_SLAB_LIMIT) {
+      return;
+    }
+
+    auto order = calculate_slab_order(cache.objectSize_, 0, 0, cache.align_);
+    auto objects = slab_objects(cache.objectSize_, order, 0, 0, cache.align_);
+    size_t header = sizeof(slab_t);
+    if (!cache.embedded_free_) {
+      header += sizeof(uint32_t) * objects;
+    }
+    if (header >= CACHE_OFF_SLAB_LIMIT || header > kMaxObjectSize) {
+      return;
+    }
+
+    auto slab_cache = size_caches_[SizeClassIndex(header)];
+    if (slab_cache == nullptr || slab_cache == &cache ||
+        slab_cache->slab_cache_ != nullptr) {
+      return;
+    }
+
+    cache.slab_cache_ = slab_cache;
+    cache.set_layout(0, 0);
+  }
+
+  /**
+   * 释放 free 链表头部的空闲 slab，直到只剩 keep 个，调用者需持有 cache 锁
+   *
+   * @param cache 要回收的 cache
+   * @param keep 保留的空闲 slab 数量
+   * @return 释放的内存块数量
+   */
+  int release_free_slabs(kmem_cache_t &cache, size_t keep) {
+    int blocksFreed = 0;
+    while (cache.num_free_slabs_ > keep) {
+      auto slab = cache.slabs_free_;
+      cache.slabs_free_ = slab->next_;
+      if (cache.slabs_free_ != nullptr) {
+        cache.slabs_free_->prev_ = nullptr;
+      }
+      cache.num_free_slabs_--;
+      // 释放 slab 到 buddy 分配器
+      release_slab(slab, cache.order_, cache.slab_cache_);
+      blocksFreed += 1 << cache.order_;
+      cache.num_allocations_ -= cache.objectsInSlab_;
+      cache.num_shrinks_++;
+    }
+    return blocksFreed;
+  }
+
+  /**
+   * 释放一个 slab 占用的页及其 off-slab 管理结构
+   *
+   * @param slab 要释放的 slab
+   * @param order slab 的 order 值
+   * @param slab_cache off-slab 管理结构所在的 cache，位于 slab 页内时为 nullptr
+   */
+  void release_slab(slab_t *slab, uint32_t order, kmem_cache_t *slab_cache) {
+    auto page = slab->page_;
+    unmap_slab(slab, order);
+    if (slab_cache != nullptr) {
+      slab_free(slab_cache, slab);
     }
+    page_allocator_.Free(page, kPageSize << order);
   }
 
   // 在指定 kmem_cache_t 中寻找一个可用的 slab，如果没有找到则新分配一个
@@ -1141,20 +2757,37 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
     // cache 不存在，需要创建新的
     // 寻找可用的 slab 来分配 kmem_cache_t 结构
     auto slab = kmem_cache.slabs_partial_;
+    // partial 链表为空时才收回远程释放的对象
+    if (slab == nullptr && drain_remote_frees(kmem_cache) != 0) {
+      slab = kmem_cache.slabs_partial_;
+    }
     if (slab == nullptr) {
       slab = kmem_cache.slabs_free_;
     }
 
     // 没有足够空间，需要为 kmem_cache 分配更多空间
     if (slab == nullptr) {
-      auto ptr = page_allocator_.Alloc(kPageSize);
+      auto ptr = page_allocator_.Alloc(kPageSize << kmem_cache.order_);
       if (ptr == nullptr) {
         kmem_cache.error_code_ = 2;
         return nullptr;
       }
 
-      slab = new (ptr) slab_t(&kmem_cache, ptr, kmem_cache.objectsInSlab_,
-                              kmem_cache.colour_next_);
+      // off-slab 时 slab_t 与 freeList_ 从 slab_cache_ 中分配
+      void *header = ptr;
+      if (kmem_cache.slab_cache_ != nullptr) {
+        header = slab_alloc(kmem_cache.slab_cache_);
+        if (header == nullptr) {
+          page_allocator_.Free(ptr, kPageSize << kmem_cache.order_);
+          kmem_cache.error_code_ = 2;
+          return nullptr;
+        }
+      }
+
+      slab = new (header) slab_t(&kmem_cache, ptr, kmem_cache.objectsInSlab_,
+                                 kmem_cache.colour_next_);
+
+      map_slab(slab, kmem_cache.order_);
 
       // 新分配的slab将被放入partial链表（因为即将从中分配对象）
       kmem_cache.slabs_partial_ = slab;
@@ -1164,6 +2797,7 @@ class Slab : public AllocatorBase<LogFunc, Lock> {
           (kmem_cache.colour_next_ + 1) % (kmem_cache.colour_max_ + 1);
 
       kmem_cache.num_allocations_ += kmem_cache.objectsInSlab_;
+      kmem_cache.num_grows_++;
       kmem_cache.growing_ = true;
     }
 
@@ -0,0 +1,149 @@
+/**
+ * Copyright The bmalloc Contributors
+ */
+
+#ifndef BMALLOC_SRC_INCLUDE_STATS_HPP_
+#define BMALLOC_SRC_INCLUDE_STATS_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace bmalloc {
+
+/**
+ * @brief 统计计数器
+ * @details 只由持有保护它的锁（或独占所属 CPU）的线程修改，与 LockCounters
+ *          相同，使用 relaxed 的读写代替原子读-改-写指令；其它线程可以不加锁
+ *          读取到不撕裂的值。提供与整数相同的运算符，
+ *          可以直接替换锁保护的整数成员
+ * @tparam T 计数的整数类型
+ */
+template <class T = uint64_t>
+class StatCounter {
+ public:
+  constexpr StatCounter(T value = 0) : value_(value) {}
+  StatCounter(const StatCounter& other) : value_(other.Load()) {}
+  auto operator=(const StatCounter& other) -> StatCounter& {
+    Store(other.Load());
+    return *this;
+  }
+  auto operator=(T value) -> StatCounter& {
+    Store(value);
+    return *this;
+  }
+  ~StatCounter() = default;
+
+  operator T() const { return Load(); }
+
+  auto operator+=(T n) -> StatCounter& {
+    Store(Load() + n);
+    return *this;
+  }
+  auto operator-=(T n) -> StatCounter& {
+    Store(Load() - n);
+    return *this;
+  }
+  auto operator++() -> StatCounter& { return *this += 1; }
+  auto operator--() -> StatCounter& { return *this -= 1; }
+  auto operator++(int) -> T {
+    T old = Load();
+    Store(old + 1);
+    return old;
+  }
+  auto operator--(int) -> T {
+    T old = Load();
+    Store(old - 1);
+    return old;
+  }
+
+  /// 不小于 value 时保持不变，否则更新为 value（用于高水位）
+  void Max(T value) {
+    if (value > Load()) {
+      Store(value);
+    }
+  }
+
+  [[nodiscard]] auto Load() const -> T {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void Store(T value) { value_.store(value, std::memory_order_relaxed); }
+
+  std::atomic<T> value_;
+};
+
+/**
+ * @brief 分配器的统计快照
+ * @details 由 GetStats() 不加锁地填充。各字段分别读取，
+ *          并发分配时字段之间可能相差正在进行的操作。
+ *          used_、free_ 与 peak_used_ 的单位与 GetUsedCount() 相同
+ */
+struct AllocatorStats {
+  /// 成功的分配次数，批量分配按内存块计
+  uint64_t allocs_;
+  /// 失败的分配次数
+  uint64_t failed_allocs_;
+  /// 释放次数，批量释放按内存块计
+  uint64_t frees_;
+  /// 已使用的数量
+  uint64_t used_;
+  /// 空闲的数量
+  uint64_t free_;
+  /// used_ 的最大值
+  uint64_t peak_used_;
+  /// 分配器锁的获取次数，锁不提供竞争统计时为 0
+  uint64_t lock_acquisitions_;
+  /// 获取分配器锁时发生等待的次数，锁不提供竞争统计时为 0
+  uint64_t lock_contentions_;
+};
+
+/**
+ * @brief 一个 slab cache 的统计快照
+ * @details 对象数以 slab 层为准：magazine 与线程缓存中的空闲对象计为活跃
+ */
+struct CacheStats {
+  /// 名称的最大长度（含结尾的 '\0'）
+  static constexpr size_t kNameLength = 20;
+
+  /// cache 名称
+  char name_[kNameLength];
+  /// 对象大小
+  uint64_t object_size_;
+  /// 分配次数，包括 magazine 命中
+  uint64_t allocs_;
+  /// 释放次数，包括放入 magazine
+  uint64_t frees_;
+  /// 由 magazine 满足的分配次数
+  uint64_t magazine_allocs_;
+  /// 放入 magazine 的释放次数
+  uint64_t magazine_frees_;
+  /// 活跃对象数
+  uint64_t active_objects_;
+  /// 所有 slab 中的对象总数
+  uint64_t total_objects_;
+  /// active_objects_ 的最大值
+  uint64_t peak_active_objects_;
+  /// 从页分配器获取新 slab 的次数
+  uint64_t slab_grows_;
+  /// 将空闲 slab 归还页分配器的次数
+  uint64_t slab_shrinks_;
+  /// slab 占用的页中没有被活跃对象使用的字节数
+  /// （空闲对象、管理结构与 slab 尾部浪费）
+  uint64_t fragmentation_bytes_;
+  /// 通用分配接口（按大小分配）的请求次数
+  uint64_t requests_;
+  /// 上述请求的总字节数
+  uint64_t requested_bytes_;
+  /// 内部碎片：上述请求占用的对象字节数与请求字节数之差（累计值）
+  uint64_t internal_fragmentation_bytes_;
+  /// cache 锁的获取次数，锁不提供竞争统计时为 0
+  uint64_t lock_acquisitions_;
+  /// 获取 cache 锁时发生等待的次数，锁不提供竞争统计时为 0
+  uint64_t lock_contentions_;
+};
+
+}  // namespace bmalloc
+
+#endif /* BMALLOC_SRC_INCLUDE_STATS_HPP_ */
@@ -0,0 +1,217 @@
+/**
+ * Copyright The bmalloc Contributors
+ */
+
+#ifndef BMALLOC_SRC_INCLUDE_THREAD_CACHE_HPP_
+#define BMALLOC_SRC_INCLUDE_THREAD_CACHE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace bmalloc {
+
+/**
+ * @brief Bmalloc 的线程缓存策略
+ * @details 每个策略提供以下接口：
+ *          - kEnabled：是否启用线程缓存
+ *          - kMaxSize：缓存的最大对象大小
+ *          - kMaxBytesPerClass / kMaxObjectsPerClass：每个分级缓存的容量上限
+ *          - ThreadKey()：返回当前线程的标识，线程存活期间唯一
+ *          - Slot(id)：返回当前线程中编号为 id 的分配器的缓存指针槽位
+ */
+
+/**
+ * @brief 不启用线程缓存，所有请求直接访问 slab
+ * @details 默认策略，不使用线程局部存储，适用于 freestanding 环境
+ */
+struct NoThreadCache {
+  static constexpr bool kEnabled = false;
+  static constexpr size_t kMaxSize = 0;
+  static constexpr size_t kMaxBytesPerClass = 0;
+  static constexpr size_t kMaxObjectsPerClass = 0;
+};
+
+/**
+ * @brief 使用 thread_local 的线程缓存（tcmalloc 风格）
+ * @tparam MaxSize 缓存的最大对象大小
+ * @tparam MaxBytesPerClass 每个分级缓存的最大字节数
+ * @tparam MaxObjectsPerClass 每个分级缓存的最大对象数
+ * @tparam Slots 每个线程同时缓存的分配器数量，超出时轮流替换槽位，
+ *         被替换的分配器下次访问时从其缓存链表中重新查找
+ */
+template <size_t MaxSize = 32768, size_t MaxBytesPerClass = 65536,
+          size_t MaxObjectsPerClass = 64, size_t Slots = 4>
+struct ThreadLocalCache {
+  static constexpr bool kEnabled = true;
+  static constexpr size_t kMaxSize = MaxSize;
+  static constexpr size_t kMaxBytesPerClass = MaxBytesPerClass;
+  static constexpr size_t kMaxObjectsPerClass = MaxObjectsPerClass;
+
+  /// 当前线程的标识：线程局部变量的地址，线程退出后可能被新线程复用
+  static auto ThreadKey() -> uintptr_t {
+    thread_local char key;
+    return reinterpret_cast<uintptr_t>(&key);
+  }
+
+  /// 分配一个新的分配器编号，编号不会重复使用
+  static auto NextId() -> uint64_t {
+    static std::atomic<uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 返回当前线程中编号为 id 的分配器的缓存指针槽位
+   * @param id 分配器编号
+   * @return void*& 槽位，新分配的槽位为 nullptr
+   */
+  static auto Slot(uint64_t id) -> void*& {
+    struct Entry {
+      uint64_t id_ = 0;
+      void* cache_ = nullptr;
+    };
+    thread_local Entry entries[Slots];
+    thread_local size_t victim = 0;
+
+    for (auto& entry : entries) {
+      if (entry.id_ == id) {
+        return entry.cache_;
+      }
+    }
+    auto& entry = entries[victim];
+    victim = (victim + 1) % Slots;
+    entry.id_ = id;
+    entry.cache_ = nullptr;
+    return entry.cache_;
+  }
+};
+
+/**
+ * @brief 一个线程的分配缓存
+ * @details 每个分级保存一个空闲对象的单链表，next 指针保存在空闲对象的
+ *          起始处。缓存只由其所属的线程访问，回收时通过 busy_ 标志与所属线程
+ *          互斥：任一方无法获取标志时放弃访问缓存，因此不需要加锁
+ * @tparam SizeClass 大小分级策略，与 slab 的通用 cache 一致
+ * @tparam Policy 线程缓存策略
+ */
+template <class SizeClass, class Policy>
+class ThreadCache {
+ public:
+  /// 缓存的分级数量
+  static constexpr size_t kClassCount =
+      Policy::kMaxSize < SizeClass::kMinSize
+          ? 0
+          : SizeClass::Index(Policy::kMaxSize) + 1;
+
+  /// 第 index 级缓存的最大对象数
+  static constexpr auto Capacity(size_t index) -> size_t {
+    size_t capacity = Policy::kMaxBytesPerClass / SizeClass::Size(index);
+    if (capacity > Policy::kMaxObjectsPerClass) {
+      capacity = Policy::kMaxObjectsPerClass;
+    }
+    return capacity < 2 ? 2 : capacity;
+  }
+
+  /// 第 index 级缓存一次从 slab 补充或归还的对象数
+  static constexpr auto BatchSize(size_t index) -> size_t {
+    return Capacity(index) / 2;
+  }
+
+  /// 批量补充与归还的最大对象数
+  static constexpr size_t kMaxBatch =
+      Policy::kMaxObjectsPerClass / 2 < 1 ? 1
+                                          : Policy::kMaxObjectsPerClass / 2;
+
+  explicit ThreadCache(uintptr_t thread_key) : thread_key_(thread_key) {}
+
+  ThreadCache(const ThreadCache&) = delete;
+  ThreadCache(ThreadCache&&) = delete;
+  auto operator=(const ThreadCache&) -> ThreadCache& = delete;
+  auto operator=(ThreadCache&&) -> ThreadCache& = delete;
+  ~ThreadCache() = default;
+
+  /**
+   * @brief 获取缓存的访问权
+   * @return bool 成功返回 true，缓存正在被其它线程回收时返回 false
+   */
+  auto Acquire() -> bool {
+    return !busy_.exchange(true, std::memory_order_acquire);
+  }
+
+  /// 释放缓存的访问权
+  void Release() { busy_.store(false, std::memory_order_release); }
+
+  /// 从第 index 级取出一个对象，为空时返回 nullptr
+  auto Pop(size_t index) -> void* {
+    auto& list = lists_[index];
+    used_.store(true, std::memory_order_relaxed);
+    void* ptr = list.head_;
+    if (ptr != nullptr) {
+      list.head_ = *static_cast<void**>(ptr);
+      list.length_--;
+    }
+    return ptr;
+  }
+
+  /// 将对象放入第 index 级，已满时返回 false
+  auto Push(size_t index, void* ptr) -> bool {
+    auto& list = lists_[index];
+    used_.store(true, std::memory_order_relaxed);
+    if (list.length_ >= Capacity(index)) {
+      return false;
+    }
+    *static_cast<void**>(ptr) = list.head_;
+    list.head_ = ptr;
+    list.length_++;
+    return true;
+  }
+
+  /**
+   * @brief 从第 index 级取出最多 count 个对象
+   * @param index 分级下标
+   * @param count 要取出的数量
+   * @param ptrs 保存取出的对象
+   * @return size_t 取出的数量
+   */
+  auto Take(size_t index, size_t count, void** ptrs) -> size_t {
+    auto& list = lists_[index];
+    size_t n = 0;
+    while (n < count && list.head_ != nullptr) {
+      ptrs[n++] = list.head_;
+      list.head_ = *static_cast<void**>(list.head_);
+    }
+    list.length_ -= n;
+    return n;
+  }
+
+  /// 第 index 级缓存的对象数
+  [[nodiscard]] auto Length(size_t index) const -> size_t {
+    return lists_[index].length_;
+  }
+
+  /// 自上次回收以来是否被使用过，并清除该标记
+  auto TestAndClearUsed() -> bool {
+    return used_.exchange(false, std::memory_order_relaxed);
+  }
+
+  /// 所属线程的标识
+  uintptr_t thread_key_ = 0;
+  /// 分配器中的下一个线程缓存
+  ThreadCache* next_ = nullptr;
+
+ private:
+  struct FreeList {
+    void* head_ = nullptr;
+    size_t length_ = 0;
+  };
+
+  FreeList lists_[kClassCount > 0 ? kClassCount : 1]{};
+  /// 正在被所属线程或回收操作访问
+  std::atomic<bool> busy_{false};
+  /// 自上次回收以来是否被使用过
+  std::atomic<bool> used_{false};
+};
+
+}  // namespace bmalloc
+
+#endif /* BMALLOC_SRC_INCLUDE_THREAD_CACHE_HPP_ */
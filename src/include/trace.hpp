@@ -0,0 +1,123 @@
+/**
+ * Copyright The bmalloc Contributors
+ */
+
+#ifndef BMALLOC_SRC_INCLUDE_TRACE_HPP_
+#define BMALLOC_SRC_INCLUDE_TRACE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bmalloc {
+
+/**
+ * @brief 跟踪记录的操作类型
+ */
+enum class TraceOp : uint8_t {
+  /// 分配，address_ 为分配结果（失败时为 0）
+  kAlloc = 1,
+  /// 释放
+  kFree = 2,
+  /// 原位调整大小成功，size_ 为新的长度
+  kRealloc = 3,
+};
+
+/**
+ * @brief 一条分配跟踪记录
+ * @details 固定 24 字节，可以直接按内存布局写入文件，由回放工具读取。
+ *          size_ 为调用时传入的长度，单位与分配器一致（FirstFit 为页数，
+ *          其它分配器为字节数），超过 32 位时截断为 UINT32_MAX
+ */
+struct TraceRecord {
+  /// 时间戳，未提供时钟时为记录的序号
+  uint64_t timestamp_;
+  /// 内存块地址
+  uint64_t address_;
+  /// 请求的长度
+  uint32_t size_;
+  /// 操作类型
+  TraceOp op_;
+  uint8_t reserved_[3];
+};
+
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord must stay compact");
+
+/**
+ * @brief 保存跟踪记录的环形缓冲区
+ * @details 记录数组由调用者提供，写满后覆盖最早的记录，记录时不分配内存。
+ *          Record() 在分配器的锁内调用，一个缓冲区只能同时交给一个分配器
+ *          （或一组共用同一把锁的调用者）；读取时调用者需保证没有并发写入
+ */
+class TraceBuffer {
+ public:
+  /// 时间戳函数，如 rdtsc 或内核的单调时钟
+  using Clock = uint64_t (*)();
+
+  /**
+   * @brief 构造跟踪缓冲区
+   * @param records 记录数组
+   * @param capacity 记录数组能容纳的记录数
+   * @param clock 时间戳函数，为 nullptr 时使用记录序号
+   */
+  TraceBuffer(TraceRecord* records, size_t capacity, Clock clock = nullptr)
+      : records_(records), capacity_(capacity), clock_(clock) {}
+
+  TraceBuffer(const TraceBuffer&) = delete;
+  TraceBuffer(TraceBuffer&&) = delete;
+  auto operator=(const TraceBuffer&) -> TraceBuffer& = delete;
+  auto operator=(TraceBuffer&&) -> TraceBuffer& = delete;
+  ~TraceBuffer() = default;
+
+  /**
+   * @brief 追加一条记录，缓冲区已满时覆盖最早的记录
+   * @param op 操作类型
+   * @param addr 内存块地址
+   * @param size 请求的长度
+   */
+  void Record(TraceOp op, const void* addr, size_t size) {
+    if (capacity_ == 0) {
+      return;
+    }
+    auto& record = records_[written_ % capacity_];
+    record.timestamp_ = clock_ != nullptr ? clock_() : written_;
+    record.address_ = reinterpret_cast<uintptr_t>(addr);
+    record.size_ = size > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(size);
+    record.op_ = op;
+    record.reserved_[0] = record.reserved_[1] = record.reserved_[2] = 0;
+    written_++;
+  }
+
+  /// 缓冲区中保存的记录数
+  [[nodiscard]] auto Size() const -> size_t {
+    return written_ < capacity_ ? static_cast<size_t>(written_) : capacity_;
+  }
+
+  /// 写入过的记录总数，超过容量的部分已被覆盖
+  [[nodiscard]] auto Written() const -> uint64_t { return written_; }
+
+  /// 因缓冲区已满而被覆盖的记录数
+  [[nodiscard]] auto Dropped() const -> uint64_t {
+    return written_ - Size();
+  }
+
+  /**
+   * @brief 按时间顺序访问保存的记录
+   * @param index 下标，0 为最早的记录，范围为 [0, Size())
+   */
+  [[nodiscard]] auto operator[](size_t index) const -> const TraceRecord& {
+    return records_[(Dropped() + index) % capacity_];
+  }
+
+  /// 清空缓冲区
+  void Clear() { written_ = 0; }
+
+ private:
+  TraceRecord* records_;
+  size_t capacity_;
+  Clock clock_;
+  uint64_t written_ = 0;
+};
+
+}  // namespace bmalloc
+
+#endif /* BMALLOC_SRC_INCLUDE_TRACE_HPP_ */
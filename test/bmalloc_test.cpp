@@ -972,3 +972,400 @@ TEST_F(BmallocTest, AlignedAndRegularMallocMixed) {
     }
   }
 }
+
+// 批量分配与释放测试
+TEST_F(BmallocTest, BulkMallocAndFree) {
+  constexpr size_t kCount = 64;
+  void* ptrs[kCount] = {};
+
+  size_t n = allocator->malloc_bulk(128, kCount, ptrs);
+  ASSERT_EQ(n, kCount);
+
+  std::set<void*> unique(ptrs, ptrs + kCount);
+  EXPECT_EQ(unique.size(), kCount);
+
+  for (size_t i = 0; i < kCount; i++) {
+    ASSERT_NE(ptrs[i], nullptr);
+    std::memset(ptrs[i], static_cast<int>(i), 128);
+  }
+  for (size_t i = 0; i < kCount; i++) {
+    EXPECT_EQ(static_cast<unsigned char*>(ptrs[i])[127], i);
+  }
+
+  allocator->free_bulk(ptrs, kCount);
+
+  EXPECT_EQ(allocator->malloc_bulk(0, kCount, ptrs), 0);
+  EXPECT_EQ(allocator->malloc_bulk(128, kCount, nullptr), 0);
+  EXPECT_NO_THROW(allocator->free_bulk(nullptr, kCount));
+}
+
+// 分层分配测试：小内存由 slab 分配，大内存由 buddy 分配，释放后可以重复使用
+TEST_F(BmallocTest, TieredSmallAndLarge) {
+  // 小于 slab 最小对象的请求向上取整
+  void* tiny = allocator->malloc(8);
+  ASSERT_NE(tiny, nullptr);
+  EXPECT_EQ(allocator->malloc_size(tiny), 32);
+
+  void* small = allocator->malloc(100);
+  ASSERT_NE(small, nullptr);
+  EXPECT_EQ(allocator->malloc_size(small), 128);
+
+  // 超过 slab 上限的请求由 buddy 分配
+  constexpr size_t kLarge = 1024 * 1024;
+  void* large = allocator->malloc(kLarge);
+  ASSERT_NE(large, nullptr);
+  EXPECT_GE(allocator->malloc_size(large), kLarge);
+  std::memset(large, 0x5A, kLarge);
+  EXPECT_EQ(static_cast<unsigned char*>(large)[kLarge - 1], 0x5A);
+
+  // 大内存的 realloc 保留数据
+  void* grown = allocator->realloc(large, 2 * kLarge);
+  ASSERT_NE(grown, nullptr);
+  EXPECT_EQ(static_cast<unsigned char*>(grown)[kLarge - 1], 0x5A);
+  allocator->free(grown);
+
+  // 累计分配量远超管理内存，释放后内存必须归还
+  for (int i = 0; i < 64; i++) {
+    void* ptr = allocator->malloc(kLarge);
+    ASSERT_NE(ptr, nullptr) << "large block not returned, iteration " << i;
+    allocator->free(ptr);
+
+    void* obj = allocator->malloc(64 * 1024);
+    ASSERT_NE(obj, nullptr) << "slab object not returned, iteration " << i;
+    allocator->free(obj);
+  }
+
+  // 混合批量释放
+  void* ptrs[4] = {allocator->malloc(64), allocator->malloc(kLarge),
+                   allocator->malloc(256), nullptr};
+  ASSERT_NE(ptrs[0], nullptr);
+  ASSERT_NE(ptrs[1], nullptr);
+  ASSERT_NE(ptrs[2], nullptr);
+  allocator->free_bulk(ptrs, 4);
+  void* again = allocator->malloc(kLarge);
+  EXPECT_NE(again, nullptr);
+  allocator->free(again);
+
+  allocator->free(small);
+  allocator->free(tiny);
+}
+
+// 原位 realloc 测试
+TEST_F(BmallocTest, ReallocInPlace) {
+  // slab：新大小属于同一分级时不移动
+  void* small = allocator->malloc(100);
+  ASSERT_NE(small, nullptr);
+  std::memset(small, 0x11, 100);
+  EXPECT_EQ(allocator->realloc(small, 128), small);
+  EXPECT_EQ(allocator->realloc(small, 65), small);
+
+  // 超出分级时移动并保留数据
+  void* moved = allocator->realloc(small, 129);
+  ASSERT_NE(moved, nullptr);
+  EXPECT_NE(moved, small);
+  EXPECT_EQ(static_cast<unsigned char*>(moved)[99], 0x11);
+  EXPECT_EQ(allocator->malloc_size(moved), 256);
+  allocator->free(moved);
+
+  // buddy：同一级的大小不移动
+  constexpr size_t kLarge = 512 * 1024;
+  void* large = allocator->malloc(kLarge);
+  ASSERT_NE(large, nullptr);
+  size_t block = allocator->malloc_size(large);
+  std::memset(large, 0x22, kLarge);
+  EXPECT_EQ(allocator->realloc(large, block), large);
+  EXPECT_EQ(allocator->realloc(large, block / 2 + 1), large);
+
+  // 缩小后的块仍由 buddy 管理，数据保留
+  void* shrunk = allocator->realloc(large, 200 * 1024);
+  ASSERT_NE(shrunk, nullptr);
+  EXPECT_LT(allocator->malloc_size(shrunk), block);
+  EXPECT_EQ(static_cast<unsigned char*>(shrunk)[200 * 1024 - 1], 0x22);
+
+  // 增长后数据保留
+  void* grown = allocator->realloc(shrunk, 2 * kLarge);
+  ASSERT_NE(grown, nullptr);
+  EXPECT_GE(allocator->malloc_size(grown), 2 * kLarge);
+  EXPECT_EQ(static_cast<unsigned char*>(grown)[0], 0x22);
+  EXPECT_EQ(static_cast<unsigned char*>(grown)[200 * 1024 - 1], 0x22);
+
+  // 无法满足时返回 nullptr，原内存保持不变
+  EXPECT_EQ(allocator->realloc(grown, memory_size * 2), nullptr);
+  EXPECT_EQ(static_cast<unsigned char*>(grown)[0], 0x22);
+  allocator->free(grown);
+}
+
+// 测试对齐分配没有填充，且可以使用 free 释放
+TEST_F(BmallocTest, AlignedAllocWithoutPadding) {
+  // 小请求由自然对齐的通用 cache 分配
+  void* page = allocator->aligned_alloc(4096, 4096);
+  ASSERT_NE(page, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(page) % 4096, 0);
+  EXPECT_EQ(allocator->malloc_size(page), 4096);
+  allocator->free(page);
+
+  void* small = allocator->aligned_alloc(64, 64);
+  ASSERT_NE(small, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(small) % 64, 0);
+  EXPECT_EQ(allocator->malloc_size(small), 64);
+  allocator->free(small);
+
+  // 对齐大于请求大小时分配对齐大小的块
+  void* padded = allocator->aligned_alloc(2048, 100);
+  ASSERT_NE(padded, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(padded) % 2048, 0);
+  EXPECT_EQ(allocator->malloc_size(padded), 2048);
+  allocator->free(padded);
+
+  // 大请求由 buddy 分配，块按自身大小对齐
+  void* large = allocator->aligned_alloc(4096, 256 * 1024);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % 4096, 0);
+  EXPECT_EQ(allocator->malloc_size(large), 256 * 1024);
+  allocator->free(large);
+
+  // 对齐分配的内存可以原位 realloc
+  void* resized = allocator->aligned_alloc(256, 200);
+  ASSERT_NE(resized, nullptr);
+  EXPECT_EQ(allocator->realloc(resized, 256), resized);
+  allocator->free(resized);
+}
+
+// 测试超过页大小的对齐：buddy arena 从堆起始地址开始，
+// 堆按 2 MiB 对齐时 16 KiB 与 64 KiB 对齐都能满足
+TEST(BmallocAlignedHeapTest, AlignmentAbovePageSize) {
+  constexpr size_t kHeapAlign = 2 * 1024 * 1024;
+  constexpr size_t kHeapSize = 4 * 1024 * 1024;
+  for (bool zeroed : {false, true}) {
+    void* heap = std::aligned_alloc(kHeapAlign, kHeapSize);
+    ASSERT_NE(heap, nullptr);
+    std::memset(heap, 0, kHeapSize);
+    {
+      Bmalloc<TestLogger, TestLock> allocator(heap, kHeapSize, zeroed);
+      for (size_t alignment : {size_t{16384}, size_t{65536}}) {
+        void* block = allocator.aligned_alloc(alignment, alignment);
+        ASSERT_NE(block, nullptr) << "alignment " << alignment;
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(block) % alignment, 0);
+        EXPECT_GE(allocator.malloc_size(block), alignment);
+
+        // 对齐大于请求大小时同样满足
+        void* small = allocator.aligned_alloc(alignment, 100);
+        ASSERT_NE(small, nullptr) << "alignment " << alignment;
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(small) % alignment, 0);
+
+        allocator.free(small);
+        allocator.free(block);
+      }
+    }
+    std::free(heap);
+  }
+}
+
+// 测试按大小释放：slab 与 buddy 中的内存块都归还到所属的层
+TEST_F(BmallocTest, FreeSized) {
+  void* small = allocator->malloc(100);
+  ASSERT_NE(small, nullptr);
+  allocator->free_sized(small, 100);
+  EXPECT_EQ(allocator->malloc(100), small);
+  allocator->free_sized(small, 100);
+
+  constexpr size_t kLarge = 512 * 1024;
+  void* large = allocator->malloc(kLarge);
+  ASSERT_NE(large, nullptr);
+  allocator->free_sized(large, kLarge);
+  EXPECT_EQ(allocator->malloc(kLarge), large);
+  allocator->free_sized(large, kLarge);
+
+  // 不小于一页的 calloc 由 buddy 分配，按大小释放时退回查找路径
+  void* zeroed = allocator->calloc(2, 4096);
+  ASSERT_NE(zeroed, nullptr);
+  allocator->free_sized(zeroed, 2 * 4096);
+  EXPECT_EQ(allocator->calloc(2, 4096), zeroed);
+  allocator->free_sized(zeroed, 2 * 4096);
+
+  // realloc 之后按新的大小释放
+  void* resized = allocator->malloc(100);
+  ASSERT_NE(resized, nullptr);
+  resized = allocator->realloc(resized, 1000);
+  ASSERT_NE(resized, nullptr);
+  allocator->free_sized(resized, 1000);
+  EXPECT_EQ(allocator->malloc(1000), resized);
+  allocator->free_sized(resized, 1000);
+
+  void* padded = allocator->aligned_alloc(2048, 100);
+  ASSERT_NE(padded, nullptr);
+  allocator->free_aligned_sized(padded, 2048, 100);
+  EXPECT_EQ(allocator->aligned_alloc(2048, 100), padded);
+  allocator->free_aligned_sized(padded, 2048, 100);
+
+  allocator->free_sized(nullptr, 100);
+}
+
+// 测试线程缓存：释放的对象被同一线程复用，回收后归还给 slab
+TEST(BmallocThreadCacheTest, ReuseAndRelease) {
+  constexpr size_t kBytes = 1024 * 1024 * 16;
+  void* memory = std::malloc(kBytes);
+  ASSERT_NE(memory, nullptr);
+  {
+    Bmalloc<std::nullptr_t, TestLock, ThreadLocalCache<>> cached(memory,
+                                                                  kBytes);
+
+    void* ptr = cached.malloc(64);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(cached.malloc_size(ptr), 64);
+    cached.free(ptr);
+    EXPECT_EQ(cached.malloc(64), ptr);
+    cached.free_sized(ptr, 64);
+    EXPECT_EQ(cached.malloc(64), ptr);
+
+    // 超过缓存容量时一批对象归还给 slab
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 1000; i++) {
+      ptrs.push_back(cached.malloc(100));
+      ASSERT_NE(ptrs.back(), nullptr);
+      std::memset(ptrs.back(), i & 0xFF, 100);
+    }
+    for (int i = 0; i < 1000; i++) {
+      EXPECT_EQ(static_cast<unsigned char*>(ptrs[i])[99], i & 0xFF);
+      cached.free(ptrs[i]);
+    }
+    cached.free(ptr);
+
+    // 大于 kMaxSize 的请求不经过线程缓存
+    void* large = cached.malloc(64 * 1024);
+    ASSERT_NE(large, nullptr);
+    cached.free(large);
+
+    EXPECT_GT(cached.release_thread_cache(), 0);
+    EXPECT_EQ(cached.release_thread_cache(), 0);
+  }
+  std::free(memory);
+}
+
+// 测试线程缓存的并发分配、跨线程释放与空闲缓存回收
+TEST(BmallocThreadCacheTest, ConcurrentAllocAndScavenge) {
+  constexpr size_t kBytes = 1024 * 1024 * 16;
+  constexpr int kThreads = 8;
+  constexpr int kIterations = 5000;
+  void* memory = std::malloc(kBytes);
+  ASSERT_NE(memory, nullptr);
+  {
+    Bmalloc<std::nullptr_t, TestLock, ThreadLocalCache<>> cached(memory,
+                                                                  kBytes);
+    std::vector<std::vector<void*>> leftovers(kThreads);
+    std::atomic<int> errors{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+      threads.emplace_back([&, t]() {
+        std::mt19937 rng(t);
+        std::uniform_int_distribution<size_t> size_dist(1, 4096);
+        std::vector<std::pair<void*, size_t>> live;
+        for (int i = 0; i < kIterations; i++) {
+          if (live.size() < 64 && (rng() % 3 != 0 || live.empty())) {
+            size_t size = size_dist(rng);
+            auto* ptr = static_cast<unsigned char*>(cached.malloc(size));
+            if (ptr == nullptr) {
+              errors++;
+              continue;
+            }
+            std::memset(ptr, t, size);
+            live.emplace_back(ptr, size);
+          } else {
+            auto [ptr, size] = live.back();
+            live.pop_back();
+            auto* bytes = static_cast<unsigned char*>(ptr);
+            if (bytes[0] != t || bytes[size - 1] != t) {
+              errors++;
+            }
+            cached.free(ptr);
+          }
+        }
+        // 剩余的对象交给其它线程释放
+        for (auto& [ptr, size] : live) {
+          leftovers[t].push_back(ptr);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(errors.load(), 0);
+
+    // 跨线程释放
+    for (auto& list : leftovers) {
+      for (auto* ptr : list) {
+        cached.free(ptr);
+      }
+    }
+
+    // 第一次回收清除使用标记，第二次归还已退出线程的缓存
+    cached.scavenge_thread_caches();
+    EXPECT_GT(cached.scavenge_thread_caches(), 0);
+    EXPECT_EQ(cached.scavenge_thread_caches(), 0);
+  }
+  std::free(memory);
+}
+
+extern "C" void* bmalloc_memset(void* dest, int val, size_t n);
+extern "C" void* bmalloc_memcpy(void* dest, const void* src, size_t n);
+
+// 测试按字宽实现的 memset/memcpy 在各种对齐与长度下与逐字节结果一致
+TEST(BmallocMemOpsTest, WordWideMemsetAndMemcpy) {
+  unsigned char source[256];
+  for (size_t i = 0; i < sizeof(source); i++) {
+    source[i] = static_cast<unsigned char>(i * 7 + 1);
+  }
+  for (size_t offset = 0; offset < 16; offset++) {
+    for (size_t length = 0; length < 200; length += 3) {
+      unsigned char buffer[256];
+      std::fill(std::begin(buffer), std::end(buffer), 0xEE);
+      EXPECT_EQ(bmalloc_memset(buffer + offset, 0x5A, length),
+                buffer + offset);
+      for (size_t i = 0; i < sizeof(buffer); i++) {
+        bool inside = i >= offset && i < offset + length;
+        ASSERT_EQ(buffer[i], inside ? 0x5A : 0xEE)
+            << "memset offset " << offset << " length " << length;
+      }
+
+      // 源与目标相对对齐和不对齐两种情况
+      for (size_t src_offset : {offset, (offset + 3) % 16}) {
+        std::fill(std::begin(buffer), std::end(buffer), 0xEE);
+        bmalloc_memcpy(buffer + offset, source + src_offset, length);
+        for (size_t i = 0; i < sizeof(buffer); i++) {
+          bool inside = i >= offset && i < offset + length;
+          ASSERT_EQ(buffer[i],
+                    inside ? source[src_offset + i - offset] : 0xEE)
+              << "memcpy offset " << offset << " length " << length;
+        }
+      }
+    }
+  }
+}
+
+// 测试已清零内存上的 calloc：新页直接返回，复用的页被清零
+TEST(BmallocZeroedTest, CallocReusesDirtyPages) {
+  constexpr size_t kBytes = 1024 * 1024 * 16;
+  void* memory = std::calloc(1, kBytes);
+  ASSERT_NE(memory, nullptr);
+  {
+    Bmalloc<TestLogger, TestLock> zeroed(memory, kBytes, true);
+
+    constexpr size_t kLarge = 64 * 1024;
+    void* dirty = zeroed.malloc(kLarge);
+    ASSERT_NE(dirty, nullptr);
+    std::memset(dirty, 0xFF, kLarge);
+    zeroed.free(dirty);
+
+    for (size_t size : {kPageSize, kLarge, size_t{300 * 1024}, size_t{100}}) {
+      auto* ptr = static_cast<unsigned char*>(zeroed.calloc(1, size));
+      ASSERT_NE(ptr, nullptr);
+      EXPECT_TRUE(std::all_of(ptr, ptr + size,
+                              [](unsigned char b) { return b == 0; }))
+          << size;
+      std::memset(ptr, 0xCC, size);
+      zeroed.free(ptr);
+    }
+  }
+  std::free(memory);
+}
@@ -850,3 +850,105 @@ TEST_F(BuddyTest, MultiThreadLongRunningTest) {
       static_cast<double>(allocation_errors.load()) / total_operations.load();
   EXPECT_LT(failure_rate, 0.5) << "Too many allocation failures";
 }
+
+// 调整内存块大小测试
+TEST_F(BuddyTest, ReallocTest) {
+  Buddy<TestLogger, TestLock> allocator("TestBuddy", test_memory_,
+                                        kTestMemorySize);
+
+  // 空闲的内存中，重新查找到的块从第一个块的地址开始，不移动
+  void* ptr = allocator.Alloc(kPageSize);
+  ASSERT_NE(ptr, nullptr);
+  memset(ptr, 0x3C, kPageSize);
+  void* grown = allocator.Realloc(ptr, 4 * kPageSize);
+  ASSERT_NE(grown, nullptr);
+  EXPECT_EQ(grown, ptr);
+  EXPECT_GE(allocator.AllocSize(grown), 4 * kPageSize);
+  EXPECT_EQ(static_cast<unsigned char*>(grown)[kPageSize - 1], 0x3C);
+
+  // 同一级的大小不移动；缩小时重新查找到最左侧的左半部分
+  EXPECT_EQ(allocator.Realloc(grown, 3 * kPageSize), grown);
+  void* shrunk = allocator.Realloc(grown, kPageSize);
+  ASSERT_NE(shrunk, nullptr);
+  EXPECT_EQ(shrunk, grown);
+  EXPECT_EQ(allocator.AllocSize(shrunk), kPageSize);
+  void* tail = allocator.Alloc(kPageSize);
+  ASSERT_NE(tail, nullptr);
+  EXPECT_EQ(tail, static_cast<char*>(shrunk) + kPageSize);
+
+  // 右侧的 buddy 被占用时移动并复制数据
+  void* moved = allocator.Realloc(shrunk, 2 * kPageSize);
+  ASSERT_NE(moved, nullptr);
+  EXPECT_NE(moved, shrunk);
+  EXPECT_EQ(static_cast<unsigned char*>(moved)[0], 0x3C);
+
+  // 无法满足时返回 nullptr，原内存块保持不变
+  EXPECT_EQ(allocator.Realloc(moved, kTestMemorySize * 2), nullptr);
+  EXPECT_EQ(allocator.AllocSize(moved), 2 * kPageSize);
+
+  allocator.Free(moved);
+  allocator.Free(tail);
+}
+
+// 测试原块是右侧的 buddy 且左侧空闲时，增长会移动到父块的起始地址
+TEST_F(BuddyTest, ReallocRightBuddyMoves) {
+  Buddy<TestLogger, TestLock> allocator("TestBuddy", test_memory_,
+                                        kTestMemorySize);
+
+  void* left = allocator.Alloc(kPageSize);
+  void* right = allocator.Alloc(kPageSize);
+  ASSERT_NE(left, nullptr);
+  ASSERT_NE(right, nullptr);
+  ASSERT_EQ(right, static_cast<char*>(left) + kPageSize);
+  allocator.Free(left);
+  memset(right, 0x5A, kPageSize);
+
+  // 释放后重新查找，最左侧的两页空闲块是父块，数据随之移动
+  void* grown = allocator.Realloc(right, 2 * kPageSize);
+  ASSERT_NE(grown, nullptr);
+  EXPECT_EQ(grown, left);
+  EXPECT_EQ(allocator.AllocSize(grown), 2 * kPageSize);
+  auto* bytes = static_cast<unsigned char*>(grown);
+  EXPECT_TRUE(std::all_of(bytes, bytes + kPageSize,
+                          [](unsigned char b) { return b == 0x5A; }));
+
+  allocator.Free(grown);
+}
+
+// 测试已清零内存的页位图：从未分配过的页跳过清零，分配过的页重新清零
+TEST_F(BuddyTest, AllocZeroedTracksDirtyPages) {
+  Buddy<TestLogger, TestLock> allocator("TestBuddy", test_memory_,
+                                        kTestMemorySize, true);
+
+  void* first = allocator.AllocZeroed(kPageSize);
+  ASSERT_NE(first, nullptr);
+  auto* bytes = static_cast<unsigned char*>(first);
+  EXPECT_TRUE(std::all_of(bytes, bytes + kPageSize,
+                          [](unsigned char b) { return b == 0; }));
+
+  // 向尚未分配的下一页写入标记：该页被视为从未分配过，不会清零
+  std::memset(bytes + kPageSize, 0x11, kPageSize);
+  void* second = allocator.AllocZeroed(kPageSize);
+  ASSERT_EQ(second, bytes + kPageSize);
+  EXPECT_EQ(static_cast<unsigned char*>(second)[0], 0x11);
+  allocator.Free(second);
+
+  // 分配过的页释放后再次分配需要清零
+  std::memset(first, 0xFF, kPageSize);
+  allocator.Free(first);
+  void* reused = allocator.AllocZeroed(kPageSize);
+  ASSERT_EQ(reused, first);
+  EXPECT_TRUE(std::all_of(bytes, bytes + kPageSize,
+                          [](unsigned char b) { return b == 0; }));
+  allocator.Free(reused);
+
+  // 普通分配同样标记页，未启用页位图时总是清零
+  void* plain = allocator.Alloc(kPageSize);
+  ASSERT_NE(plain, nullptr);
+  std::memset(plain, 0x22, kPageSize);
+  allocator.Free(plain);
+  void* zeroed = allocator.AllocZeroed(kPageSize);
+  ASSERT_EQ(zeroed, plain);
+  EXPECT_EQ(static_cast<unsigned char*>(zeroed)[kPageSize - 1], 0);
+  allocator.Free(zeroed);
+}
@@ -0,0 +1,277 @@
+/**
+ * Copyright The bmalloc Contributors
+ * @file bump_test.cpp
+ * @brief BumpAllocator与ChainedArena的Google Test测试用例
+ */
+
+#include "bump.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "buddy.hpp"
+
+using namespace bmalloc;
+
+namespace {
+
+// 日志函数类型
+struct TestLogger {
+  int operator()(const char* format, ...) const {
+    va_list args;
+    va_start(args, format);
+    int result = vprintf(format, args);
+    va_end(args);
+    return result;
+  }
+};
+
+// 测试用的锁实现
+class TestLock : public LockBase {
+ private:
+  std::mutex mutex_;
+
+ public:
+  void Lock() override { mutex_.lock(); }
+
+  void Unlock() override { mutex_.unlock(); }
+};
+
+// 测试夹具
+class BumpTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kTestMemorySize = kPageSize * 64;
+
+  void SetUp() override {
+    test_memory_ = std::aligned_alloc(kPageSize, kTestMemorySize);
+    ASSERT_NE(test_memory_, nullptr) << "Failed to allocate test memory";
+  }
+
+  void TearDown() override { std::free(test_memory_); }
+
+  void* test_memory_ = nullptr;
+};
+
+}  // namespace
+
+// 测试线性分配、对齐、耗尽与 Reset
+TEST_F(BumpTest, AllocAndReset) {
+  BumpAllocator<TestLogger, TestLock> bump("bump", test_memory_,
+                                           kTestMemorySize);
+
+  void* first = bump.Alloc(1);
+  void* second = bump.Alloc(100);
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % alignof(max_align_t), 0);
+  EXPECT_EQ(static_cast<char*>(second) - static_cast<char*>(first),
+            alignof(max_align_t));
+  EXPECT_EQ(bump.Alloc(0), nullptr);
+  EXPECT_EQ(bump.Alloc(kTestMemorySize), nullptr);
+  EXPECT_GT(bump.GetUsedCount(), 100);
+
+  bump.Reset();
+  EXPECT_EQ(bump.GetUsedCount(), 0);
+  EXPECT_EQ(bump.GetFreeCount(), kTestMemorySize);
+  EXPECT_EQ(bump.Alloc(1), first);
+}
+
+// 通过 AllocatorBase 接口读取的统计与当前分配位置一致
+TEST_F(BumpTest, StatsThroughBase) {
+  BumpAllocator<TestLogger, TestLock> bump("bump", test_memory_,
+                                           kTestMemorySize);
+  AllocatorBase<TestLogger, TestLock>& base = bump;
+
+  ASSERT_NE(bump.Alloc(100), nullptr);
+  EXPECT_EQ(base.GetUsedCount(), bump.GetUsedCount());
+  EXPECT_GE(base.GetUsedCount(), 100);
+  EXPECT_EQ(base.GetFreeCount(), kTestMemorySize - base.GetUsedCount());
+  auto stats = base.GetStats();
+  EXPECT_EQ(stats.used_, base.GetUsedCount());
+  EXPECT_EQ(stats.free_, base.GetFreeCount());
+  EXPECT_GE(stats.peak_used_, stats.used_);
+
+  bump.Reset();
+  EXPECT_EQ(base.GetUsedCount(), 0);
+  EXPECT_EQ(base.GetFreeCount(), kTestMemorySize);
+}
+
+// 移动构造保留分配位置
+TEST_F(BumpTest, MoveConstruct) {
+  BumpAllocator<> bump("bump", test_memory_, kTestMemorySize);
+  ASSERT_NE(bump.Alloc(100), nullptr);
+  size_t used = bump.GetUsedCount();
+  BumpAllocator<> moved(std::move(bump));
+  AllocatorBase<std::nullptr_t, LockBase>& base = moved;
+  EXPECT_EQ(base.GetUsedCount(), used);
+  EXPECT_EQ(base.GetFreeCount(), kTestMemorySize - used);
+  EXPECT_NE(moved.Alloc(1), nullptr);
+  moved.Reset();
+  EXPECT_EQ(base.GetUsedCount(), 0);
+  EXPECT_EQ(base.GetFreeCount(), kTestMemorySize);
+}
+
+// 测试并发分配不加锁且返回的内存互不重叠
+TEST_F(BumpTest, ConcurrentAlloc) {
+  constexpr int kThreads = 4;
+  constexpr int kPerThread = 500;
+  constexpr size_t kSize = 64;
+  BumpAllocator<TestLogger, TestLock> bump("bump", test_memory_,
+                                           kTestMemorySize);
+
+  std::vector<std::vector<void*>> results(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kPerThread; i++) {
+        void* ptr = bump.Alloc(kSize);
+        if (ptr != nullptr) {
+          std::memset(ptr, t, kSize);
+          results[t].push_back(ptr);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<uintptr_t> all;
+  for (int t = 0; t < kThreads; t++) {
+    ASSERT_EQ(results[t].size(), kPerThread);
+    for (void* ptr : results[t]) {
+      EXPECT_EQ(*static_cast<unsigned char*>(ptr), t);
+      all.push_back(reinterpret_cast<uintptr_t>(ptr));
+    }
+  }
+  std::sort(all.begin(), all.end());
+  for (size_t i = 1; i < all.size(); i++) {
+    EXPECT_GE(all[i] - all[i - 1], kSize);
+  }
+  EXPECT_EQ(bump.GetUsedCount(), kThreads * kPerThread * kSize);
+}
+
+// 测试 Mark/Rewind 与嵌套的 ScopedArena
+TEST_F(BumpTest, CheckpointsAndScopes) {
+  BumpAllocator<TestLogger, TestLock> bump("bump", test_memory_,
+                                           kTestMemorySize);
+  void* base = bump.Alloc(64);
+  ASSERT_NE(base, nullptr);
+
+  auto mark = bump.Mark();
+  void* temp = bump.Alloc(1024);
+  ASSERT_NE(temp, nullptr);
+  bump.Rewind(mark);
+  EXPECT_EQ(bump.Alloc(1024), temp);
+  bump.Rewind(mark);
+
+  size_t used = bump.GetUsedCount();
+  {
+    ScopedArena outer(bump);
+    void* a = outer.Alloc(128);
+    ASSERT_NE(a, nullptr);
+    {
+      ScopedArena inner(bump);
+      ASSERT_NE(inner.Alloc(4096), nullptr);
+    }
+    // 内层作用域的内存已回收，外层的分配保持不变
+    EXPECT_EQ(bump.GetUsedCount(), used + 128);
+  }
+  EXPECT_EQ(bump.GetUsedCount(), used);
+}
+
+// 测试链式 arena：当前块用尽时从 Buddy 获取新块，回退时归还
+TEST_F(BumpTest, ChainedArenaFromBuddy) {
+  Buddy<TestLogger, TestLock> buddy("parent", test_memory_, kTestMemorySize);
+  constexpr size_t kChunk = kPageSize * 2;
+  void* probe = buddy.Alloc(kChunk);
+  ASSERT_NE(probe, nullptr);
+  buddy.Free(probe);
+
+  {
+    ChainedArena<Buddy<TestLogger, TestLock>, TestLogger, TestLock> arena(
+        "chained", buddy, kChunk);
+    EXPECT_EQ(arena.GetChunkCount(), 0);
+
+    void* first = arena.Alloc(1024);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(arena.GetChunkCount(), 1);
+    EXPECT_GT(first, probe);
+    EXPECT_LT(first, static_cast<char*>(probe) + kChunk);
+
+    auto mark = arena.Mark();
+    // 填满第一个块后换块
+    for (int i = 0; i < 16; i++) {
+      ASSERT_NE(arena.Alloc(1024), nullptr);
+    }
+    EXPECT_GE(arena.GetChunkCount(), 2);
+
+    // 超过块大小的请求获取一个足够大的块
+    void* large = arena.Alloc(kChunk * 3);
+    ASSERT_NE(large, nullptr);
+    std::memset(large, 0x7E, kChunk * 3);
+    size_t chunks = arena.GetChunkCount();
+
+    // 回退后多余的块归还给 Buddy，第一个块继续从 mark 处分配
+    arena.Rewind(mark);
+    EXPECT_EQ(arena.GetChunkCount(), 1);
+    EXPECT_LT(arena.GetChunkCount(), chunks);
+    EXPECT_EQ(arena.Alloc(16), static_cast<char*>(first) + 1024);
+
+    {
+      ScopedArena scope(arena);
+      ASSERT_NE(scope.Alloc(kChunk * 2), nullptr);
+      EXPECT_EQ(arena.GetChunkCount(), 2);
+    }
+    EXPECT_EQ(arena.GetChunkCount(), 1);
+
+    arena.Reset();
+    EXPECT_EQ(arena.GetChunkCount(), 0);
+    ASSERT_NE(arena.Alloc(64), nullptr);
+  }
+
+  // 析构后所有块都已归还，可以重新分配整个区域的大块
+  void* again = buddy.Alloc(kChunk);
+  EXPECT_EQ(again, probe);
+  buddy.Free(again);
+}
+
+// 测试多个线程并发换块
+TEST_F(BumpTest, ChainedArenaConcurrent) {
+  Buddy<TestLogger, TestLock> buddy("parent", test_memory_, kTestMemorySize);
+  ChainedArena<Buddy<TestLogger, TestLock>, TestLogger, TestLock> arena(
+      "chained", buddy, kPageSize);
+
+  constexpr int kThreads = 4;
+  constexpr int kPerThread = 200;
+  std::vector<std::vector<void*>> results(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kPerThread; i++) {
+        void* ptr = arena.Alloc(48);
+        if (ptr != nullptr) {
+          std::memset(ptr, t + 1, 48);
+          results[t].push_back(ptr);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int t = 0; t < kThreads; t++) {
+    ASSERT_EQ(results[t].size(), kPerThread);
+    for (void* ptr : results[t]) {
+      EXPECT_EQ(static_cast<unsigned char*>(ptr)[47], t + 1);
+    }
+  }
+  EXPECT_GT(arena.GetChunkCount(), 1);
+}
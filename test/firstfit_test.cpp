@@ -939,3 +939,336 @@ TEST_F(FirstFitTest, MultiThreadDeadlockTest) {
   EXPECT_LT(duration.count(), 2000)
       << "Test took too long, possible deadlock";  // 2秒超时
 }
+
+// 跨越位图字边界的连续页分配测试
+TEST_F(FirstFitTest, WordBoundaryRunTest) {
+  constexpr size_t kPages = 200;
+  void* memory = aligned_alloc(kPageSize, kPages * kPageSize);
+  ASSERT_NE(memory, nullptr);
+  {
+    FirstFit<TestLogger> allocator("test_firstfit", memory, kPages);
+    auto page = [&](void* ptr) {
+      return static_cast<size_t>(static_cast<char*>(ptr) -
+                                 static_cast<char*>(memory)) /
+             kPageSize;
+    };
+
+    // 占用 [0, 60)，剩余的第一个字只有 4 页空闲
+    void* head = allocator.Alloc(60);
+    ASSERT_NE(head, nullptr);
+    EXPECT_EQ(page(head), 0);
+
+    // 10 页的连续段从第 60 页开始，跨越第一个字边界
+    void* cross = allocator.Alloc(10);
+    ASSERT_NE(cross, nullptr);
+    EXPECT_EQ(page(cross), 60);
+
+    // 字内部的空洞：释放 [10, 15) 后 5 页的请求应复用它
+    allocator.Free(static_cast<char*>(head) + 10 * kPageSize, 5);
+    void* hole = allocator.Alloc(5);
+    ASSERT_NE(hole, nullptr);
+    EXPECT_EQ(page(hole), 10);
+
+    // 跨越多个字的大请求
+    void* large = allocator.Alloc(130);
+    ASSERT_NE(large, nullptr);
+    EXPECT_EQ(page(large), 70);
+
+    // 末尾不足一个字的部分页可以被完整使用，超出部分不可用
+    EXPECT_EQ(allocator.GetFreeCount(), 0);
+    EXPECT_EQ(allocator.Alloc(1), nullptr);
+
+    allocator.Free(large, 130);
+    allocator.Free(cross, 10);
+    allocator.Free(head, 60);
+    EXPECT_EQ(allocator.GetUsedCount(), 0);
+    EXPECT_EQ(allocator.GetFreeCount(), kPages);
+    void* all = allocator.Alloc(kPages);
+    EXPECT_EQ(all, memory);
+    allocator.Free(all, kPages);
+  }
+  free(memory);
+}
+
+// 超过 1024 页的大内存区域测试
+TEST_F(FirstFitTest, LargeRegionTest) {
+  constexpr size_t kPages = 64 * 1024;  // 256MB 的地址范围
+  void* memory = aligned_alloc(kPageSize, kPages * kPageSize);
+  ASSERT_NE(memory, nullptr);
+
+  // 1. 位图位于管理内存的末尾，占用的页不计入空闲页数
+  {
+    FirstFit<TestLogger> allocator("test_firstfit", memory, kPages);
+    size_t bitmap_pages =
+        (FirstFit<TestLogger>::BitmapWords(kPages) * sizeof(uint64_t) +
+         kPageSize - 1) /
+        kPageSize;
+    EXPECT_EQ(allocator.GetFreeCount(), kPages - bitmap_pages);
+
+    // 填满前半部分后仍能快速找到后面的空闲页
+    std::vector<void*> ptrs;
+    for (size_t i = 0; i < kPages / 2 / 64; ++i) {
+      void* ptr = allocator.Alloc(64);
+      ASSERT_NE(ptr, nullptr);
+      ptrs.push_back(ptr);
+    }
+    void* tail = allocator.Alloc(3);
+    ASSERT_NE(tail, nullptr);
+    EXPECT_EQ(tail, static_cast<char*>(memory) + kPages / 2 * kPageSize);
+
+    // 释放中间的一块后，从头开始的查找应复用它
+    allocator.Free(ptrs[100], 64);
+    EXPECT_EQ(allocator.Alloc(33), ptrs[100]);
+
+    // 剩余的页可以一次分配完，位图所在的页不会被分配
+    size_t left = allocator.GetFreeCount();
+    EXPECT_EQ(allocator.Alloc(left + 1), nullptr);
+    void* rest = allocator.Alloc(31);
+    ASSERT_NE(rest, nullptr);
+    void* last = allocator.Alloc(allocator.GetFreeCount());
+    ASSERT_NE(last, nullptr);
+    EXPECT_EQ(allocator.GetFreeCount(), 0);
+  }
+
+  // 2. 位图位于调用者提供的缓冲区，所有页都可分配
+  {
+    std::vector<uint64_t> bitmap(FirstFit<TestLogger>::BitmapWords(kPages));
+    FirstFit<TestLogger> allocator("test_firstfit", memory, kPages,
+                                   bitmap.data());
+    EXPECT_EQ(allocator.GetFreeCount(), kPages);
+    void* all = allocator.Alloc(kPages);
+    EXPECT_EQ(all, memory);
+    allocator.Free(all, kPages);
+    EXPECT_EQ(allocator.GetFreeCount(), kPages);
+  }
+  free(memory);
+}
+
+// 循环首次适应策略测试
+TEST_F(FirstFitTest, NextFitPolicyTest) {
+  FirstFit<TestLogger, LockBase, NextFitSearch> allocator(
+      "test_nextfit", test_memory_, kTestPages);
+  auto page = [&](void* ptr) {
+    return static_cast<size_t>(static_cast<char*>(ptr) -
+                               static_cast<char*>(test_memory_)) /
+           kPageSize;
+  };
+
+  void* a = allocator.Alloc(2);
+  void* b = allocator.Alloc(2);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(page(a), 0);
+  EXPECT_EQ(page(b), 2);
+
+  // 释放 a 后不会回到开头，而是从上次分配结束的位置继续
+  allocator.Free(a, 2);
+  void* c = allocator.Alloc(2);
+  ASSERT_NE(c, nullptr);
+  EXPECT_EQ(page(c), 4);
+
+  // 到达末尾后回绕到开头的空洞
+  void* tail = allocator.Alloc(kTestPages - 6);
+  ASSERT_NE(tail, nullptr);
+  EXPECT_EQ(page(tail), 6);
+  void* wrapped = allocator.Alloc(2);
+  ASSERT_NE(wrapped, nullptr);
+  EXPECT_EQ(page(wrapped), 0);
+  EXPECT_EQ(allocator.Alloc(1), nullptr);
+
+  allocator.Free(wrapped, 2);
+  allocator.Free(b, 2);
+  allocator.Free(c, 2);
+  allocator.Free(tail, kTestPages - 6);
+  EXPECT_EQ(allocator.GetFreeCount(), kTestPages);
+}
+
+// 最佳适应策略测试
+TEST_F(FirstFitTest, BestFitPolicyTest) {
+  FirstFit<TestLogger, LockBase, BestFitSearch> allocator(
+      "test_bestfit", test_memory_, kTestPages);
+  auto page = [&](void* ptr) {
+    return static_cast<size_t>(static_cast<char*>(ptr) -
+                               static_cast<char*>(test_memory_)) /
+           kPageSize;
+  };
+
+  // 布局：[0,5) 空洞 | [5,6) 已用 | [6,8) 空洞 | [8,16) 已用
+  void* big_hole = allocator.Alloc(5);
+  void* sep1 = allocator.Alloc(1);
+  void* small_hole = allocator.Alloc(2);
+  void* rest = allocator.Alloc(kTestPages - 8);
+  ASSERT_NE(rest, nullptr);
+  allocator.Free(big_hole, 5);
+  allocator.Free(small_hole, 2);
+
+  // 2 页的请求选择恰好合适的空洞，而不是第一个空洞
+  void* fit = allocator.Alloc(2);
+  ASSERT_NE(fit, nullptr);
+  EXPECT_EQ(page(fit), 6);
+
+  // 3 页的请求只能使用 5 页的空洞，剩余 2 页仍可分配
+  void* three = allocator.Alloc(3);
+  ASSERT_NE(three, nullptr);
+  EXPECT_EQ(page(three), 0);
+  void* two = allocator.Alloc(2);
+  ASSERT_NE(two, nullptr);
+  EXPECT_EQ(page(two), 3);
+  EXPECT_EQ(allocator.Alloc(1), nullptr);
+
+  // 释放后相邻空闲区间合并，可以再次分配全部页面
+  allocator.Free(three, 3);
+  allocator.Free(fit, 2);
+  allocator.Free(sep1, 1);
+  allocator.Free(two, 2);
+  allocator.Free(rest, kTestPages - 8);
+  void* all = allocator.Alloc(kTestPages);
+  EXPECT_EQ(all, test_memory_);
+  allocator.Free(all, kTestPages);
+  EXPECT_EQ(allocator.GetFreeCount(), kTestPages);
+}
+
+// 随机分配释放，验证各策略的分配结果不重叠且释放后可以完全合并
+template <class Policy>
+static void RandomPolicyCheck(void* memory, size_t pages) {
+  FirstFit<std::nullptr_t, LockBase, Policy> allocator("test_policy", memory,
+                                                       pages);
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> size_dist(1, 16);
+  std::vector<std::pair<void*, size_t>> live;
+  std::vector<bool> used(pages, false);
+
+  for (int i = 0; i < 5000; ++i) {
+    if (live.empty() || gen() % 3 != 0) {
+      size_t count = size_dist(gen);
+      void* ptr = allocator.Alloc(count);
+      if (ptr == nullptr) {
+        continue;
+      }
+      size_t first = static_cast<size_t>(static_cast<char*>(ptr) -
+                                         static_cast<char*>(memory)) /
+                     kPageSize;
+      ASSERT_LE(first + count, pages);
+      for (size_t p = first; p < first + count; ++p) {
+        ASSERT_FALSE(used[p]) << "page " << p << " allocated twice";
+        used[p] = true;
+      }
+      live.emplace_back(ptr, count);
+    } else {
+      size_t victim = gen() % live.size();
+      auto [ptr, count] = live[victim];
+      size_t first = static_cast<size_t>(static_cast<char*>(ptr) -
+                                         static_cast<char*>(memory)) /
+                     kPageSize;
+      for (size_t p = first; p < first + count; ++p) {
+        used[p] = false;
+      }
+      allocator.Free(ptr, count);
+      live[victim] = live.back();
+      live.pop_back();
+    }
+  }
+
+  for (auto [ptr, count] : live) {
+    allocator.Free(ptr, count);
+  }
+  EXPECT_EQ(allocator.GetUsedCount(), 0);
+  void* all = allocator.Alloc(pages);
+  EXPECT_EQ(all, memory);
+  allocator.Free(all, pages);
+}
+
+TEST_F(FirstFitTest, RandomPolicyConsistencyTest) {
+  constexpr size_t kPages = 512;
+  void* memory = aligned_alloc(kPageSize, kPages * kPageSize);
+  ASSERT_NE(memory, nullptr);
+  RandomPolicyCheck<FirstFitSearch>(memory, kPages);
+  RandomPolicyCheck<NextFitSearch>(memory, kPages);
+  RandomPolicyCheck<BestFitSearch>(memory, kPages);
+  free(memory);
+}
+
+// 在前半部分被单页分配碎片化的区域中，各搜索策略分配的块都位于空闲页上
+// （延迟对比见 bmalloc_bench 的 SearchPolicy/ 基准）
+template <class Policy>
+static void FragmentedPolicyCheck(void* memory, size_t pages,
+                                  size_t pinned_every) {
+  FirstFit<std::nullptr_t, LockBase, Policy> allocator("policy_fragmented",
+                                                       memory, pages);
+  std::vector<void*> pinned;
+  for (size_t i = 0; i < pages / 2; ++i) {
+    pinned.push_back(allocator.Alloc(1));
+    ASSERT_NE(pinned.back(), nullptr);
+  }
+  std::set<void*> kept;
+  for (size_t i = 0; i < pinned.size(); ++i) {
+    if (i % pinned_every != 0) {
+      allocator.Free(pinned[i], 1);
+    } else {
+      kept.insert(pinned[i]);
+    }
+  }
+
+  auto begin = reinterpret_cast<uintptr_t>(memory);
+  std::vector<void*> runs;
+  for (size_t i = 0; i < 32; ++i) {
+    void* ptr = allocator.Alloc(4);
+    ASSERT_NE(ptr, nullptr);
+    auto addr = reinterpret_cast<uintptr_t>(ptr);
+    EXPECT_EQ((addr - begin) % kPageSize, 0);
+    EXPECT_LE(addr + 4 * kPageSize, begin + pages * kPageSize);
+    for (size_t page = 0; page < 4; ++page) {
+      EXPECT_EQ(kept.count(reinterpret_cast<void*>(addr + page * kPageSize)),
+                0);
+    }
+    runs.push_back(ptr);
+  }
+  for (auto* ptr : runs) {
+    allocator.Free(ptr, 4);
+  }
+  for (auto* ptr : kept) {
+    allocator.Free(ptr, 1);
+  }
+  EXPECT_EQ(allocator.GetUsedCount(), 0);
+}
+
+TEST_F(FirstFitTest, SearchPolicyFragmentedTest) {
+  constexpr size_t kPages = 1024;
+  void* memory = aligned_alloc(kPageSize, kPages * kPageSize);
+  ASSERT_NE(memory, nullptr);
+  for (size_t pinned_every : {size_t{8}, size_t{2}}) {
+    FragmentedPolicyCheck<FirstFitSearch>(memory, kPages, pinned_every);
+    FragmentedPolicyCheck<NextFitSearch>(memory, kPages, pinned_every);
+    FragmentedPolicyCheck<BestFitSearch>(memory, kPages, pinned_every);
+  }
+  free(memory);
+}
+
+// 测试按目标设置对象内部位图的页数
+TEST_F(FirstFitTest, InlinePagesConfigTest) {
+  using SmallFirstFit = FirstFit<TestLogger, LockBase, FirstFitSearch, 64>;
+  static_assert(sizeof(SmallFirstFit) < sizeof(FirstFit<TestLogger>));
+
+  constexpr size_t kPages = 128;
+  void* memory = aligned_alloc(kPageSize, kPages * kPageSize);
+  ASSERT_NE(memory, nullptr);
+  {
+    // 不超过 64 页时位图位于对象内部，所有页都可分配
+    SmallFirstFit allocator("small_firstfit", memory, 64);
+    EXPECT_EQ(allocator.GetFreeCount(), 64);
+    void* all = allocator.Alloc(64);
+    EXPECT_EQ(all, memory);
+    allocator.Free(all, 64);
+  }
+  {
+    // 超过 64 页时位图占用管理内存末尾的一页
+    SmallFirstFit allocator("small_firstfit", memory, kPages);
+    EXPECT_EQ(allocator.GetFreeCount(), kPages - 1);
+    void* all = allocator.Alloc(kPages - 1);
+    EXPECT_EQ(all, memory);
+    EXPECT_EQ(allocator.Alloc(1), nullptr);
+    allocator.Free(all, kPages - 1);
+    EXPECT_EQ(allocator.GetUsedCount(), 0);
+  }
+  free(memory);
+}
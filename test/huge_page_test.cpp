@@ -0,0 +1,286 @@
+/**
+ * Copyright The bmalloc Contributors
+ * @file huge_page_test.cpp
+ * @brief 大页感知页分配器的Google Test测试用例
+ */
+
+#include "huge_page.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "bmalloc.hpp"
+#include "lock.hpp"
+#include "slab.hpp"
+
+using namespace bmalloc;
+
+namespace {
+
+using DenseAllocator = HugePageAllocator<std::nullptr_t, SpinLock<>>;
+using AddressOrderAllocator =
+    HugePageAllocator<std::nullptr_t, SpinLock<>, AddressOrderPacking>;
+
+constexpr size_t kHuge = DenseAllocator::kHugePageSize;
+constexpr size_t kPages = DenseAllocator::kPagesPerExtent;
+
+auto IsAligned(const void* ptr, size_t align) -> bool {
+  return (reinterpret_cast<uintptr_t>(ptr) & (align - 1)) == 0;
+}
+
+// 测试夹具
+class HugePageTest : public ::testing::Test {
+ protected:
+  // 元数据占用第一个大页之前的内存，剩余 7 个大页
+  static constexpr size_t kTestMemorySize = kHuge * 8;
+
+  void SetUp() override {
+    test_memory_ = std::aligned_alloc(kHuge, kTestMemorySize);
+    ASSERT_NE(test_memory_, nullptr) << "Failed to allocate test memory";
+  }
+
+  void TearDown() override { std::free(test_memory_); }
+
+  // 分配 count 个单页
+  template <class Allocator>
+  static auto AllocPages(Allocator& allocator, size_t count)
+      -> std::vector<void*> {
+    std::vector<void*> ptrs;
+    for (size_t i = 0; i < count; i++) {
+      ptrs.push_back(allocator.Alloc(kPageSize));
+    }
+    return ptrs;
+  }
+
+  // 内存块所在的大页下标
+  static auto ExtentOf(const DenseAllocator& allocator, const void* ptr)
+      -> size_t {
+    return (reinterpret_cast<uintptr_t>(ptr) -
+            reinterpret_cast<uintptr_t>(allocator.GetExtentBase())) /
+           kHuge;
+  }
+
+  void* test_memory_ = nullptr;
+};
+
+}  // namespace
+
+// 测试大页按边界对齐，整页分配从高地址取连续的大页
+TEST_F(HugePageTest, ExtentLayout) {
+  DenseAllocator allocator("huge", test_memory_, kTestMemorySize);
+  EXPECT_EQ(allocator.GetExtentCount(), 7);
+  EXPECT_EQ(allocator.GetFreeExtentCount(), 7);
+  EXPECT_TRUE(IsAligned(allocator.GetExtentBase(), kHuge));
+  EXPECT_EQ(allocator.GetStats().free_, 7 * kHuge);
+
+  void* one = allocator.Alloc(kHuge);
+  ASSERT_NE(one, nullptr);
+  EXPECT_TRUE(IsAligned(one, kHuge));
+  EXPECT_EQ(ExtentOf(allocator, one), 6);
+  EXPECT_EQ(allocator.AllocSize(one), kHuge);
+
+  void* two = allocator.Alloc(kHuge + kPageSize);
+  ASSERT_NE(two, nullptr);
+  EXPECT_TRUE(IsAligned(two, kHuge));
+  EXPECT_EQ(ExtentOf(allocator, two), 4);
+  EXPECT_EQ(allocator.AllocSize(two), 2 * kHuge);
+  EXPECT_EQ(allocator.GetFreeExtentCount(), 4);
+  EXPECT_EQ(allocator.GetStats().used_, 3 * kHuge);
+
+  // 整页分配的大小不变时原位返回
+  EXPECT_EQ(allocator.Realloc(two, 2 * kHuge), two);
+  EXPECT_EQ(allocator.Realloc(two, 3 * kHuge), nullptr);
+
+  // 剩余的空大页不足时失败
+  EXPECT_EQ(allocator.Alloc(5 * kHuge), nullptr);
+  allocator.Free(one);
+  allocator.Free(two);
+  EXPECT_EQ(allocator.GetFreeExtentCount(), 7);
+  EXPECT_EQ(allocator.GetStats().used_, 0);
+  EXPECT_NE(allocator.Alloc(7 * kHuge), nullptr);
+
+  // 元数据放不下任何大页时不管理内存
+  DenseAllocator tiny("tiny", test_memory_, kHuge);
+  EXPECT_EQ(tiny.GetExtentCount(), 0);
+  EXPECT_EQ(tiny.Alloc(kPageSize), nullptr);
+}
+
+// 测试大页内的内存块自然对齐，原位调整大小与按块释放
+TEST_F(HugePageTest, PagesWithinExtent) {
+  DenseAllocator allocator("huge", test_memory_, kTestMemorySize);
+
+  void* single = allocator.Alloc(100);
+  void* three = allocator.Alloc(kPageSize * 3);
+  ASSERT_NE(single, nullptr);
+  ASSERT_NE(three, nullptr);
+  EXPECT_EQ(ExtentOf(allocator, single), ExtentOf(allocator, three));
+  EXPECT_TRUE(IsAligned(three, kPageSize * 4));
+  EXPECT_EQ(allocator.AllocSize(single), kPageSize);
+  EXPECT_EQ(allocator.AllocSize(three), kPageSize * 3);
+  EXPECT_EQ(allocator.GetFreeExtentCount(), 6);
+
+  // 不是内存块起始地址时不释放
+  allocator.Free(static_cast<char*>(three) + kPageSize);
+  EXPECT_EQ(allocator.AllocSize(three), kPageSize * 3);
+  EXPECT_EQ(allocator.AllocSize(static_cast<char*>(three) + kPageSize), 0);
+
+  // 对齐留下的第 4 页空闲，可以原位增长，再缩小
+  EXPECT_EQ(allocator.Realloc(three, kPageSize * 4), three);
+  EXPECT_EQ(allocator.AllocSize(three), kPageSize * 4);
+  EXPECT_EQ(allocator.Realloc(three, kPageSize * 2), three);
+  EXPECT_EQ(allocator.AllocSize(three), kPageSize * 2);
+  // 之后的页已被使用时无法原位增长
+  EXPECT_EQ(allocator.Realloc(single, kPageSize * 3), single);
+  EXPECT_EQ(allocator.Realloc(single, kPageSize * 5), nullptr);
+  EXPECT_EQ(allocator.GetStats().used_, kPageSize * 5);
+
+  allocator.Free(single);
+  allocator.Free(three);
+  EXPECT_EQ(allocator.GetFreeExtentCount(), 7);
+  EXPECT_EQ(allocator.GetStats().used_, 0);
+}
+
+// 测试小对象与中等大小的请求使用不同的共享大页
+TEST_F(HugePageTest, SeparateClasses) {
+  DenseAllocator allocator("huge", test_memory_, kTestMemorySize);
+
+  void* small = allocator.Alloc(kPageSize);
+  void* medium = allocator.Alloc(kPageSize * 64);
+  void* small2 = allocator.Alloc(kPageSize * 2);
+  ASSERT_NE(small, nullptr);
+  ASSERT_NE(medium, nullptr);
+  ASSERT_NE(small2, nullptr);
+  EXPECT_TRUE(IsAligned(medium, kPageSize * 64));
+  EXPECT_NE(ExtentOf(allocator, small), ExtentOf(allocator, medium));
+  EXPECT_EQ(ExtentOf(allocator, small), ExtentOf(allocator, small2));
+
+  // 中等缓冲区释放后其大页重新变为空的大页
+  allocator.Free(medium);
+  EXPECT_EQ(allocator.GetFreeExtentCount(), 6);
+
+  // 按地址打包时所有请求共享同一个大页
+  AddressOrderAllocator address("address", test_memory_, kTestMemorySize);
+  void* a = address.Alloc(kPageSize);
+  void* b = address.Alloc(kPageSize * 64);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(a) / kHuge,
+            reinterpret_cast<uintptr_t>(b) / kHuge);
+}
+
+// 测试新的小对象优先放入最满的大页，存活对象很少的大页最终完全释放
+TEST_F(HugePageTest, PackFullestFirst) {
+  DenseAllocator allocator("huge", test_memory_, kTestMemorySize);
+
+  // 占满两个大页后，第一个大页只留一个存活对象，第二个保留一半
+  auto ptrs = AllocPages(allocator, kPages * 2);
+  ASSERT_EQ(ExtentOf(allocator, ptrs.front()), 0);
+  ASSERT_EQ(ExtentOf(allocator, ptrs.back()), 1);
+  void* survivor = ptrs[0];
+  for (size_t i = 1; i < kPages; i++) {
+    allocator.Free(ptrs[i]);
+  }
+  for (size_t i = kPages; i < kPages + kPages / 2; i++) {
+    allocator.Free(ptrs[i]);
+  }
+
+  // 短生命周期的小对象都放入第二个大页
+  auto churn = AllocPages(allocator, kPages / 4);
+  for (auto* ptr : churn) {
+    EXPECT_EQ(ExtentOf(allocator, ptr), 1);
+  }
+  for (auto* ptr : churn) {
+    allocator.Free(ptr);
+  }
+  allocator.Free(survivor);
+  EXPECT_EQ(allocator.GetFreeExtentCount(), 6);
+  for (size_t i = kPages + kPages / 2; i < kPages * 2; i++) {
+    allocator.Free(ptrs[i]);
+  }
+  EXPECT_EQ(allocator.GetFreeExtentCount(), 7);
+
+  // 按地址打包时同样的请求落在只有一个存活对象的大页中
+  AddressOrderAllocator address("address", test_memory_, kTestMemorySize);
+  auto pages = AllocPages(address, kPages * 2);
+  for (size_t i = 1; i < kPages + kPages / 2; i++) {
+    address.Free(pages[i]);
+  }
+  void* ptr = address.Alloc(kPageSize);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) / kHuge,
+            reinterpret_cast<uintptr_t>(pages[0]) / kHuge);
+}
+
+// 测试已清零的内存从未分配过的页不再清零
+TEST_F(HugePageTest, AllocZeroed) {
+  std::memset(test_memory_, 0, kTestMemorySize);
+  DenseAllocator allocator("huge", test_memory_, kTestMemorySize, true);
+
+  auto* ptr = static_cast<unsigned char*>(allocator.AllocZeroed(kPageSize));
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(ptr[0], 0);
+  std::memset(ptr, 0xAB, kPageSize);
+  allocator.Free(ptr);
+
+  // 重新分配到同一页时清零
+  auto* again = static_cast<unsigned char*>(allocator.AllocZeroed(kPageSize));
+  ASSERT_EQ(again, ptr);
+  for (size_t i = 0; i < kPageSize; i++) {
+    ASSERT_EQ(again[i], 0);
+  }
+
+  auto* whole = static_cast<unsigned char*>(allocator.AllocZeroed(kHuge));
+  ASSERT_NE(whole, nullptr);
+  std::memset(whole, 0xCD, kHuge);
+  allocator.Free(whole);
+  whole = static_cast<unsigned char*>(allocator.AllocZeroed(kHuge));
+  ASSERT_NE(whole, nullptr);
+  EXPECT_EQ(whole[0], 0);
+  EXPECT_EQ(whole[kHuge - 1], 0);
+  allocator.Free(whole);
+  allocator.Free(again);
+}
+
+// 测试 Slab 与 Bmalloc 以大页分配器作为页分配器
+TEST_F(HugePageTest, SlabAndBmalloc) {
+  {
+    Slab<DenseAllocator, std::nullptr_t, SpinLock<>> slab(
+        "huge_slab", test_memory_, kTestMemorySize);
+    std::vector<void*> ptrs;
+    for (size_t i = 0; i < 1000; i++) {
+      ptrs.push_back(slab.Alloc(32 + (i % 8) * 64));
+      ASSERT_NE(ptrs.back(), nullptr);
+    }
+    // slab 页都在小对象分组的同一个大页中
+    EXPECT_EQ(slab.GetPageAllocator().GetFreeExtentCount(),
+              slab.GetPageAllocator().GetExtentCount() - 1);
+    for (auto* ptr : ptrs) {
+      slab.Free(ptr);
+    }
+  }
+
+  Bmalloc<std::nullptr_t, SpinLock<>, NoThreadCache, DenseAllocator>
+      allocator(test_memory_, kTestMemorySize);
+  void* small = allocator.malloc(100);
+  void* large = allocator.malloc(kHuge);
+  void* aligned = allocator.aligned_alloc(kHuge, kPageSize);
+  ASSERT_NE(small, nullptr);
+  ASSERT_NE(large, nullptr);
+  ASSERT_NE(aligned, nullptr);
+  EXPECT_TRUE(IsAligned(large, kHuge));
+  EXPECT_TRUE(IsAligned(aligned, kHuge));
+  EXPECT_EQ(allocator.malloc_size(large), kHuge);
+
+  auto* zeroed = static_cast<unsigned char*>(allocator.calloc(4, kPageSize));
+  ASSERT_NE(zeroed, nullptr);
+  EXPECT_EQ(zeroed[kPageSize * 4 - 1], 0);
+  void* grown = allocator.realloc(zeroed, kPageSize * 40);
+  ASSERT_NE(grown, nullptr);
+  EXPECT_EQ(allocator.malloc_size(grown), kPageSize * 40);
+
+  allocator.free(small);
+  allocator.free(large);
+  allocator.free(aligned);
+  allocator.free_sized(grown, kPageSize * 40);
+}
@@ -0,0 +1,230 @@
+/**
+ * Copyright The bmalloc Contributors
+ * @file lock_test.cpp
+ * @brief 锁实现的Google Test测试用例
+ */
+
+#include "lock.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buddy.hpp"
+#include "slab.hpp"
+
+using namespace bmalloc;
+
+namespace {
+
+// 日志函数类型
+struct TestLogger {
+  int operator()(const char* format, ...) const {
+    va_list args;
+    va_start(args, format);
+    int result = vprintf(format, args);
+    va_end(args);
+    return result;
+  }
+};
+
+// 测试环境的线程数可能多于 CPU 核数，等待时让出 CPU，
+// 避免公平锁的下一个持有者被调度出去时其它线程空转整个时间片
+struct YieldPause {
+  void operator()() const { std::this_thread::yield(); }
+};
+
+template <class L>
+class LockTest : public ::testing::Test {};
+
+using LockTypes =
+    ::testing::Types<SpinLock<YieldPause, 1>, TicketLock<YieldPause>,
+                     McsLock<YieldPause>, RwLock<YieldPause>>;
+TYPED_TEST_SUITE(LockTest, LockTypes);
+
+}  // namespace
+
+// 测试互斥：多个线程对非原子计数器的递增不会丢失
+TYPED_TEST(LockTest, MutualExclusion) {
+  constexpr int kThreads = 8;
+  constexpr int kIterations = 20000;
+
+  TypeParam lock;
+  size_t counter = 0;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < kIterations; i++) {
+        LockGuard guard(lock);
+        counter++;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(counter, size_t{kThreads} * kIterations);
+  auto stats = lock.GetLockStats();
+  EXPECT_EQ(stats.acquisitions_, uint64_t{kThreads} * kIterations);
+  EXPECT_LE(stats.contentions_, stats.acquisitions_);
+}
+
+// 测试锁对象按缓存行对齐，不与相邻数据共享缓存行
+TYPED_TEST(LockTest, CacheLinePadding) {
+  EXPECT_EQ(alignof(TypeParam), kCacheLineSize);
+  EXPECT_EQ(sizeof(TypeParam) % kCacheLineSize, 0);
+
+  TypeParam locks[2];
+  auto distance = reinterpret_cast<uintptr_t>(&locks[1]) -
+                  reinterpret_cast<uintptr_t>(&locks[0]);
+  EXPECT_GE(distance, kCacheLineSize);
+}
+
+// 测试无竞争时不计入竞争次数
+TYPED_TEST(LockTest, UncontendedStats) {
+  TypeParam lock;
+  for (int i = 0; i < 10; i++) {
+    lock.Lock();
+    lock.Unlock();
+  }
+  auto stats = lock.GetLockStats();
+  EXPECT_EQ(stats.acquisitions_, 10);
+  EXPECT_EQ(stats.contentions_, 0);
+}
+
+// 测试 TryLock：锁被占用时立即失败，空闲时获取成功
+TYPED_TEST(LockTest, TryLock) {
+  static_assert(TryLockable<TypeParam>);
+
+  TypeParam lock;
+  ASSERT_TRUE(lock.TryLock());
+  bool acquired = true;
+  std::thread other([&]() { acquired = lock.TryLock(); });
+  other.join();
+  EXPECT_FALSE(acquired);
+  lock.Unlock();
+
+  EXPECT_TRUE(lock.TryLock());
+  lock.Unlock();
+  EXPECT_EQ(lock.GetLockStats().acquisitions_, 2);
+}
+
+// 测试读写锁：多个读者可以同时持有，写者与读者互斥
+TEST(RwLockTest, SharedAndExclusive) {
+  RwLock<YieldPause> lock;
+
+  // 两个读者同时持有共享锁
+  std::atomic<int> readers{0};
+  std::atomic<bool> both{false};
+  auto reader = [&]() {
+    SharedLockGuard guard(lock);
+    readers++;
+    for (int i = 0; i < 1000000 && readers.load() < 2; i++) {
+      std::this_thread::yield();
+    }
+    if (readers.load() == 2) {
+      both = true;
+    }
+  };
+  std::thread r1(reader);
+  std::thread r2(reader);
+  r1.join();
+  r2.join();
+  EXPECT_TRUE(both.load());
+
+  // 写者与读者互斥：读者看到的两个值始终相等
+  int a = 0;
+  int b = 0;
+  std::atomic<bool> stop{false};
+  std::atomic<int> mismatches{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&]() {
+      while (!stop.load()) {
+        SharedLockGuard guard(lock);
+        if (a != b) {
+          mismatches++;
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 20000; i++) {
+    LockGuard guard(lock);
+    a++;
+    b++;
+  }
+  stop = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(mismatches.load(), 0);
+  EXPECT_EQ(a, 20000);
+}
+
+// 测试 SharedLockGuard 对不支持共享锁的类型退化为独占锁
+TEST(RwLockTest, SharedGuardFallback) {
+  static_assert(SharedLockable<RwLock<>>);
+  static_assert(!SharedLockable<TicketLock<>>);
+
+  TicketLock<> lock;
+  {
+    SharedLockGuard guard(lock);
+  }
+  EXPECT_EQ(lock.GetLockStats().acquisitions_, 1);
+}
+
+// 测试在 Slab 中使用 ticket 锁，并通过 kmem_cache_info 输出竞争统计
+TEST(SlabLockTest, TicketLockSlab) {
+  using MySlab =
+      Slab<Buddy<TestLogger, TicketLock<YieldPause>>, TestLogger,
+           TicketLock<YieldPause>>;
+  class InfoSlab : public MySlab {
+   public:
+    using MySlab::MySlab;
+    using MySlab::find_create_kmem_cache;
+    using MySlab::kmem_cache_info;
+  };
+
+  constexpr size_t kBytes = kPageSize * 256;
+  void* memory = std::aligned_alloc(kPageSize, kBytes);
+  ASSERT_NE(memory, nullptr);
+  {
+    InfoSlab slab("ticket_slab", memory, kBytes);
+
+    std::vector<std::thread> threads;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&]() {
+        for (int i = 0; i < 2000; i++) {
+          void* ptr = slab.Alloc(64);
+          if (ptr == nullptr) {
+            failures++;
+            continue;
+          }
+          slab.Free(ptr);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(failures.load(), 0);
+
+    auto* cache = slab.find_create_kmem_cache("size-64", 64, nullptr, nullptr);
+    ASSERT_NE(cache, nullptr);
+    testing::internal::CaptureStdout();
+    slab.kmem_cache_info(cache);
+    auto output = testing::internal::GetCapturedStdout();
+    EXPECT_NE(output.find("Lock acquisitions/contended:"), std::string::npos)
+        << output;
+  }
+  std::free(memory);
+}
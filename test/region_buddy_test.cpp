@@ -0,0 +1,268 @@
+/**
+ * Copyright The bmalloc Contributors
+ * @file region_buddy_test.cpp
+ * @brief 多区域Buddy分配器的Google Test测试用例
+ */
+
+#include "region_buddy.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "slab.hpp"
+
+using namespace bmalloc;
+
+namespace {
+
+// 日志函数类型
+struct TestLogger {
+  int operator()(const char* format, ...) const {
+    va_list args;
+    va_start(args, format);
+    int result = vprintf(format, args);
+    va_end(args);
+    return result;
+  }
+};
+
+// 测试用的锁实现
+class TestLock : public LockBase {
+ private:
+  std::mutex mutex_;
+
+ public:
+  void Lock() override { mutex_.lock(); }
+
+  void Unlock() override { mutex_.unlock(); }
+};
+
+// 测试用的节点编号，由每个线程自行设置
+thread_local size_t current_node = 0;
+
+struct TestNodeId {
+  size_t operator()() const { return current_node; }
+};
+
+using TestRegionBuddy = RegionBuddy<TestLogger, TestLock, TestNodeId>;
+
+// 测试夹具：三块互不相邻的内存区域
+class RegionBuddyTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kRegionSize = kPageSize * 64;
+  static constexpr size_t kRegionCount = 3;
+
+  void SetUp() override {
+    for (auto& region : regions_) {
+      region = std::aligned_alloc(kPageSize, kRegionSize);
+      ASSERT_NE(region, nullptr) << "Failed to allocate test memory";
+    }
+    current_node = 0;
+  }
+
+  void TearDown() override {
+    for (auto* region : regions_) {
+      std::free(region);
+    }
+  }
+
+  static auto Contains(void* region, void* ptr) -> bool {
+    auto start = reinterpret_cast<uintptr_t>(region);
+    auto addr = reinterpret_cast<uintptr_t>(ptr);
+    return addr >= start && addr < start + kRegionSize;
+  }
+
+  void* regions_[kRegionCount] = {};
+};
+
+}  // namespace
+
+// 测试第一个区域耗尽后从后添加的区域分配，释放回到所属区域
+TEST_F(RegionBuddyTest, HotAddAndExhaust) {
+  TestRegionBuddy allocator("regions", regions_[0], kRegionSize);
+  EXPECT_EQ(allocator.GetRegionCount(), 1);
+
+  std::vector<void*> first;
+  while (void* ptr = allocator.Alloc(kPageSize)) {
+    EXPECT_TRUE(Contains(regions_[0], ptr));
+    first.push_back(ptr);
+  }
+  ASSERT_FALSE(first.empty());
+
+  // 运行时添加区域后可以继续分配
+  ASSERT_TRUE(allocator.AddRegion(regions_[1], kRegionSize, 0));
+  EXPECT_EQ(allocator.GetRegionCount(), 2);
+  void* second = allocator.Alloc(kPageSize);
+  ASSERT_NE(second, nullptr);
+  EXPECT_TRUE(Contains(regions_[1], second));
+  EXPECT_EQ(allocator.AllocSize(second), kPageSize);
+
+  // 释放第一个区域中的块后重新从第一个区域分配
+  allocator.Free(first.back());
+  void* reused = allocator.Alloc(kPageSize);
+  EXPECT_EQ(reused, first.back());
+  first.back() = reused;
+
+  for (void* ptr : first) {
+    allocator.Free(ptr);
+  }
+  allocator.Free(second);
+  EXPECT_EQ(allocator.AllocSize(nullptr), 0);
+}
+
+// 测试优先从当前节点分配，节点内存不足时回退到其它节点
+TEST_F(RegionBuddyTest, NodeLocalWithFallback) {
+  TestRegionBuddy allocator("regions", regions_[0], kRegionSize);
+  ASSERT_TRUE(allocator.AddRegion(regions_[1], kRegionSize, 1));
+  ASSERT_TRUE(allocator.AddRegion(regions_[2], kRegionSize, 1));
+
+  current_node = 1;
+  void* local = allocator.Alloc(kPageSize);
+  ASSERT_NE(local, nullptr);
+  EXPECT_EQ(allocator.GetNode(local), 1);
+  EXPECT_TRUE(Contains(regions_[1], local));
+
+  void* remote = allocator.AllocOnNode(kPageSize, 0);
+  ASSERT_NE(remote, nullptr);
+  EXPECT_EQ(allocator.GetNode(remote), 0);
+  allocator.Free(remote);
+
+  // 节点 0 的区域耗尽后回退到节点 1
+  current_node = 0;
+  std::vector<void*> ptrs;
+  while (void* ptr = allocator.Alloc(kPageSize)) {
+    ptrs.push_back(ptr);
+    if (allocator.GetNode(ptr) != 0) {
+      break;
+    }
+  }
+  ASSERT_FALSE(ptrs.empty());
+  EXPECT_EQ(allocator.GetNode(ptrs.back()), 1);
+
+  int stack_value = 0;
+  EXPECT_EQ(allocator.GetNode(&stack_value), TestRegionBuddy::kInvalidNode);
+
+  for (void* ptr : ptrs) {
+    allocator.Free(ptr);
+  }
+  allocator.Free(local);
+}
+
+// 测试区域内无法增长时移动到其它区域并保留数据
+TEST_F(RegionBuddyTest, ReallocAcrossRegions) {
+  TestRegionBuddy allocator("regions", regions_[0], kRegionSize);
+
+  // 占满第一个区域后添加第二个区域
+  std::vector<void*> fill;
+  while (void* ptr = allocator.Alloc(kPageSize)) {
+    fill.push_back(ptr);
+  }
+  ASSERT_FALSE(fill.empty());
+  ASSERT_TRUE(allocator.AddRegion(regions_[1], kRegionSize, 0));
+
+  void* ptr = fill.back();
+  fill.pop_back();
+  std::memset(ptr, 0x5A, kPageSize);
+  void* moved = allocator.Realloc(ptr, 4 * kPageSize);
+  ASSERT_NE(moved, nullptr);
+  EXPECT_TRUE(Contains(regions_[1], moved));
+  EXPECT_GE(allocator.AllocSize(moved), 4 * kPageSize);
+  EXPECT_EQ(static_cast<unsigned char*>(moved)[kPageSize - 1], 0x5A);
+
+  // 无法满足时返回 nullptr，原内存块保持不变
+  EXPECT_EQ(allocator.Realloc(moved, kRegionSize * 4), nullptr);
+  EXPECT_GE(allocator.AllocSize(moved), 4 * kPageSize);
+
+  allocator.Free(moved);
+  for (void* block : fill) {
+    allocator.Free(block);
+  }
+}
+
+// 测试调整为 0 字节时拒绝调整，原内存块保持有效
+TEST_F(RegionBuddyTest, ReallocToZeroKeepsBlock) {
+  TestRegionBuddy allocator("regions", regions_[0], kRegionSize);
+  void* ptr = allocator.Alloc(kPageSize);
+  ASSERT_NE(ptr, nullptr);
+  std::memset(ptr, 0x3C, kPageSize);
+
+  EXPECT_EQ(allocator.Realloc(ptr, 0), nullptr);
+  EXPECT_EQ(allocator.AllocSize(ptr), kPageSize);
+  EXPECT_EQ(static_cast<unsigned char*>(ptr)[kPageSize - 1], 0x3C);
+
+  // 原内存块没有被释放，不会再次分配出去
+  void* other = allocator.Alloc(kPageSize);
+  ASSERT_NE(other, nullptr);
+  EXPECT_NE(other, ptr);
+
+  allocator.Free(other);
+  allocator.Free(ptr);
+}
+
+// 测试区域表已满时添加失败
+TEST_F(RegionBuddyTest, RegionTableFull) {
+  RegionBuddy<TestLogger, TestLock, TestNodeId, 2> allocator(
+      "regions", regions_[0], kRegionSize);
+  EXPECT_TRUE(allocator.AddRegion(regions_[1], kRegionSize, 1));
+  EXPECT_FALSE(allocator.AddRegion(regions_[2], kRegionSize, 1));
+  EXPECT_EQ(allocator.GetRegionCount(), 2);
+}
+
+// 测试作为 Slab 的页分配器：slab 页来自当前线程所在的节点
+TEST_F(RegionBuddyTest, SlabPagesFromLocalNode) {
+  using MySlab = Slab<TestRegionBuddy, TestLogger, TestLock>;
+  MySlab slab("region_slab", regions_[0], kRegionSize);
+  auto& pages = slab.GetPageAllocator();
+  ASSERT_TRUE(pages.AddRegion(regions_[1], kRegionSize, 1));
+
+  void* node0 = slab.Alloc(256);
+  ASSERT_NE(node0, nullptr);
+  EXPECT_EQ(pages.GetNode(node0), 0);
+
+  std::thread worker([&]() {
+    current_node = 1;
+    // 节点 1 的线程使用不同大小的 cache，使其 slab 在节点 1 上新建
+    void* node1 = slab.Alloc(1024);
+    ASSERT_NE(node1, nullptr);
+    EXPECT_EQ(pages.GetNode(node1), 1);
+    std::memset(node1, 0xA5, 1024);
+    slab.Free(node1);
+  });
+  worker.join();
+
+  slab.Free(node0);
+}
+
+// 测试在其它线程不加锁查询的同时添加区域
+TEST_F(RegionBuddyTest, ConcurrentAddRegionAndQuery) {
+  TestRegionBuddy allocator("regions", regions_[0], kRegionSize);
+  void* block = allocator.Alloc(kPageSize);
+  ASSERT_NE(block, nullptr);
+
+  std::thread reader([&]() {
+    size_t count = 0;
+    while (count < kRegionCount) {
+      EXPECT_EQ(allocator.AllocSize(block), kPageSize);
+      EXPECT_EQ(allocator.GetNode(block), 0);
+      count = allocator.GetRegionCount();
+      // 已发布的区域都完整可见
+      for (size_t i = 0; i < count; i++) {
+        EXPECT_EQ(allocator.GetNode(regions_[i]), i);
+      }
+    }
+  });
+
+  for (size_t i = 1; i < kRegionCount; i++) {
+    EXPECT_TRUE(allocator.AddRegion(regions_[i], kRegionSize, i));
+  }
+  reader.join();
+
+  EXPECT_EQ(allocator.GetRegionCount(), kRegionCount);
+  allocator.Free(block);
+}
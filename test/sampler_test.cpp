@@ -0,0 +1,266 @@
+/**
+ * Copyright The bmalloc Contributors
+ * @file sampler_test.cpp
+ * @brief 采样堆分析器的Google Test测试用例
+ */
+
+#include "sampler.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "bmalloc.hpp"
+#include "buddy.hpp"
+#include "lock.hpp"
+#include "slab.hpp"
+
+using namespace bmalloc;
+
+namespace {
+
+// 统计回调次数，并检查释放事件与分配事件一致
+struct Recorder {
+  std::atomic<size_t> allocs{0};
+  std::atomic<size_t> frees{0};
+  std::atomic<size_t> weight{0};
+  std::atomic<size_t> mismatched{0};
+
+  static void OnSample(const SampleEvent& event, void* context) {
+    auto* self = static_cast<Recorder*>(context);
+    if (event.op_ == TraceOp::kAlloc) {
+      self->allocs++;
+      self->weight += event.weight_;
+    } else {
+      self->frees++;
+    }
+    // 标签由 SizeTag() 按大小生成，释放事件应带回分配时的标签
+    if (event.tag_ != event.size_ + 1) {
+      self->mismatched++;
+    }
+  }
+};
+
+// 以 thread_local 传递当前请求的大小，模拟调用者提供的调用栈编号
+thread_local size_t current_size = 0;
+
+auto SizeTag(void* /*context*/) -> uintptr_t { return current_size + 1; }
+
+// 测试夹具
+class SamplerTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kTestMemorySize = kPageSize * 256;
+
+  void SetUp() override {
+    test_memory_ = std::aligned_alloc(kPageSize, kTestMemorySize);
+    ASSERT_NE(test_memory_, nullptr) << "Failed to allocate test memory";
+  }
+
+  void TearDown() override { std::free(test_memory_); }
+
+  void* test_memory_ = nullptr;
+};
+
+}  // namespace
+
+// 测试间隔为 0 时采样每次分配，释放匹配回分配的大小与标签
+TEST_F(SamplerTest, SampleEveryAllocation) {
+  SampleEntry entries[64]{};
+  Recorder recorder;
+  HeapSampler sampler(entries, 64, 0, Recorder::OnSample, &recorder, SizeTag);
+
+  Buddy<std::nullptr_t, SpinLock<>> buddy("sampled", test_memory_,
+                                          kTestMemorySize);
+  buddy.SetSampler(&sampler);
+
+  std::vector<void*> ptrs;
+  for (size_t i = 1; i <= 16; i++) {
+    current_size = kPageSize * i;
+    ptrs.push_back(buddy.Alloc(current_size));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  EXPECT_EQ(recorder.allocs, 16);
+  EXPECT_EQ(sampler.Live(), 16);
+  EXPECT_EQ(sampler.Dropped(), 0);
+
+  for (auto* ptr : ptrs) {
+    buddy.Free(ptr);
+  }
+  EXPECT_EQ(recorder.frees, 16);
+  EXPECT_EQ(recorder.mismatched, 0);
+  EXPECT_EQ(sampler.Live(), 0);
+
+  // 停止采样后不再回调
+  buddy.SetSampler(nullptr);
+  void* ptr = buddy.Alloc(kPageSize);
+  ASSERT_NE(ptr, nullptr);
+  buddy.Free(ptr);
+  EXPECT_EQ(recorder.allocs, 16);
+  EXPECT_EQ(sampler.Samples(), 16);
+}
+
+// 测试采样频率与请求的字节数成正比，且加权后近似总分配量
+TEST_F(SamplerTest, SamplingRate) {
+  constexpr size_t kInterval = 4096;
+  constexpr size_t kSize = 64;
+  constexpr size_t kAllocs = 200000;
+  SampleEntry entries[256]{};
+  Recorder recorder;
+  HeapSampler sampler(entries, 256, kInterval, Recorder::OnSample, &recorder,
+                      SizeTag);
+  current_size = kSize;
+
+  // 只测试倒计数，使用不会被释放的假地址
+  for (size_t i = 0; i < kAllocs; i++) {
+    sampler.RecordAlloc(reinterpret_cast<void*>((i + 1) * 16), kSize);
+  }
+  double expected = static_cast<double>(kAllocs * kSize) / kInterval;
+  EXPECT_NEAR(static_cast<double>(recorder.allocs), expected, expected * 0.1);
+  EXPECT_NEAR(static_cast<double>(recorder.weight),
+              static_cast<double>(kAllocs * kSize), kAllocs * kSize * 0.1);
+
+  // 槽位表写满后仍然回调，但不再记录
+  EXPECT_GT(sampler.Dropped(), 0);
+  EXPECT_EQ(sampler.Live() + sampler.Dropped(), sampler.Samples());
+
+  // 没有被采样的地址释放时不回调
+  sampler.RecordFree(reinterpret_cast<void*>(0x8));
+  sampler.RecordFree(nullptr);
+  EXPECT_EQ(recorder.frees, 0);
+}
+
+// 测试 Bmalloc 的各个分配接口与线程缓存命中的请求都会被采样
+TEST_F(SamplerTest, BmallocHooks) {
+  SampleEntry entries[512]{};
+  Recorder recorder;
+  HeapSampler sampler(entries, 512, 0, Recorder::OnSample, &recorder, SizeTag);
+  Bmalloc<std::nullptr_t, SpinLock<>, ThreadLocalCache<>> allocator(
+      test_memory_, kTestMemorySize);
+  allocator.set_sampler(&sampler);
+
+  current_size = 48;
+  void* small = allocator.malloc(48);
+  ASSERT_NE(small, nullptr);
+  allocator.free(small);
+  // 第二次分配由线程缓存满足
+  void* cached = allocator.malloc(48);
+  ASSERT_NE(cached, nullptr);
+  allocator.free_sized(cached, 48);
+
+  current_size = kPageSize * 3;
+  void* large = allocator.calloc(3, kPageSize);
+  ASSERT_NE(large, nullptr);
+  // 移动的 realloc 记为释放旧块与分配新块
+  current_size = 8;
+  void* old = allocator.malloc(8);
+  ASSERT_NE(old, nullptr);
+  current_size = 4000;
+  void* moved = allocator.realloc(old, 4000);
+  ASSERT_NE(moved, nullptr);
+  EXPECT_NE(moved, old);
+  allocator.free(large);
+
+  current_size = 256;
+  void* ptrs[4] = {};
+  ASSERT_EQ(allocator.malloc_bulk(256, 4, ptrs), 4);
+  allocator.free_bulk(ptrs, 4);
+  EXPECT_EQ(recorder.mismatched, 0);
+
+  EXPECT_EQ(recorder.allocs, 2 + 1 + 2 + 4);
+  EXPECT_EQ(sampler.Live(), 1);
+  allocator.free(moved);
+  EXPECT_EQ(sampler.Live(), 0);
+  EXPECT_EQ(recorder.frees, recorder.allocs);
+
+  allocator.set_sampler(nullptr);
+  allocator.release_thread_cache();
+}
+
+// 测试页分配器的 Realloc 移动内存块时记为释放旧块与分配新块
+TEST_F(SamplerTest, BmallocMovedRealloc) {
+  constexpr size_t kBytes = 1024 * 1024 * 4;
+  constexpr size_t kLarge = 256 * 1024;
+  void* memory = std::aligned_alloc(kPageSize, kBytes);
+  ASSERT_NE(memory, nullptr);
+  {
+    SampleEntry entries[64]{};
+    Recorder recorder;
+    HeapSampler sampler(entries, 64, 0, Recorder::OnSample, &recorder,
+                        SizeTag);
+    Bmalloc<std::nullptr_t, SpinLock<>> allocator(memory, kBytes);
+    allocator.set_sampler(&sampler);
+
+    current_size = kLarge;
+    void* block = allocator.malloc(kLarge);
+    void* neighbour = allocator.malloc(kLarge);
+    ASSERT_NE(block, nullptr);
+    ASSERT_NE(neighbour, nullptr);
+
+    // 父块中还有其它内存块，Buddy 重新查找后移动
+    current_size = kLarge * 2;
+    void* moved = allocator.realloc(block, kLarge * 2);
+    ASSERT_NE(moved, nullptr);
+    EXPECT_NE(moved, block);
+    EXPECT_EQ(recorder.allocs, 3);
+    EXPECT_EQ(recorder.frees, 1);
+    EXPECT_EQ(sampler.Live(), 2);
+
+    // 重新分配到旧地址的内存块不会匹配到移动前的记录
+    current_size = kLarge;
+    void* reused = allocator.malloc(kLarge);
+    ASSERT_NE(reused, nullptr);
+    allocator.free(reused);
+    allocator.free(moved);
+    allocator.free(neighbour);
+    EXPECT_EQ(recorder.frees, recorder.allocs);
+    EXPECT_EQ(recorder.mismatched, 0);
+    EXPECT_EQ(sampler.Live(), 0);
+    allocator.set_sampler(nullptr);
+  }
+  std::free(memory);
+}
+
+// 测试多线程并发采样，所有采样分配都被匹配释放
+TEST_F(SamplerTest, Concurrent) {
+  constexpr size_t kBytes = 1024 * 1024 * 4;
+  void* memory = std::malloc(kBytes);
+  ASSERT_NE(memory, nullptr);
+  {
+    SampleEntry entries[1024]{};
+    Recorder recorder;
+    HeapSampler sampler(entries, 1024, 512, Recorder::OnSample, &recorder,
+                        SizeTag);
+    Bmalloc<std::nullptr_t, SpinLock<>, ThreadLocalCache<>> allocator(memory,
+                                                                       kBytes);
+    allocator.set_sampler(&sampler);
+
+    constexpr int kThreads = 4;
+    constexpr int kIterations = 2000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; t++) {
+      workers.emplace_back([&]() {
+        for (int i = 0; i < kIterations; i++) {
+          current_size = 16 + (i % 16) * 16;
+          void* ptr = allocator.malloc(current_size);
+          ASSERT_NE(ptr, nullptr);
+          allocator.free(ptr);
+        }
+        allocator.release_thread_cache();
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    allocator.set_sampler(nullptr);
+
+    EXPECT_GT(recorder.allocs, 0);
+    EXPECT_EQ(recorder.allocs, sampler.Samples());
+    EXPECT_EQ(recorder.frees, recorder.allocs - sampler.Dropped());
+    EXPECT_EQ(recorder.mismatched, 0);
+    EXPECT_EQ(sampler.Live(), 0);
+  }
+  std::free(memory);
+}
@@ -44,6 +44,15 @@ class TestLock : public LockBase {
   void Unlock() override { mutex_.unlock(); }
 };
 
+// 测试用的 CPU 编号：每个线程独占一个编号
+struct TestCpuId {
+  size_t operator()() const {
+    static std::atomic<size_t> next_id{0};
+    thread_local size_t id = next_id++;
+    return id;
+  }
+};
+
 // 测试夹具
 class SlabBuddyTest : public ::testing::Test {
  protected:
@@ -68,20 +77,36 @@ class SlabBuddyTest : public ::testing::Test {
 
 // 派生类用于访问 Slab 的 protected 方法
 template <class PageAllocator, class LogFunc = std::nullptr_t,
-          class Lock = LockBase>
+          class Lock = LockBase, class SizeClass = PowerOfTwoSizeClass,
+          class CpuIdFunc = std::nullptr_t, class Config = DefaultSlabConfig>
   requires std::derived_from<PageAllocator, AllocatorBase<LogFunc, Lock>>
-class TestableSlab : public Slab<PageAllocator, LogFunc, Lock> {
+class TestableSlab
+    : public Slab<PageAllocator, LogFunc, Lock, SizeClass, CpuIdFunc, Config> {
  public:
-  using Base = Slab<PageAllocator, LogFunc, Lock>;
+  using Base =
+      Slab<PageAllocator, LogFunc, Lock, SizeClass, CpuIdFunc, Config>;
   using Base::Base;  // 继承构造函数
 
   // 公开 protected 方法用于测试
   using Base::find_buffers_cache;
+  using Base::find_slab;
+  using Base::CACHE_WASTE_FRACTION;
+  using Base::calculate_slab_order;
+  using Base::slab_leftover;
+  using typename Base::slab_t;
   using Base::find_create_kmem_cache;
   using Base::kmem_cache_alloc;
+  using Base::kmem_cache_alloc_bulk;
   using Base::kmem_cache_destroy;
+  using Base::kmem_cache_drain;
   using Base::kmem_cache_free;
+  using Base::kmem_cache_free_bulk;
+  using Base::kmem_cache_info;
+  using Base::kmem_cache_reap;
+  using Base::kmem_cache_set_min_free;
   using Base::kmem_cache_shrink;
+  using Base::natural_align;
+  using Base::size_class_layouts;
 };
 
 /**
@@ -1408,8 +1433,8 @@ TEST_F(SlabBuddyTest, FourKPageAllocationAndDataValidation) {
 
   // 验证缓存配置
   EXPECT_EQ(page_4k_cache->objectSize_, PAGE_4K);
-  EXPECT_GT(page_4k_cache->order_, 0)
-      << "4K objects should require higher order";
+  EXPECT_NE(page_4k_cache->slab_cache_, nullptr)
+      << "4K objects should use off-slab management";
 
   // 2. 分配第一个4K页面
   void* page1 = slab.kmem_cache_alloc(page_4k_cache);
@@ -1687,9 +1712,1035 @@ TEST_F(SlabBuddyTest, FourKPageAllocationAndDataValidation) {
   std::cout << "   - Expected pages per allocation: "
             << (1 << page_4k_cache->order_) << "\n";
 
-  EXPECT_EQ(page_4k_cache->objectsInSlab_, 1)
-      << "4K objects should have 1 object per slab";
+  EXPECT_EQ(page_4k_cache->objectsInSlab_ * PAGE_4K,
+            kPageSize << page_4k_cache->order_)
+      << "Off-slab 4K objects should fill the slab completely";
 
   std::cout << "\n=== 4K Page Allocation and Data Validation Test (Buddy "
                "Allocator) Completed Successfully ===\n";
 }
+
+/**
+ * @brief 测试页描述符表查找
+ *
+ * 测试内容：
+ * 1. 跨多个 slab 的对象都能通过页描述符表找到所属 slab/cache
+ * 2. 非 "size-" cache 的对象不会被 find_buffers_cache 返回
+ * 3. 使用错误的 cache 释放对象会被拒绝
+ * 4. slab 被收缩后其页不再映射到 slab
+ */
+TEST_F(SlabBuddyTest, PageMapLookupTest) {
+  using MyBuddy = Buddy<TestLogger, TestLock>;
+  using MySlab = TestableSlab<MyBuddy, TestLogger, TestLock>;
+
+  MySlab slab("slab_page_map_test", test_memory_, kTestMemorySize);
+
+  auto* cache = slab.find_create_kmem_cache("page_map_cache", sizeof(double),
+                                            nullptr, nullptr);
+  ASSERT_NE(cache, nullptr);
+  auto* other_cache =
+      slab.find_create_kmem_cache("page_map_other", 128, nullptr, nullptr);
+  ASSERT_NE(other_cache, nullptr);
+
+  // 1. 分配跨越多个 slab 的对象
+  std::vector<void*> objects;
+  const size_t num_objects = cache->objectsInSlab_ * 3 + 1;
+  for (size_t i = 0; i < num_objects; i++) {
+    void* obj = slab.kmem_cache_alloc(cache);
+    ASSERT_NE(obj, nullptr) << "Failed allocation " << i;
+    objects.push_back(obj);
+  }
+
+  std::set<void*> slabs;
+  for (void* obj : objects) {
+    auto* owner = slab.find_slab(obj);
+    ASSERT_NE(owner, nullptr);
+    EXPECT_EQ(owner->myCache_, cache);
+    slabs.insert(owner);
+
+    // 2. 非 "size-" cache 的对象
+    EXPECT_EQ(slab.find_buffers_cache(obj), nullptr);
+  }
+  EXPECT_EQ(slabs.size(), 4);
+
+  void* ptr64 = slab.Alloc(64);
+  ASSERT_NE(ptr64, nullptr);
+  auto* cache64 = slab.find_buffers_cache(ptr64);
+  ASSERT_NE(cache64, nullptr);
+  EXPECT_EQ(cache64->objectSize_, 64);
+  slab.Free(ptr64);
+
+  // 3. 使用错误的 cache 释放
+  auto active_before = other_cache->num_active_;
+  slab.kmem_cache_free(other_cache, objects[0]);
+  EXPECT_EQ(other_cache->error_code_, 6);
+  EXPECT_EQ(other_cache->num_active_, active_before);
+  EXPECT_EQ(cache->num_active_, num_objects);
+
+  // 4. 释放并收缩后页不再映射
+  for (void* obj : objects) {
+    slab.kmem_cache_free(cache, obj);
+    EXPECT_EQ(cache->error_code_, 0);
+  }
+  EXPECT_EQ(cache->num_active_, 0);
+
+  // cache 刚增长过时第一次收缩只会清除 growing_ 标志
+  slab.kmem_cache_shrink(cache);
+  slab.kmem_cache_shrink(cache);
+  for (void* obj : objects) {
+    EXPECT_EQ(slab.find_slab(obj), nullptr);
+  }
+}
+
+/**
+ * @brief 测试通用 cache 的大小分级表
+ *
+ * 测试内容：
+ * 1. 通用 cache 在构造时即已创建
+ * 2. 各种请求大小映射到正确的通用 cache
+ */
+TEST_F(SlabBuddyTest, SizeClassTableTest) {
+  using MyBuddy = Buddy<TestLogger, TestLock>;
+  using MySlab = TestableSlab<MyBuddy, TestLogger, TestLock>;
+
+  MySlab slab("slab_size_class_test", test_memory_, kTestMemorySize);
+
+  // 1. 构造后通用 cache 已存在，且尚未分配 slab
+  auto* cache64 = slab.find_create_kmem_cache("size-64", 64, nullptr, nullptr);
+  ASSERT_NE(cache64, nullptr);
+  EXPECT_EQ(cache64->num_allocations_, 0);
+
+  // 2. 请求大小向上取整到 2 的幂次方
+  const std::vector<std::pair<size_t, size_t>> cases = {
+      {32, 32},     {33, 64},     {64, 64},       {65, 128},
+      {100, 128},   {129, 256},   {1000, 1024},   {2049, 4096},
+      {4096, 4096}, {8000, 8192}, {16385, 32768},
+  };
+
+  for (const auto& [request, expected] : cases) {
+    void* ptr = slab.Alloc(request);
+    ASSERT_NE(ptr, nullptr) << "Failed to allocate " << request << " bytes";
+
+    auto* cache = slab.find_buffers_cache(ptr);
+    ASSERT_NE(cache, nullptr);
+    EXPECT_EQ(cache->objectSize_, expected) << "request = " << request;
+
+    slab.Free(ptr);
+  }
+
+  void* ptr = slab.Alloc(64);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(slab.find_buffers_cache(ptr), cache64);
+  slab.Free(ptr);
+}
+
+/**
+ * @brief 测试细粒度大小分级
+ *
+ * 验证：
+ * 1. QuarterSizeClass 下请求大小向上取整到最近的 1/4 分级
+ * 2. 每个通用 cache 记录请求次数与请求字节数，用于计算内部碎片
+ */
+TEST_F(SlabBuddyTest, QuarterSizeClassTest) {
+  using MyBuddy = Buddy<TestLogger, TestLock>;
+  using MySlab = TestableSlab<MyBuddy, TestLogger, TestLock, QuarterSizeClass>;
+
+  MySlab slab("slab_quarter_test", test_memory_, kTestMemorySize);
+
+  const std::vector<std::pair<size_t, size_t>> cases = {
+      {32, 32},     {33, 48},     {48, 48},     {49, 64},
+      {65, 80},     {100, 112},   {129, 160},   {161, 192},
+      {1000, 1024}, {2049, 2560}, {4096, 4096}, {16385, 20480},
+  };
+
+  for (const auto& [request, expected] : cases) {
+    void* ptr = slab.Alloc(request);
+    ASSERT_NE(ptr, nullptr) << "Failed to allocate " << request << " bytes";
+
+    auto* cache = slab.find_buffers_cache(ptr);
+    ASSERT_NE(cache, nullptr);
+    EXPECT_EQ(cache->objectSize_, expected) << "request = " << request;
+
+    slab.Free(ptr);
+  }
+
+  // 两次 65 字节与一次 80 字节请求：内部碎片 = 1 - 210 / 240
+  auto* cache80 = slab.find_create_kmem_cache("size-80", 80, nullptr, nullptr);
+  ASSERT_NE(cache80, nullptr);
+  size_t requests = cache80->num_requests_;
+  size_t requested = cache80->requested_bytes_;
+
+  void* a = slab.Alloc(65);
+  void* b = slab.Alloc(65);
+  void* c = slab.Alloc(80);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  ASSERT_NE(c, nullptr);
+
+  EXPECT_EQ(cache80->num_requests_, requests + 3);
+  EXPECT_EQ(cache80->requested_bytes_, requested + 210);
+  slab.kmem_cache_info(cache80);
+
+  slab.Free(a);
+  slab.Free(b);
+  slab.Free(c);
+}
+
+/**
+ * @brief 测试 per-CPU magazine 层
+ *
+ * 验证：
+ * 1. 释放的对象进入当前 CPU 的 magazine，再次分配时 LIFO 取回
+ * 2. 超过两个 magazine 容量的对象进入 depot
+ * 3. kmem_cache_drain 将对象归还 slab 层，之后可以收缩 cache
+ */
+TEST_F(SlabBuddyTest, MagazineTest) {
+  using MyBuddy = Buddy<TestLogger, TestLock>;
+  using MySlab = TestableSlab<MyBuddy, TestLogger, TestLock,
+                              PowerOfTwoSizeClass, TestCpuId>;
+
+  MySlab slab("slab_magazine_test", test_memory_, kTestMemorySize);
+
+  auto* cache = slab.find_create_kmem_cache("mag_cache", 64, nullptr, nullptr);
+  ASSERT_NE(cache, nullptr);
+
+  // 1. 释放后对象留在 magazine 中，slab 层仍视为活跃
+  void* obj = slab.kmem_cache_alloc(cache);
+  ASSERT_NE(obj, nullptr);
+  slab.kmem_cache_free(cache, obj);
+  EXPECT_EQ(cache->num_active_, 1);
+  EXPECT_EQ(slab.kmem_cache_alloc(cache), obj);
+  slab.kmem_cache_free(cache, obj);
+
+  // 2. 大量对象：超出的 magazine 进入 depot
+  constexpr size_t kObjects = 100;
+  std::vector<void*> objects;
+  for (size_t i = 0; i < kObjects; i++) {
+    void* ptr = slab.kmem_cache_alloc(cache);
+    ASSERT_NE(ptr, nullptr);
+    objects.push_back(ptr);
+  }
+  std::set<void*> unique(objects.begin(), objects.end());
+  EXPECT_EQ(unique.size(), kObjects);
+
+  for (auto* ptr : objects) {
+    slab.kmem_cache_free(cache, ptr);
+  }
+  EXPECT_NE(cache->depot_full_, nullptr);
+
+  // 再次分配全部对象，应全部来自 magazine
+  size_t active = cache->num_active_;
+  std::set<void*> again;
+  for (size_t i = 0; i < kObjects; i++) {
+    again.insert(slab.kmem_cache_alloc(cache));
+  }
+  EXPECT_EQ(again, unique);
+  EXPECT_EQ(cache->num_active_, active);
+  for (auto* ptr : again) {
+    slab.kmem_cache_free(cache, ptr);
+  }
+
+  // 3. 不属于该 cache 的对象不会进入 magazine
+  int dummy = 0;
+  slab.kmem_cache_free(cache, &dummy);
+  EXPECT_EQ(cache->error_code_, 6);
+
+  slab.kmem_cache_drain(cache);
+  EXPECT_EQ(cache->num_active_, 0);
+  EXPECT_EQ(cache->depot_full_, nullptr);
+  slab.kmem_cache_shrink(cache);
+  slab.kmem_cache_shrink(cache);
+  EXPECT_EQ(cache->num_allocations_, 0);
+
+  slab.kmem_cache_destroy(cache);
+}
+
+/**
+ * @brief 测试多线程下的 per-CPU magazine 层
+ *
+ * 每个线程使用独占的 CPU 编号反复分配与释放，验证对象不会被重复分配，
+ * 各线程清空 magazine 后所有对象归还 slab 层
+ */
+TEST_F(SlabBuddyTest, MagazineConcurrentTest) {
+  using MyBuddy = Buddy<TestLogger, TestLock>;
+  using MySlab = TestableSlab<MyBuddy, TestLogger, TestLock,
+                              PowerOfTwoSizeClass, TestCpuId>;
+
+  MySlab slab("slab_magazine_mt_test", test_memory_, kTestMemorySize);
+
+  auto* cache = slab.find_create_kmem_cache("mag_mt", 64, nullptr, nullptr);
+  ASSERT_NE(cache, nullptr);
+
+  constexpr int kThreads = 4;
+  constexpr int kRounds = 50;
+  constexpr size_t kObjects = 64;
+  std::atomic<int> errors{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t]() {
+      std::vector<void*> objects;
+      for (int round = 0; round < kRounds; round++) {
+        for (size_t i = 0; i < kObjects; i++) {
+          void* ptr = slab.kmem_cache_alloc(cache);
+          if (ptr == nullptr) {
+            errors++;
+            continue;
+          }
+          memset(ptr, t + 1, 64);
+          objects.push_back(ptr);
+        }
+        for (auto* ptr : objects) {
+          auto* bytes = static_cast<unsigned char*>(ptr);
+          if (bytes[0] != t + 1 || bytes[63] != t + 1) {
+            errors++;
+          }
+          slab.kmem_cache_free(cache, ptr);
+        }
+        objects.clear();
+      }
+      slab.kmem_cache_drain(cache);
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(errors.load(), 0);
+  EXPECT_EQ(cache->num_active_, 0);
+
+  slab.kmem_cache_destroy(cache);
+}
+
+/**
+ * @brief 测试批量分配与释放
+ *
+ * 验证：
+ * 1. kmem_cache_alloc_bulk 连续从同一个 slab 取出对象
+ * 2. kmem_cache_free_bulk 后 cache 中没有活跃对象
+ * 3. AllocBulk/FreeBulk 通用接口按大小分级分配，并更新计数器
+ */
+TEST_F(SlabBuddyTest, BulkAllocFreeTest) {
+  using MyBuddy = Buddy<TestLogger, TestLock>;
+  using MySlab = TestableSlab<MyBuddy, TestLogger, TestLock>;
+
+  MySlab slab("slab_bulk_test", test_memory_, kTestMemorySize);
+
+  auto* cache =
+      slab.find_create_kmem_cache("bulk_cache", 256, nullptr, nullptr);
+  ASSERT_NE(cache, nullptr);
+
+  // 1. 分配超过一个 slab 容量的对象
+  const size_t count = cache->objectsInSlab_ + cache->objectsInSlab_ / 2;
+  std::vector<void*> ptrs(count, nullptr);
+  ASSERT_EQ(slab.kmem_cache_alloc_bulk(cache, count, ptrs.data()), count);
+  EXPECT_EQ(cache->num_active_, count);
+
+  std::set<void*> unique(ptrs.begin(), ptrs.end());
+  EXPECT_EQ(unique.size(), count);
+
+  // 前 objectsInSlab_ 个对象位于同一个 slab
+  auto* first = slab.find_slab(ptrs[0]);
+  for (size_t i = 0; i < cache->objectsInSlab_; i++) {
+    EXPECT_EQ(slab.find_slab(ptrs[i]), first);
+  }
+  EXPECT_NE(cache->slabs_full_, nullptr);
+  EXPECT_NE(cache->slabs_partial_, nullptr);
+
+  // 2. 批量释放（nullptr 表项被跳过）
+  ptrs.push_back(nullptr);
+  slab.kmem_cache_free_bulk(cache, ptrs.data(), ptrs.size());
+  EXPECT_EQ(cache->num_active_, 0);
+  EXPECT_EQ(cache->slabs_full_, nullptr);
+  EXPECT_EQ(cache->slabs_partial_, nullptr);
+  EXPECT_EQ(cache->error_code_, 0);
+
+  // 3. 通用接口
+  constexpr size_t kCount = 32;
+  void* buffers[kCount] = {};
+  size_t used = slab.GetUsedCount();
+  ASSERT_EQ(slab.AllocBulk(100, kCount, buffers), kCount);
+  EXPECT_EQ(slab.GetUsedCount(), used + kCount);
+  for (auto* ptr : buffers) {
+    auto* buff_cache = slab.find_buffers_cache(ptr);
+    ASSERT_NE(buff_cache, nullptr);
+    EXPECT_EQ(buff_cache->objectSize_, 128);
+  }
+
+  slab.FreeBulk(buffers, kCount);
+  EXPECT_EQ(slab.GetUsedCount(), used);
+
+  EXPECT_EQ(slab.AllocBulk(16, kCount, buffers), 0);
+
+  slab.kmem_cache_destroy(cache);
+}
+
+/**
+ * @brief 测试按大小释放
+ *
+ * 验证：
+ * 1. Free(ptr, bytes) 直接归还 bytes 对应的通用 cache，计数器正确更新
+ * 2. FreeBulk 的 bytes 非 0 时所有对象归还同一个 cache
+ * 3. IsSizeCacheObject 只在对象属于 bytes 对应的 cache 时返回 true
+ */
+TEST_F(SlabBuddyTest, SizedFreeTest) {
+  using MyBuddy = Buddy<TestLogger, TestLock>;
+  using MySlab = TestableSlab<MyBuddy, TestLogger, TestLock>;
+
+  MySlab slab("slab_sized_free", test_memory_, kTestMemorySize);
+
+  size_t used = slab.GetUsedCount();
+  void* ptr = slab.Alloc(100);
+  ASSERT_NE(ptr, nullptr);
+  auto* cache = slab.find_buffers_cache(ptr);
+  ASSERT_NE(cache, nullptr);
+  size_t active = cache->num_active_;
+
+  EXPECT_TRUE(slab.IsSizeCacheObject(ptr, 100));
+  EXPECT_TRUE(slab.IsSizeCacheObject(ptr, 128));
+  EXPECT_FALSE(slab.IsSizeCacheObject(ptr, 64));
+  EXPECT_FALSE(slab.IsSizeCacheObject(ptr, 0));
+  EXPECT_FALSE(slab.IsSizeCacheObject(ptr, MySlab::kMaxObjectSize + 1));
+
+  slab.Free(ptr, 100);
+  EXPECT_EQ(cache->num_active_, active - 1);
+  EXPECT_EQ(cache->error_code_, 0);
+  EXPECT_EQ(slab.GetUsedCount(), used);
+  EXPECT_EQ(slab.Alloc(128), ptr);
+  slab.Free(ptr, 128);
+
+  constexpr size_t kCount = 16;
+  void* buffers[kCount + 1] = {};
+  ASSERT_EQ(slab.AllocBulk(1000, kCount, buffers), kCount);
+  auto* bulk_cache = slab.find_buffers_cache(buffers[0]);
+  ASSERT_NE(bulk_cache, nullptr);
+  active = bulk_cache->num_active_;
+  slab.FreeBulk(buffers, kCount + 1, 1000);
+  EXPECT_EQ(bulk_cache->num_active_, active - kCount);
+  EXPECT_EQ(bulk_cache->error_code_, 0);
+  EXPECT_EQ(slab.GetUsedCount(), used);
+}
+
+/**
+ * @brief 测试 slab order 选择策略
+ *
+ * 验证：
+ * 1. 选定的 order 至少容纳一个对象，且尾部浪费不超过 1/CACHE_WASTE_FRACTION
+ *    （对象过大时以最小 order 为准）
+ * 2. slab 按 2^order 页从页分配器获取，最后一个对象也位于该 slab 的页中
+ */
+TEST_F(SlabBuddyTest, SlabOrderPolicyTest) {
+  using MyBuddy = Buddy<TestLogger, TestLock>;
+  using MySlab = TestableSlab<MyBuddy, TestLogger, TestLock>;
+
+  MySlab slab("slab_order_test", test_memory_, kTestMemorySize);
+
+  // 1. order 选择
+  for (size_t size : {32, 100, 1000, 3000, 4096, 5000}) {
+    auto order = MySlab::calculate_slab_order(size);
+    size_t slab_bytes = kPageSize << order;
+    EXPECT_GE(slab_bytes, size) << "size = " << size;
+    EXPECT_LE(MySlab::slab_leftover(size, order) * MySlab::CACHE_WASTE_FRACTION,
+              slab_bytes)
+        << "size = " << size;
+  }
+
+  // 2. 大对象 cache 的 slab 跨越 2^order 页
+  auto* cache =
+      slab.find_create_kmem_cache("order_cache", 3000, nullptr, nullptr);
+  ASSERT_NE(cache, nullptr);
+  EXPECT_GT(cache->order_, 0);
+  EXPECT_GT(cache->objectsInSlab_, 1);
+
+  std::vector<void*> objects;
+  for (size_t i = 0; i < cache->objectsInSlab_; i++) {
+    void* ptr = slab.kmem_cache_alloc(cache);
+    ASSERT_NE(ptr, nullptr);
+    memset(ptr, static_cast<int>(i), 3000);
+    objects.push_back(ptr);
+  }
+
+  auto* first = slab.find_slab(objects.front());
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(slab.find_slab(objects.back()), first);
+  auto end =
+      reinterpret_cast<uintptr_t>(first->page_) + (kPageSize << cache->order_);
+  EXPECT_LE(reinterpret_cast<uintptr_t>(objects.back()) + 3000, end);
+
+  for (size_t i = 0; i < objects.size(); i++) {
+    EXPECT_EQ(static_cast<unsigned char*>(objects[i])[2999], i & 0xFF);
+    slab.kmem_cache_free(cache, objects[i]);
+  }
+  EXPECT_EQ(cache->num_active_, 0);
+
+  slab.kmem_cache_destroy(cache);
+}
+
+/**
+ * @brief 测试 off-slab 管理结构与内嵌空闲链表索引
+ *
+ * 验证：
+ * 1. 小对象 cache 使用内嵌索引，slab 页内没有 freeList_ 数组
+ * 2. 大对象 cache 的 slab_t 从通用 cache 分配，对象填满整个 slab
+ * 3. 带构造函数的大对象 cache 保留 freeList_ 数组，且对象状态不被破坏
+ */
+TEST_F(SlabBuddyTest, OffSlabManagementTest) {
+  using MyBuddy = Buddy<TestLogger, TestLock>;
+  using MySlab = TestableSlab<MyBuddy, TestLogger, TestLock>;
+
+  MySlab slab("slab_off_slab_test", test_memory_, kTestMemorySize);
+
+  // 1. 小对象：slab_t 位于页内，空闲链表索引内嵌在对象中
+  auto* small =
+      slab.find_create_kmem_cache("small_cache", 64, nullptr, nullptr);
+  ASSERT_NE(small, nullptr);
+  EXPECT_TRUE(small->embedded_free_);
+  EXPECT_EQ(small->slab_cache_, nullptr);
+  EXPECT_EQ(small->objectsInSlab_,
+            (kPageSize - sizeof(MySlab::slab_t)) / small->objectSize_);
+
+  std::vector<void*> objects;
+  for (size_t i = 0; i < small->objectsInSlab_ * 2; i++) {
+    void* ptr = slab.kmem_cache_alloc(small);
+    ASSERT_NE(ptr, nullptr);
+    memset(ptr, 0x5A, 64);
+    objects.push_back(ptr);
+  }
+  std::set<void*> unique(objects.begin(), objects.end());
+  EXPECT_EQ(unique.size(), objects.size());
+  for (auto* ptr : objects) {
+    slab.kmem_cache_free(small, ptr);
+  }
+  EXPECT_EQ(small->num_active_, 0);
+  EXPECT_EQ(small->error_code_, 0);
+
+  // 2. 大对象：slab_t 位于 slab 页之外
+  auto* large =
+      slab.find_create_kmem_cache("large_cache", 1024, nullptr, nullptr);
+  ASSERT_NE(large, nullptr);
+  ASSERT_NE(large->slab_cache_, nullptr);
+  EXPECT_EQ(large->objectsInSlab_ * 1024, kPageSize << large->order_);
+
+  void* obj = slab.kmem_cache_alloc(large);
+  ASSERT_NE(obj, nullptr);
+  auto* large_slab = slab.find_slab(obj);
+  ASSERT_NE(large_slab, nullptr);
+  EXPECT_EQ(large_slab->page_, obj);
+  EXPECT_NE(static_cast<void*>(large_slab), large_slab->page_);
+  EXPECT_EQ(slab.find_slab(large_slab)->myCache_, large->slab_cache_);
+  slab.kmem_cache_free(large, obj);
+  EXPECT_EQ(large->num_active_, 0);
+
+  // 3. 带构造函数的大对象：对象状态在释放后保持
+  static int ctor_calls = 0;
+  auto ctor = +[](void* ptr) {
+    ctor_calls++;
+    *static_cast<int*>(ptr) = 42;
+  };
+  auto* ctor_cache =
+      slab.find_create_kmem_cache("ctor_large_cache", 1024, ctor, nullptr);
+  ASSERT_NE(ctor_cache, nullptr);
+  EXPECT_FALSE(ctor_cache->embedded_free_);
+  EXPECT_NE(ctor_cache->slab_cache_, nullptr);
+
+  std::vector<void*> ctor_objects;
+  for (size_t i = 0; i < ctor_cache->objectsInSlab_; i++) {
+    void* ptr = slab.kmem_cache_alloc(ctor_cache);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(*static_cast<int*>(ptr), 42);
+    ctor_objects.push_back(ptr);
+  }
+  for (auto* ptr : ctor_objects) {
+    slab.kmem_cache_free(ctor_cache, ptr);
+  }
+  for (auto* ptr : ctor_objects) {
+    ASSERT_NE(slab.kmem_cache_alloc(ctor_cache), nullptr);
+    EXPECT_EQ(*static_cast<int*>(ptr), 42);
+  }
+  EXPECT_EQ(ctor_calls, static_cast<int>(ctor_cache->objectsInSlab_));
+
+  // 销毁后 off-slab 管理结构也被释放
+  auto* slab_cache = ctor_cache->slab_cache_;
+  size_t headers_before = slab_cache->num_active_;
+  slab.kmem_cache_destroy(ctor_cache);
+  EXPECT_EQ(slab_cache->num_active_, headers_before - 1);
+  slab.kmem_cache_destroy(large);
+  slab.kmem_cache_destroy(small);
+}
+
+/**
+ * @brief 测试延迟回收空闲 slab
+ */
+TEST_F(SlabBuddyTest, LazyReclaimTest) {
+  using MyBuddy = Buddy<TestLogger, TestLock>;
+  using MySlab = TestableSlab<MyBuddy, TestLogger, TestLock>;
+
+  MySlab slab("slab_reclaim_test", test_memory_, kTestMemorySize);
+
+  auto* cache = slab.find_create_kmem_cache("size-256", 256, nullptr, nullptr);
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(cache->min_free_slabs_, 1);
+  const size_t per_slab = cache->objectsInSlab_;
+
+  // 1. 填满第一个 slab
+  std::vector<void*> objects;
+  for (size_t i = 0; i < per_slab; i++) {
+    void* ptr = slab.Alloc(256);
+    ASSERT_NE(ptr, nullptr);
+    objects.push_back(ptr);
+  }
+  EXPECT_EQ(cache->num_allocations_, per_slab);
+
+  // 2. 在 slab 边界反复分配、释放：空闲 slab 被保留，不会反复申请页
+  void* edge = slab.Alloc(256);
+  ASSERT_NE(edge, nullptr);
+  auto* page = slab.find_slab(edge)->page_;
+  for (int i = 0; i < 100; i++) {
+    slab.Free(edge);
+    EXPECT_EQ(cache->num_free_slabs_, 1);
+    EXPECT_EQ(cache->num_allocations_, 2 * per_slab);
+    edge = slab.Alloc(256);
+    ASSERT_NE(edge, nullptr);
+    EXPECT_EQ(slab.find_slab(edge)->page_, page);
+  }
+  slab.Free(edge);
+
+  // 3. 超出保留数量的空闲 slab 在释放时回收
+  for (auto* ptr : objects) {
+    slab.Free(ptr);
+  }
+  EXPECT_EQ(cache->num_active_, 0);
+  EXPECT_EQ(cache->num_free_slabs_, 1);
+  EXPECT_EQ(cache->num_allocations_, per_slab);
+
+  // 4. 内存紧张时回收所有空闲 slab
+  EXPECT_GE(slab.Reclaim(), size_t{1} << cache->order_);
+  EXPECT_EQ(cache->num_free_slabs_, 0);
+  EXPECT_EQ(cache->slabs_free_, nullptr);
+  EXPECT_EQ(cache->num_allocations_, 0);
+  EXPECT_EQ(slab.Reclaim(), 0);
+
+  // 5. 保留数量为 0 时 slab 空闲后立即归还
+  slab.kmem_cache_set_min_free(cache, 0);
+  void* ptr = slab.Alloc(256);
+  ASSERT_NE(ptr, nullptr);
+  slab.Free(ptr);
+  EXPECT_EQ(cache->num_free_slabs_, 0);
+  EXPECT_EQ(cache->num_allocations_, 0);
+
+  // 6. kmem_cache_reap 按指定数量保留空闲 slab
+  auto* user = slab.find_create_kmem_cache("reap_cache", 256, nullptr, nullptr);
+  ASSERT_NE(user, nullptr);
+  std::vector<void*> user_objects;
+  for (size_t i = 0; i < 3 * user->objectsInSlab_; i++) {
+    user_objects.push_back(slab.kmem_cache_alloc(user));
+    ASSERT_NE(user_objects.back(), nullptr);
+  }
+  for (auto* obj : user_objects) {
+    slab.kmem_cache_free(user, obj);
+  }
+  EXPECT_EQ(user->num_free_slabs_, 3);
+  EXPECT_EQ(slab.kmem_cache_reap(user, 1), 2 << user->order_);
+  EXPECT_EQ(user->num_free_slabs_, 1);
+  EXPECT_EQ(user->num_allocations_, user->objectsInSlab_);
+  slab.kmem_cache_destroy(user);
+}
+
+// 测试通用 cache 的自然对齐与 AllocAligned
+TEST_F(SlabBuddyTest, NaturalAlignmentTest) {
+  using MyBuddy = Buddy<TestLogger, TestLock>;
+  using MySlab = TestableSlab<MyBuddy, TestLogger, TestLock>;
+
+  MySlab slab("slab_align_test", test_memory_, kTestMemorySize);
+
+  // 1. 2 的幂大小的对象按自身大小对齐（最大为页大小）
+  for (size_t size = 32; size <= 16384; size *= 2) {
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 8; i++) {
+      void* ptr = slab.Alloc(size);
+      ASSERT_NE(ptr, nullptr);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % std::min(size, kPageSize),
+                0)
+          << "size " << size;
+      ptrs.push_back(ptr);
+    }
+    for (auto* ptr : ptrs) {
+      slab.Free(ptr);
+    }
+  }
+
+  // 2. 对齐大于请求大小时选择满足对齐的分级，没有填充
+  void* ptr = slab.AllocAligned(1024, 100);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 1024, 0);
+  EXPECT_EQ(slab.GetAllocatedSize(ptr), 1024);
+  slab.Free(ptr);
+
+  ptr = slab.AllocAligned(kPageSize, kPageSize);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % kPageSize, 0);
+  EXPECT_EQ(slab.GetAllocatedSize(ptr), kPageSize);
+  slab.Free(ptr);
+
+  // 3. 无效的对齐
+  EXPECT_EQ(slab.AllocAligned(0, 64), nullptr);
+  EXPECT_EQ(slab.AllocAligned(48, 64), nullptr);
+  EXPECT_EQ(slab.AllocAligned(kPageSize * 2, 64), nullptr);
+
+  // 4. 自定义 cache 的对齐
+  auto* cache =
+      slab.find_create_kmem_cache("aligned_cache", 200, nullptr, nullptr, 256);
+  ASSERT_NE(cache, nullptr);
+  for (size_t i = 0; i < 2 * cache->objectsInSlab_; i++) {
+    void* obj = slab.kmem_cache_alloc(cache);
+    ASSERT_NE(obj, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(obj) % 256, 0);
+  }
+  EXPECT_EQ(slab.find_create_kmem_cache("bad_align", 200, nullptr, nullptr, 3),
+            nullptr);
+  slab.kmem_cache_destroy(cache);
+}
+
+// 不继承 LockBase 的锁类型
+struct PlainLock {
+  void Lock() {}
+  void Unlock() {}
+};
+
+// 测试编译期分派：具体类型的调用静态绑定，AllocatorBase 接口保持可用
+TEST_F(SlabBuddyTest, StaticDispatchTest) {
+  {
+    using FastSlab =
+        Slab<Buddy<std::nullptr_t, NullLock>, std::nullptr_t, NullLock>;
+    FastSlab slab("static_slab", test_memory_, kTestMemorySize);
+
+    void* ptr = slab.Alloc(64);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(slab.GetAllocatedSize(ptr), 64);
+
+    // 通过虚函数接口访问同一个分配器
+    AllocatorBase<std::nullptr_t, NullLock>& base = slab;
+    void* other = base.Alloc(64);
+    ASSERT_NE(other, nullptr);
+    EXPECT_NE(other, ptr);
+    base.Free(other);
+    EXPECT_EQ(slab.Alloc(64), other);
+
+    void* ptrs[8];
+    EXPECT_EQ(slab.AllocBulk(128, 8, ptrs), 8);
+    slab.FreeBulk(ptrs, 8);
+    slab.Free(other);
+    slab.Free(ptr);
+  }
+
+  {
+    using PlainBuddy = Buddy<std::nullptr_t, PlainLock>;
+    memset(test_memory_, 0, kTestMemorySize);
+    PlainBuddy buddy("plain_buddy", test_memory_, kTestMemorySize);
+    void* ptr = buddy.Alloc(kPageSize);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(buddy.AllocSize(ptr), kPageSize);
+    buddy.Free(ptr);
+  }
+}
+
+/**
+ * @brief 测试 kmem_cache_t 的缓存行布局
+ *
+ * 只读配置、cache_lock_ 保护的状态与相邻 cache 互不共享缓存行；
+ * 多线程基准分别测量各线程使用独立 cache 与共享同一 cache 时的吞吐量
+ */
+TEST_F(SlabBuddyTest, CacheLineLayoutTest) {
+  using MySlab =
+      TestableSlab<Buddy<TestLogger, TestLock>, TestLogger, TestLock>;
+  MySlab slab("layout_slab", test_memory_, kTestMemorySize);
+
+  constexpr uintptr_t kLine = 64;
+  auto line = [](const void* ptr) {
+    return reinterpret_cast<uintptr_t>(ptr) / kLine;
+  };
+
+  auto* cache64 = slab.find_create_kmem_cache("size-64", 64, nullptr, nullptr);
+  auto* cache128 =
+      slab.find_create_kmem_cache("size-128", 128, nullptr, nullptr);
+  ASSERT_NE(cache64, nullptr);
+  ASSERT_NE(cache128, nullptr);
+
+  // cache 对象按缓存行对齐且大小为缓存行的整数倍，相邻 cache 不共享缓存行
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(cache64) % kLine, 0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(cache128) % kLine, 0);
+  EXPECT_EQ(sizeof(*cache64) % kLine, 0);
+
+  // 只读配置与锁、slab 链表及计数器位于不同的缓存行
+  for (auto* cache : {cache64, cache128}) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(&cache->cache_lock_) % kLine, 0);
+    EXPECT_LT(line(&cache->next_), line(&cache->cache_lock_));
+    EXPECT_LT(line(&cache->objectSize_), line(&cache->slabs_partial_));
+    EXPECT_LT(line(&cache->ctor_), line(&cache->num_active_));
+    EXPECT_LT(line(&cache->error_code_), line(&cache->depot_lock_));
+  }
+
+  // 多线程基准：每个线程反复分配、释放一批对象
+  constexpr int kThreads = 4;
+  constexpr int kRounds = 20000;
+  constexpr int kBatch = 8;
+  auto run = [&](bool shared) {
+    std::vector<std::thread> threads;
+    std::atomic<int> failures{0};
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < kThreads; t++) {
+      threads.emplace_back([&, t]() {
+        auto* cache = shared || t % 2 == 0 ? cache64 : cache128;
+        void* ptrs[kBatch];
+        for (int round = 0; round < kRounds; round++) {
+          for (auto& ptr : ptrs) {
+            ptr = slab.kmem_cache_alloc(cache);
+            if (ptr == nullptr) {
+              failures++;
+            }
+          }
+          for (auto* ptr : ptrs) {
+            if (ptr != nullptr) {
+              slab.kmem_cache_free(cache, ptr);
+            }
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    EXPECT_EQ(failures.load(), 0);
+    return double{kThreads} * kRounds * kBatch * 2 / elapsed;
+  };
+
+  double separate = run(false);
+  double shared = run(true);
+  std::cout << "Cache line layout benchmark (" << kThreads << " threads):\n";
+  std::cout << std::fixed << std::setprecision(0)
+            << "  - separate caches: " << separate << " ops/s\n"
+            << "  - shared cache:    " << shared << " ops/s\n";
+
+  EXPECT_EQ(cache64->num_active_, 0);
+  EXPECT_EQ(cache128->num_active_, 0);
+}
+
+/**
+ * @brief 测试远程释放
+ *
+ * 锁支持 TryLock 时，cache 锁被占用的释放操作将对象无锁地放入 slab 的
+ * 远程释放链表，持有锁的线程在 partial 链表为空或回收时收回
+ */
+TEST_F(SlabBuddyTest, RemoteFreeTest) {
+  using RemoteLock = SpinLock<>;
+  using MySlab =
+      TestableSlab<Buddy<TestLogger, RemoteLock>, TestLogger, RemoteLock>;
+  MySlab slab("remote_slab", test_memory_, kTestMemorySize);
+
+  auto* cache = slab.find_create_kmem_cache("remote", 64, nullptr, nullptr);
+  ASSERT_NE(cache, nullptr);
+
+  // 分配满一个 slab，使 partial 链表为空
+  std::vector<void*> objects;
+  for (size_t i = 0; i < cache->objectsInSlab_; i++) {
+    objects.push_back(slab.kmem_cache_alloc(cache));
+    ASSERT_NE(objects.back(), nullptr);
+  }
+  EXPECT_EQ(cache->slabs_partial_, nullptr);
+  auto allocations = cache->num_allocations_;
+
+  // 持有 cache 锁时，其它线程的释放不等待锁
+  void* victim = objects.back();
+  objects.pop_back();
+  cache->cache_lock_.Lock();
+  std::thread other([&]() { slab.kmem_cache_free(cache, victim); });
+  other.join();
+  EXPECT_EQ(cache->num_active_, objects.size() + 1);
+  EXPECT_NE(cache->remote_slabs_.load(), nullptr);
+  cache->cache_lock_.Unlock();
+
+  // partial 链表为空时收回远程释放的对象，不分配新的 slab
+  void* reused = slab.kmem_cache_alloc(cache);
+  EXPECT_EQ(reused, victim);
+  EXPECT_EQ(cache->num_allocations_, allocations);
+  EXPECT_EQ(cache->remote_slabs_.load(), nullptr);
+  objects.push_back(reused);
+
+  // 生产者分配、消费者释放，释放与分配竞争 cache 锁
+  constexpr int kObjects = 20000;
+  std::vector<std::atomic<void*>> queue(256);
+  std::atomic<int> failures{0};
+  std::thread producer([&]() {
+    for (int i = 0; i < kObjects; i++) {
+      void* ptr = slab.kmem_cache_alloc(cache);
+      if (ptr == nullptr) {
+        failures++;
+        continue;
+      }
+      auto& entry = queue[i % queue.size()];
+      void* expected = nullptr;
+      while (!entry.compare_exchange_weak(expected, ptr)) {
+        expected = nullptr;
+        std::this_thread::yield();
+      }
+    }
+  });
+  std::thread consumer([&]() {
+    for (int i = 0; i < kObjects - failures.load(); i++) {
+      auto& entry = queue[i % queue.size()];
+      void* ptr = nullptr;
+      while ((ptr = entry.exchange(nullptr)) == nullptr) {
+        std::this_thread::yield();
+      }
+      slab.kmem_cache_free(cache, ptr);
+    }
+  });
+  producer.join();
+  consumer.join();
+  EXPECT_EQ(failures.load(), 0);
+
+  for (auto* ptr : objects) {
+    slab.kmem_cache_free(cache, ptr);
+  }
+  // 回收时收回所有远程释放的对象
+  slab.kmem_cache_reap(cache, 0);
+  EXPECT_EQ(cache->num_active_, 0);
+  EXPECT_EQ(cache->remote_slabs_.load(), nullptr);
+  EXPECT_EQ(cache->error_code_, 0);
+}
+
+/**
+ * @brief 测试对象的延迟初始化
+ *
+ * 1. 新增 slab 时不调用构造函数，对象在第一次分配时才构造
+ * 2. 释放后再次分配复用空闲链表中的对象，不再调用构造函数
+ * 3. 未分配过的对象所在的内存不被写入
+ */
+TEST_F(SlabBuddyTest, LazyObjectInitTest) {
+  using MySlab =
+      TestableSlab<Buddy<TestLogger, TestLock>, TestLogger, TestLock>;
+  MySlab slab("lazy_slab", test_memory_, kTestMemorySize);
+
+  static size_t ctor_calls = 0;
+  ctor_calls = 0;
+  auto ctor = +[](void* ptr) {
+    ctor_calls++;
+    std::memset(ptr, 0x42, 256);
+  };
+  auto* cache = slab.find_create_kmem_cache("lazy", 256, ctor, nullptr);
+  ASSERT_NE(cache, nullptr);
+  ASSERT_GT(cache->objectsInSlab_, 4);
+
+  // 第一次分配只构造一个对象，其后的对象保持未写入
+  void* first = slab.kmem_cache_alloc(cache);
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(ctor_calls, 1);
+  auto* slab_info = slab.find_slab(first);
+  ASSERT_NE(slab_info, nullptr);
+  EXPECT_EQ(slab_info->bump_, 1);
+  auto* untouched = static_cast<unsigned char*>(slab_info->object_at(1));
+  EXPECT_EQ(untouched[0], 0);
+
+  void* second = slab.kmem_cache_alloc(cache);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(second, untouched);
+  EXPECT_EQ(ctor_calls, 2);
+
+  // 释放的对象被复用，不再调用构造函数
+  slab.kmem_cache_free(cache, first);
+  EXPECT_EQ(slab.kmem_cache_alloc(cache), first);
+  EXPECT_EQ(ctor_calls, 2);
+  EXPECT_EQ(slab_info->bump_, 2);
+
+  // 分配满整个 slab 后每个对象恰好构造一次
+  std::vector<void*> objects = {first, second};
+  for (size_t i = 2; i < cache->objectsInSlab_; i++) {
+    void* ptr = slab.kmem_cache_alloc(cache);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(static_cast<unsigned char*>(ptr)[255], 0x42);
+    objects.push_back(ptr);
+  }
+  EXPECT_EQ(ctor_calls, cache->objectsInSlab_);
+  EXPECT_EQ(slab_info->bump_, cache->objectsInSlab_);
+  for (void* ptr : objects) {
+    slab.kmem_cache_free(cache, ptr);
+  }
+  EXPECT_EQ(cache->error_code_, 0);
+}
+
+// 嵌入式目标的配置：较小的缓存行与名称长度，释放后不保留空闲 slab
+struct SmallTargetSlabConfig : DefaultSlabConfig {
+  static constexpr size_t kCacheLineSize = 32;
+  static constexpr size_t kNameLength = 16;
+  static constexpr size_t kMinFreeSlabs = 0;
+};
+
+// 测试编译期计算的通用 cache 布局与运行时计算的结果一致
+TEST_F(SlabBuddyTest, CompileTimeLayoutTest) {
+  using MySlab =
+      TestableSlab<Buddy<TestLogger, TestLock>, TestLogger, TestLock>;
+  constexpr auto kLayouts = MySlab::size_class_layouts();
+  static_assert(kLayouts[0].objects_ > 0);
+  MySlab slab("layout_slab", test_memory_, kTestMemorySize);
+
+  for (size_t i = 0; i < PowerOfTwoSizeClass::kCount; i++) {
+    size_t size = PowerOfTwoSizeClass::Size(i);
+    size_t align = MySlab::natural_align(size);
+    char name[32];
+    snprintf(name, sizeof(name), "size-%zu", size);
+    auto* sized = slab.find_create_kmem_cache(name, size, nullptr, nullptr,
+                                              align);
+    // 其它名称的 cache 在运行时计算布局
+    snprintf(name, sizeof(name), "runtime-%zu", size);
+    auto* runtime = slab.find_create_kmem_cache(name, size, nullptr, nullptr,
+                                                align);
+    ASSERT_NE(sized, nullptr);
+    ASSERT_NE(runtime, nullptr);
+    ASSERT_NE(sized, runtime);
+    EXPECT_EQ(sized->order_, kLayouts[i].order_);
+    EXPECT_EQ(sized->order_, runtime->order_) << "size " << size;
+    EXPECT_EQ(sized->objectsInSlab_, runtime->objectsInSlab_);
+    EXPECT_EQ(sized->colour_max_, runtime->colour_max_);
+    EXPECT_EQ(sized->slab_cache_, runtime->slab_cache_);
+  }
+}
+
+// 测试自定义的编译期配置
+TEST_F(SlabBuddyTest, CustomConfigTest) {
+  using MySlab = TestableSlab<Buddy<TestLogger, TestLock>, TestLogger,
+                              TestLock, QuarterSizeClass, std::nullptr_t,
+                              SmallTargetSlabConfig>;
+  MySlab slab("small_target", test_memory_, kTestMemorySize);
+
+  std::vector<void*> ptrs;
+  for (size_t size : {32, 48, 80, 200, 1000, 5000}) {
+    for (int i = 0; i < 8; i++) {
+      void* ptr = slab.Alloc(size);
+      ASSERT_NE(ptr, nullptr) << size;
+      std::memset(ptr, 0x5A, size);
+      ptrs.push_back(ptr);
+    }
+  }
+
+  CacheStats caches[QuarterSizeClass::kCount];
+  size_t count = slab.GetCacheStats(caches, QuarterSizeClass::kCount);
+  EXPECT_EQ(count, QuarterSizeClass::kCount);
+  EXPECT_STREQ(caches[QuarterSizeClass::Index(80)].name_, "size-80");
+
+  // 不保留空闲 slab：全部释放后通用 cache 不再持有对象
+  for (void* ptr : ptrs) {
+    slab.Free(ptr);
+  }
+  count = slab.GetCacheStats(caches, QuarterSizeClass::kCount);
+  for (size_t i = 0; i < count; i++) {
+    EXPECT_EQ(caches[i].active_objects_, 0) << caches[i].name_;
+    // 管理 off-slab 结构的 cache 中可能仍保留其它 slab 的管理结构
+    if (caches[i].object_size_ >= kPageSize / 8) {
+      EXPECT_EQ(caches[i].total_objects_, 0) << caches[i].name_;
+    }
+  }
+}
@@ -1242,8 +1242,8 @@ TEST_F(SlabStandardTest, FourKPageAllocationAndDataValidation) {
 
   // 验证缓存配置
   EXPECT_EQ(page_4k_cache->objectSize_, PAGE_4K);
-  EXPECT_GT(page_4k_cache->order_, 0)
-      << "4K objects should require higher order";
+  EXPECT_NE(page_4k_cache->slab_cache_, nullptr)
+      << "4K objects should use off-slab management";
 
   // 2. 分配第一个4K页面
   void* page1 = slab.kmem_cache_alloc(page_4k_cache);
@@ -61,19 +61,18 @@ class StandardAllocator : public bmalloc::AllocatorBase<LogFunc, Lock> {
  protected:
   /**
    * @brief 分配指定长度的内存的实际实现（线程不安全）
-   * @param order 要分配的页面数的对数（如 order=2 表示分配 2^2=4 个页面）
-   * @return void* 分配到的地址，失败时返回nullptr
+   * @param bytes 要分配的字节数，向上取整到页大小
+   * @return void* 按页对齐的地址，失败时返回nullptr
    */
-  [[nodiscard]] auto AllocImpl(size_t order) -> void* override {
-    // 将 order 转换为字节数：2^order 个页面，每个页面 4096 字节
-    size_t pages = 1ULL << order;
-    size_t length = pages * 4096;  // kPageSize = 4096
+  [[nodiscard]] auto AllocImpl(size_t bytes) -> void* override {
+    size_t length =
+        (bytes + bmalloc::kPageSize - 1) & ~(bmalloc::kPageSize - 1);
 
     if (length == 0) {
       return nullptr;
     }
 
-    void* addr = std::malloc(length);
+    void* addr = std::aligned_alloc(bmalloc::kPageSize, length);
     if (addr != nullptr) {
       // 记录分配的地址
       allocated_addresses_.insert(addr);
@@ -85,9 +84,9 @@ class StandardAllocator : public bmalloc::AllocatorBase<LogFunc, Lock> {
   /**
    * @brief 释放指定地址的内存的实际实现（线程不安全）
    * @param addr 要释放的地址
-   * @param order 要释放的页面数的对数（未使用，标准分配器不需要大小信息）
+   * @param bytes 要释放的字节数（未使用，标准分配器不需要大小信息）
    */
-  void FreeImpl(void* addr, [[maybe_unused]] size_t order = 0) override {
+  void FreeImpl(void* addr, [[maybe_unused]] size_t bytes = 0) override {
     if (addr != nullptr) {
       // 从记录中移除地址
       auto it = allocated_addresses_.find(addr);
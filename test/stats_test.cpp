@@ -0,0 +1,218 @@
+/**
+ * Copyright The bmalloc Contributors
+ * @file stats_test.cpp
+ * @brief 统计计数与快照接口的Google Test测试用例
+ */
+
+#include "stats.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "bmalloc.hpp"
+#include "buddy.hpp"
+#include "first_fit.hpp"
+#include "lock.hpp"
+#include "slab.hpp"
+
+using namespace bmalloc;
+
+namespace {
+
+// 每个线程独占一个 CPU 编号
+struct TestCpuId {
+  size_t operator()() const {
+    static std::atomic<size_t> next_id{0};
+    thread_local size_t id = next_id++;
+    return id;
+  }
+};
+
+// 测试夹具
+class StatsTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kTestMemorySize = kPageSize * 128;
+
+  void SetUp() override {
+    test_memory_ = std::aligned_alloc(kPageSize, kTestMemorySize);
+    ASSERT_NE(test_memory_, nullptr) << "Failed to allocate test memory";
+  }
+
+  void TearDown() override { std::free(test_memory_); }
+
+  // 在快照中查找指定对象大小的 cache
+  static auto FindCache(const CacheStats* stats, size_t count, size_t size)
+      -> const CacheStats* {
+    for (size_t i = 0; i < count; i++) {
+      if (stats[i].object_size_ == size) {
+        return &stats[i];
+      }
+    }
+    return nullptr;
+  }
+
+  void* test_memory_ = nullptr;
+};
+
+}  // namespace
+
+// 测试分配器级别的计数、高水位与锁竞争统计
+TEST_F(StatsTest, AllocatorCounters) {
+  FirstFit<std::nullptr_t, SpinLock<>> allocator("stats", test_memory_,
+                                                  kTestMemorySize / kPageSize);
+  auto before = allocator.GetStats();
+  EXPECT_EQ(before.allocs_, 0);
+  EXPECT_EQ(before.used_, 0);
+
+  void* a = allocator.Alloc(4);
+  void* b = allocator.Alloc(8);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(allocator.Alloc(kTestMemorySize), nullptr);
+  allocator.Free(b, 8);
+
+  auto stats = allocator.GetStats();
+  EXPECT_EQ(stats.allocs_, 2);
+  EXPECT_EQ(stats.failed_allocs_, 1);
+  EXPECT_EQ(stats.frees_, 1);
+  EXPECT_EQ(stats.used_, 4);
+  EXPECT_EQ(stats.peak_used_, 12);
+  EXPECT_EQ(stats.used_ + stats.free_, before.free_);
+  EXPECT_EQ(stats.lock_acquisitions_, 4);
+  EXPECT_EQ(stats.lock_contentions_, 0);
+
+  // 批量分配中失败的部分按内存块计数
+  void* ptrs[4] = {};
+  EXPECT_EQ(allocator.AllocBulk(kTestMemorySize, 4, ptrs), 0);
+  EXPECT_EQ(allocator.GetStats().failed_allocs_, 5);
+  allocator.Free(a, 4);
+}
+
+// 测试 slab cache 的对象计数、slab 增长与收缩以及碎片字节数
+TEST_F(StatsTest, SlabCacheCounters) {
+  using MySlab = Slab<Buddy<std::nullptr_t, SpinLock<>>, std::nullptr_t,
+                      SpinLock<>>;
+  MySlab slab("stats_slab", test_memory_, kTestMemorySize);
+
+  constexpr size_t kObjects = 200;
+  std::vector<void*> ptrs;
+  for (size_t i = 0; i < kObjects; i++) {
+    ptrs.push_back(slab.Alloc(100));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+
+  CacheStats caches[PowerOfTwoSizeClass::kCount];
+  size_t count = slab.GetCacheStats(caches, PowerOfTwoSizeClass::kCount);
+  EXPECT_EQ(count, PowerOfTwoSizeClass::kCount);
+  const auto* cache = FindCache(caches, count, 128);
+  ASSERT_NE(cache, nullptr);
+  EXPECT_STREQ(cache->name_, "size-128");
+  EXPECT_EQ(cache->allocs_, kObjects);
+  EXPECT_EQ(cache->active_objects_, kObjects);
+  EXPECT_GE(cache->total_objects_, kObjects);
+  EXPECT_GE(cache->slab_grows_, 2);
+  EXPECT_EQ(cache->magazine_allocs_, 0);
+  size_t slab_bytes = cache->fragmentation_bytes_ + kObjects * 128;
+  // 每个 100 字节的请求占用一个 128 字节的对象
+  EXPECT_EQ(cache->requests_, kObjects);
+  EXPECT_EQ(cache->requested_bytes_, kObjects * 100);
+  EXPECT_EQ(cache->internal_fragmentation_bytes_, kObjects * 28);
+
+  for (auto* ptr : ptrs) {
+    slab.Free(ptr);
+  }
+  count = slab.GetCacheStats(caches, PowerOfTwoSizeClass::kCount);
+  cache = FindCache(caches, count, 128);
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(cache->frees_, kObjects);
+  EXPECT_EQ(cache->active_objects_, 0);
+  EXPECT_EQ(cache->peak_active_objects_, kObjects);
+  EXPECT_GE(cache->slab_shrinks_, 1);
+  // 保留的空闲 slab 全部计为碎片
+  EXPECT_GT(cache->fragmentation_bytes_, 0);
+  EXPECT_LT(cache->fragmentation_bytes_, slab_bytes);
+  EXPECT_GT(cache->lock_acquisitions_, 0);
+
+  // 容量不足时只写入前几个 cache
+  EXPECT_EQ(slab.GetCacheStats(caches, 2), 2);
+}
+
+// 测试 magazine 命中计入分配与释放次数，刷回 slab 层时不重复计数
+TEST_F(StatsTest, MagazineCounters) {
+  using MySlab = Slab<Buddy<std::nullptr_t, SpinLock<>>, std::nullptr_t,
+                      SpinLock<>, PowerOfTwoSizeClass, TestCpuId>;
+  MySlab slab("stats_magazine", test_memory_, kTestMemorySize);
+
+  void* ptr = slab.Alloc(64);
+  ASSERT_NE(ptr, nullptr);
+  slab.Free(ptr);
+  EXPECT_EQ(slab.Alloc(64), ptr);
+  slab.Free(ptr);
+
+  CacheStats caches[PowerOfTwoSizeClass::kCount];
+  size_t count = slab.GetCacheStats(caches, PowerOfTwoSizeClass::kCount);
+  const auto* cache = FindCache(caches, count, 64);
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(cache->allocs_, 2);
+  EXPECT_EQ(cache->frees_, 2);
+  EXPECT_EQ(cache->magazine_allocs_, 1);
+  EXPECT_EQ(cache->magazine_frees_, 2);
+  // magazine 中的空闲对象在 slab 层仍为活跃对象
+  EXPECT_EQ(cache->active_objects_, 1);
+}
+
+// 测试监控线程在分配进行时不加锁地读取快照
+TEST_F(StatsTest, ConcurrentSnapshot) {
+  constexpr size_t kBytes = 1024 * 1024 * 4;
+  void* memory = std::malloc(kBytes);
+  ASSERT_NE(memory, nullptr);
+  {
+    Bmalloc<std::nullptr_t, SpinLock<>> allocator(memory, kBytes);
+    constexpr int kThreads = 4;
+    constexpr int kIterations = 2000;
+    std::atomic<bool> done{false};
+
+    std::thread monitor([&]() {
+      uint64_t last = 0;
+      Bmalloc<std::nullptr_t, SpinLock<>>::Stats stats{};
+      while (!done.load(std::memory_order_acquire)) {
+        allocator.get_stats(stats);
+        EXPECT_GE(stats.slab_.allocs_, last);
+        last = stats.slab_.allocs_;
+      }
+    });
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; t++) {
+      workers.emplace_back([&]() {
+        for (int i = 0; i < kIterations; i++) {
+          void* ptr = allocator.malloc(32 + (i % 8) * 64);
+          ASSERT_NE(ptr, nullptr);
+          allocator.free(ptr);
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    done.store(true, std::memory_order_release);
+    monitor.join();
+
+    Bmalloc<std::nullptr_t, SpinLock<>>::Stats stats{};
+    allocator.get_stats(stats);
+    EXPECT_EQ(stats.slab_.allocs_, kThreads * kIterations);
+    EXPECT_EQ(stats.slab_.frees_, kThreads * kIterations);
+    EXPECT_EQ(stats.cache_count_, PowerOfTwoSizeClass::kCount);
+    uint64_t cache_allocs = 0;
+    for (size_t i = 0; i < stats.cache_count_; i++) {
+      cache_allocs += stats.caches_[i].allocs_;
+    }
+    EXPECT_GE(cache_allocs, kThreads * kIterations);
+  }
+  std::free(memory);
+}
@@ -0,0 +1,173 @@
+/**
+ * Copyright The bmalloc Contributors
+ * @file trace_test.cpp
+ * @brief 分配跟踪的Google Test测试用例
+ */
+
+#include "trace.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+
+#include "buddy.hpp"
+#include "slab.hpp"
+
+using namespace bmalloc;
+
+namespace {
+
+// 日志函数类型
+struct TestLogger {
+  int operator()(const char* format, ...) const {
+    va_list args;
+    va_start(args, format);
+    int result = vprintf(format, args);
+    va_end(args);
+    return result;
+  }
+};
+
+uint64_t fake_time = 0;
+
+auto FakeClock() -> uint64_t { return fake_time += 10; }
+
+// 测试夹具
+class TraceTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kTestMemorySize = kPageSize * 64;
+
+  void SetUp() override {
+    test_memory_ = std::aligned_alloc(kPageSize, kTestMemorySize);
+    ASSERT_NE(test_memory_, nullptr) << "Failed to allocate test memory";
+  }
+
+  void TearDown() override { std::free(test_memory_); }
+
+  void* test_memory_ = nullptr;
+};
+
+}  // namespace
+
+// 测试环形缓冲区写满后覆盖最早的记录，并按时间顺序访问
+TEST_F(TraceTest, RingBufferWrap) {
+  TraceRecord records[4];
+  TraceBuffer buffer(records, 4);
+  EXPECT_EQ(buffer.Size(), 0);
+
+  for (uintptr_t i = 0; i < 6; i++) {
+    buffer.Record(TraceOp::kAlloc, reinterpret_cast<void*>(0x1000 * (i + 1)),
+                  i);
+  }
+  EXPECT_EQ(buffer.Size(), 4);
+  EXPECT_EQ(buffer.Written(), 6);
+  EXPECT_EQ(buffer.Dropped(), 2);
+  for (size_t i = 0; i < buffer.Size(); i++) {
+    // 没有时钟时时间戳为记录序号
+    EXPECT_EQ(buffer[i].timestamp_, i + 2);
+    EXPECT_EQ(buffer[i].address_, 0x1000 * (i + 3));
+    EXPECT_EQ(buffer[i].size_, i + 2);
+  }
+
+  // 超过 32 位的长度截断
+  buffer.Record(TraceOp::kFree, nullptr, size_t{1} << 40);
+  EXPECT_EQ(buffer[buffer.Size() - 1].size_, UINT32_MAX);
+
+  buffer.Clear();
+  EXPECT_EQ(buffer.Size(), 0);
+  EXPECT_EQ(buffer.Dropped(), 0);
+}
+
+// 测试分配器的每次操作都写入跟踪缓冲区
+TEST_F(TraceTest, AllocatorOperations) {
+  Buddy<TestLogger> allocator("TraceBuddy", test_memory_, kTestMemorySize);
+  TraceRecord records[16];
+  TraceBuffer buffer(records, 16, FakeClock);
+  allocator.SetTraceBuffer(&buffer);
+
+  void* a = allocator.Alloc(kPageSize);
+  ASSERT_NE(a, nullptr);
+  // 原位增长记为 kRealloc
+  void* grown = allocator.Realloc(a, 2 * kPageSize);
+  ASSERT_EQ(grown, a);
+  void* ptrs[2] = {};
+  ASSERT_EQ(allocator.AllocBulk(kPageSize, 2, ptrs), 2);
+  // 移动记为释放旧块与分配新块
+  void* moved = allocator.Realloc(ptrs[0], 4 * kPageSize);
+  ASSERT_NE(moved, nullptr);
+  ASSERT_NE(moved, ptrs[0]);
+  // 失败的分配同样记录，地址为 0
+  EXPECT_EQ(allocator.Alloc(kTestMemorySize * 2), nullptr);
+  allocator.Free(grown);
+  void* rest[2] = {moved, ptrs[1]};
+  allocator.FreeBulk(rest, 2);
+
+  struct Expected {
+    TraceOp op_;
+    const void* addr_;
+    size_t size_;
+  };
+  const Expected expected[] = {
+      {TraceOp::kAlloc, a, kPageSize},
+      {TraceOp::kRealloc, a, 2 * kPageSize},
+      {TraceOp::kAlloc, ptrs[0], kPageSize},
+      {TraceOp::kAlloc, ptrs[1], kPageSize},
+      {TraceOp::kFree, ptrs[0], 0},
+      {TraceOp::kAlloc, moved, 4 * kPageSize},
+      {TraceOp::kAlloc, nullptr, kTestMemorySize * 2},
+      {TraceOp::kFree, grown, 0},
+      {TraceOp::kFree, moved, 0},
+      {TraceOp::kFree, ptrs[1], 0},
+  };
+  ASSERT_EQ(buffer.Size(), std::size(expected));
+  for (size_t i = 0; i < buffer.Size(); i++) {
+    EXPECT_EQ(buffer[i].op_, expected[i].op_) << i;
+    EXPECT_EQ(buffer[i].address_,
+              reinterpret_cast<uintptr_t>(expected[i].addr_))
+        << i;
+    EXPECT_EQ(buffer[i].size_, expected[i].size_) << i;
+    if (i > 0) {
+      EXPECT_GT(buffer[i].timestamp_, buffer[i - 1].timestamp_);
+    }
+  }
+
+  // 取消跟踪后不再记录
+  allocator.SetTraceBuffer(nullptr);
+  void* untraced = allocator.Alloc(kPageSize);
+  ASSERT_NE(untraced, nullptr);
+  allocator.Free(untraced);
+  EXPECT_EQ(buffer.Written(), std::size(expected));
+}
+
+// 测试 Slab 的对齐分配与其它分配一样写入跟踪缓冲区并计入统计
+TEST_F(TraceTest, AllocAligned) {
+  Slab<Buddy<TestLogger>, TestLogger> slab("TraceSlab", test_memory_,
+                                           kTestMemorySize);
+  TraceRecord records[8];
+  TraceBuffer buffer(records, 8, FakeClock);
+  slab.SetTraceBuffer(&buffer);
+
+  void* aligned = slab.AllocAligned(256, 100);
+  ASSERT_NE(aligned, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 256, 0);
+  // 超过最大对象大小时记录失败的分配
+  EXPECT_EQ(slab.AllocAligned(64, slab.kMaxObjectSize + 1), nullptr);
+  slab.Free(aligned);
+
+  ASSERT_EQ(buffer.Size(), 3);
+  EXPECT_EQ(buffer[0].op_, TraceOp::kAlloc);
+  EXPECT_EQ(buffer[0].address_, reinterpret_cast<uintptr_t>(aligned));
+  EXPECT_EQ(buffer[0].size_, 100);
+  EXPECT_EQ(buffer[1].op_, TraceOp::kAlloc);
+  EXPECT_EQ(buffer[1].address_, 0);
+  EXPECT_EQ(buffer[2].op_, TraceOp::kFree);
+  EXPECT_EQ(buffer[2].address_, reinterpret_cast<uintptr_t>(aligned));
+
+  auto stats = slab.GetStats();
+  EXPECT_EQ(stats.allocs_, 1);
+  EXPECT_EQ(stats.failed_allocs_, 1);
+  EXPECT_EQ(stats.frees_, 1);
+  slab.SetTraceBuffer(nullptr);
+}
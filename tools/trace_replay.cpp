@@ -0,0 +1,590 @@
+/**
+ * Copyright The bmalloc Contributors
+ * @file trace_replay.cpp
+ * @brief 分配跟踪的回放工具（宿主机）
+ * @details 读取 TraceBuffer 导出的 TraceRecord 文件，依次回放到
+ *          Slab<Buddy>、FirstFit、Bmalloc 与 libc malloc，报告吞吐量、
+ *          峰值 RSS 与碎片率。每个分配器在独立的子进程中回放，
+ *          峰值 RSS 互不影响。
+ *
+ *          用法：
+ *            bmalloc_replay <trace> [--pages] [allocator...]
+ *            bmalloc_replay --generate <trace> <count>
+ *          --pages 表示记录中的长度以页为单位（从 FirstFit 采集的跟踪）；
+ *          --generate 用带跟踪的 Slab<Buddy> 运行随机负载并导出跟踪文件
+ */
+
+#include <malloc.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bmalloc.hpp"
+#include "buddy.hpp"
+#include "first_fit.hpp"
+#include "slab.hpp"
+#include "trace.hpp"
+
+using namespace bmalloc;
+
+namespace {
+
+/// 每个分配器管理的内存大小，按需映射，只有访问过的页计入 RSS
+constexpr size_t kArenaBytes = size_t{1} << 30;
+
+/**
+ * @brief 回放的一步操作
+ * @details 跟踪中的地址在预处理时转换为槽位编号，回放时不需要查找哈希表
+ */
+struct Step {
+  TraceOp op_;
+  uint32_t slot_;
+  size_t size_;
+};
+
+/// 回放结果
+struct Result {
+  uint64_t ops_ = 0;
+  uint64_t failures_ = 0;
+  double seconds_ = 0;
+  /// 存活对象请求字节数的峰值
+  size_t peak_requested_ = 0;
+  /// 存活对象实际占用字节数的峰值
+  size_t peak_actual_ = 0;
+  /// 回放期间进程 RSS 的增长（字节）
+  size_t rss_growth_ = 0;
+};
+
+/// 按页对齐、按需映射的内存
+class Arena {
+ public:
+  explicit Arena(size_t bytes) : bytes_(bytes) {
+    memory_ = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (memory_ == MAP_FAILED) {
+      memory_ = nullptr;
+    }
+  }
+  Arena(const Arena&) = delete;
+  Arena(Arena&&) = delete;
+  auto operator=(const Arena&) -> Arena& = delete;
+  auto operator=(Arena&&) -> Arena& = delete;
+  ~Arena() {
+    if (memory_ != nullptr) {
+      munmap(memory_, bytes_);
+    }
+  }
+
+  [[nodiscard]] auto Memory() const -> void* { return memory_; }
+  [[nodiscard]] auto Bytes() const -> size_t { return bytes_; }
+
+ private:
+  size_t bytes_;
+  void* memory_ = nullptr;
+};
+
+/**
+ * @brief 被回放的分配器
+ * @details 每个适配器提供 kName、Alloc(bytes)、Free(ptr, bytes)、
+ *          Resize(ptr, old, new)（原位失败时分配新内存并复制）与
+ *          BlockSize(ptr, bytes)（内存块实际占用的字节数）
+ */
+class SlabSubject {
+ public:
+  static constexpr const char* kName = "slab";
+  using Allocator = Slab<Buddy<>>;
+
+  explicit SlabSubject(const Arena& arena)
+      : allocator_("replay", arena.Memory(), arena.Bytes()) {}
+
+  /// 超出通用 cache 范围的请求由 Slab 下层的 Buddy 分配
+  auto Alloc(size_t bytes) -> void* {
+    bytes = std::max(bytes, Allocator::kMinObjectSize);
+    if (bytes <= Allocator::kMaxObjectSize) {
+      return allocator_.Alloc(bytes);
+    }
+    return allocator_.GetPageAllocator().Alloc(bytes);
+  }
+  void Free(void* ptr, size_t /*bytes*/) {
+    if (allocator_.GetAllocatedSize(ptr) != 0) {
+      allocator_.Free(ptr);
+    } else {
+      allocator_.GetPageAllocator().Free(ptr);
+    }
+  }
+  auto Resize(void* ptr, size_t old_size, size_t new_size) -> void* {
+    return Move(*this, ptr, old_size, new_size);
+  }
+  auto BlockSize(void* ptr, size_t /*bytes*/) -> size_t {
+    size_t size = allocator_.GetAllocatedSize(ptr);
+    return size != 0 ? size : allocator_.GetPageAllocator().AllocSize(ptr);
+  }
+
+  /// 分配新内存、复制并释放旧内存
+  template <class Subject>
+  static auto Move(Subject& subject, void* ptr, size_t old_size,
+                   size_t new_size) -> void* {
+    void* moved = subject.Alloc(new_size);
+    if (moved != nullptr) {
+      std::memcpy(moved, ptr, std::min(old_size, new_size));
+      subject.Free(ptr, old_size);
+    }
+    return moved;
+  }
+
+ private:
+  Allocator allocator_;
+};
+
+/// FirstFit 以页为单位分配
+class FirstFitSubject {
+ public:
+  static constexpr const char* kName = "firstfit";
+
+  explicit FirstFitSubject(const Arena& arena)
+      : allocator_("replay", arena.Memory(), arena.Bytes() / kPageSize) {}
+
+  auto Alloc(size_t bytes) -> void* { return allocator_.Alloc(Pages(bytes)); }
+  void Free(void* ptr, size_t bytes) { allocator_.Free(ptr, Pages(bytes)); }
+  auto Resize(void* ptr, size_t old_size, size_t new_size) -> void* {
+    if (Pages(old_size) == Pages(new_size)) {
+      return ptr;
+    }
+    return SlabSubject::Move(*this, ptr, old_size, new_size);
+  }
+  auto BlockSize(void* /*ptr*/, size_t bytes) -> size_t {
+    return Pages(bytes) * kPageSize;
+  }
+
+ private:
+  static auto Pages(size_t bytes) -> size_t {
+    return (bytes + kPageSize - 1) / kPageSize;
+  }
+
+  FirstFit<> allocator_;
+};
+
+class BmallocSubject {
+ public:
+  static constexpr const char* kName = "bmalloc";
+
+  explicit BmallocSubject(const Arena& arena)
+      : allocator_(arena.Memory(), arena.Bytes()) {}
+
+  auto Alloc(size_t bytes) -> void* { return allocator_.malloc(bytes); }
+  void Free(void* ptr, size_t /*bytes*/) { allocator_.free(ptr); }
+  auto Resize(void* ptr, size_t /*old_size*/, size_t new_size) -> void* {
+    return allocator_.realloc(ptr, new_size);
+  }
+  auto BlockSize(void* ptr, size_t /*bytes*/) -> size_t {
+    return allocator_.malloc_size(ptr);
+  }
+
+ private:
+  Bmalloc<> allocator_;
+};
+
+/// glibc 基准
+class LibcSubject {
+ public:
+  static constexpr const char* kName = "libc";
+
+  explicit LibcSubject(const Arena& /*arena*/) {}
+
+  auto Alloc(size_t bytes) -> void* { return std::malloc(bytes); }
+  void Free(void* ptr, size_t /*bytes*/) { std::free(ptr); }
+  auto Resize(void* ptr, size_t /*old_size*/, size_t new_size) -> void* {
+    return std::realloc(ptr, new_size);
+  }
+  auto BlockSize(void* ptr, size_t /*bytes*/) -> size_t {
+    return malloc_usable_size(ptr);
+  }
+};
+
+/// 当前进程的常驻内存字节数
+auto CurrentRss() -> size_t {
+  FILE* file = std::fopen("/proc/self/statm", "r");
+  if (file == nullptr) {
+    return 0;
+  }
+  unsigned long size = 0;
+  unsigned long resident = 0;
+  if (std::fscanf(file, "%lu %lu", &size, &resident) != 2) {
+    resident = 0;
+  }
+  std::fclose(file);
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/// 进程的峰值常驻内存字节数
+auto PeakRss() -> size_t {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<size_t>(usage.ru_maxrss) * 1024;
+}
+
+/// 写入内存块的每一页，使回放的 RSS 反映真实程序使用内存的情况
+void Touch(void* ptr, size_t bytes) {
+  auto* bytes_ptr = static_cast<volatile unsigned char*>(ptr);
+  for (size_t offset = 0; offset < bytes; offset += kPageSize) {
+    bytes_ptr[offset] = 1;
+  }
+  bytes_ptr[bytes - 1] = 1;
+}
+
+/**
+ * @brief 将跟踪记录转换为回放步骤
+ * @param records 跟踪记录
+ * @param unit 长度单位的字节数
+ * @param slots 输出所需的槽位数
+ * @return std::vector<Step> 回放步骤，未知地址的释放与失败的分配被跳过
+ */
+auto Prepare(const std::vector<TraceRecord>& records, size_t unit,
+             uint32_t& slots) -> std::vector<Step> {
+  std::vector<Step> steps;
+  steps.reserve(records.size());
+  std::unordered_map<uint64_t, uint32_t> live;
+  std::vector<uint32_t> free_slots;
+  slots = 0;
+
+  for (const auto& record : records) {
+    size_t size = size_t{record.size_} * unit;
+    switch (record.op_) {
+      case TraceOp::kAlloc: {
+        if (record.address_ == 0 || size == 0) {
+          break;
+        }
+        // 同一地址重复分配时（跟踪中丢失了释放记录）先释放旧的槽位
+        if (auto it = live.find(record.address_); it != live.end()) {
+          steps.push_back({TraceOp::kFree, it->second, 0});
+          free_slots.push_back(it->second);
+        }
+        uint32_t slot = 0;
+        if (!free_slots.empty()) {
+          slot = free_slots.back();
+          free_slots.pop_back();
+        } else {
+          slot = slots++;
+        }
+        live[record.address_] = slot;
+        steps.push_back({TraceOp::kAlloc, slot, size});
+        break;
+      }
+      case TraceOp::kFree: {
+        auto it = live.find(record.address_);
+        if (it == live.end()) {
+          break;
+        }
+        steps.push_back({TraceOp::kFree, it->second, 0});
+        free_slots.push_back(it->second);
+        live.erase(it);
+        break;
+      }
+      case TraceOp::kRealloc: {
+        auto it = live.find(record.address_);
+        if (it != live.end() && size != 0) {
+          steps.push_back({TraceOp::kRealloc, it->second, size});
+        }
+        break;
+      }
+    }
+  }
+  return steps;
+}
+
+/// 回放中一个槽位上的内存块
+struct Block {
+  void* ptr_ = nullptr;
+  size_t size_ = 0;
+  size_t actual_ = 0;
+};
+
+/**
+ * @brief 依次执行回放步骤，结束后释放所有存活的内存块
+ * @param measure 为 true 时写入每个内存块的每一页并查询实际占用，
+ *        统计操作数、失败数与峰值；为 false 时只调用分配器，用于计时
+ */
+template <class Subject>
+void RunSteps(const std::vector<Step>& steps, uint32_t slots,
+              Subject& subject, bool measure, Result& result) {
+  std::vector<Block> blocks(slots);
+  size_t requested = 0;
+  size_t actual = 0;
+  for (const auto& step : steps) {
+    auto& block = blocks[step.slot_];
+    switch (step.op_) {
+      case TraceOp::kAlloc: {
+        block.ptr_ = subject.Alloc(step.size_);
+        block.size_ = block.ptr_ != nullptr ? step.size_ : 0;
+        break;
+      }
+      case TraceOp::kFree: {
+        if (block.ptr_ != nullptr) {
+          subject.Free(block.ptr_, block.size_);
+          requested -= block.size_;
+          actual -= block.actual_;
+          block = {};
+        }
+        result.ops_++;
+        continue;
+      }
+      case TraceOp::kRealloc: {
+        if (block.ptr_ == nullptr) {
+          continue;
+        }
+        void* resized = subject.Resize(block.ptr_, block.size_, step.size_);
+        if (resized == nullptr) {
+          result.failures_++;
+          result.ops_++;
+          continue;
+        }
+        requested -= block.size_;
+        actual -= block.actual_;
+        block.ptr_ = resized;
+        block.size_ = step.size_;
+        break;
+      }
+    }
+    result.ops_++;
+    if (block.ptr_ == nullptr) {
+      result.failures_++;
+      continue;
+    }
+    if (!measure) {
+      continue;
+    }
+    Touch(block.ptr_, block.size_);
+    block.actual_ = subject.BlockSize(block.ptr_, block.size_);
+    requested += block.size_;
+    actual += block.actual_;
+    result.peak_requested_ = std::max(result.peak_requested_, requested);
+    result.peak_actual_ = std::max(result.peak_actual_, actual);
+  }
+
+  for (auto& block : blocks) {
+    if (block.ptr_ != nullptr) {
+      subject.Free(block.ptr_, block.size_);
+    }
+  }
+}
+
+/**
+ * @brief 在当前进程中回放到 Subject
+ * @details 回放两遍，每遍使用新的分配器：第一遍写入内存块并统计峰值 RSS
+ *          与碎片率，不计时；第二遍只调用分配器并计时，吞吐量不包含
+ *          缺页与大小查询的开销
+ */
+template <class Subject>
+auto Replay(const std::vector<Step>& steps, uint32_t slots) -> Result {
+  Result result;
+  {
+    Arena arena(kArenaBytes);
+    if (arena.Memory() == nullptr) {
+      return result;
+    }
+    size_t rss_before = CurrentRss();
+    Subject subject(arena);
+    RunSteps(steps, slots, subject, true, result);
+    size_t peak = PeakRss();
+    result.rss_growth_ = peak > rss_before ? peak - rss_before : 0;
+  }
+
+  Arena arena(kArenaBytes);
+  if (arena.Memory() == nullptr) {
+    return result;
+  }
+  Subject subject(arena);
+  Result timed;
+  auto start = std::chrono::steady_clock::now();
+  RunSteps(steps, slots, subject, false, timed);
+  result.seconds_ = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  return result;
+}
+
+/// 在子进程中回放并打印一行结果，子进程的峰值 RSS 不受其它分配器影响
+template <class Subject>
+void RunInChild(const std::vector<Step>& steps, uint32_t slots) {
+  std::fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) {
+    std::perror("fork");
+    return;
+  }
+  if (pid > 0) {
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      std::printf("%-10s replay failed\n", Subject::kName);
+    }
+    return;
+  }
+
+  auto result = Replay<Subject>(steps, slots);
+  double internal =
+      result.peak_actual_ == 0
+          ? 0
+          : 1.0 - static_cast<double>(result.peak_requested_) /
+                      static_cast<double>(result.peak_actual_);
+  double overall =
+      result.rss_growth_ == 0
+          ? 0
+          : 1.0 - static_cast<double>(result.peak_requested_) /
+                      static_cast<double>(result.rss_growth_);
+  std::printf("%-10s %12.0f %10llu %12zu %12zu %9.1f%% %9.1f%%\n",
+              Subject::kName,
+              result.seconds_ > 0 ? static_cast<double>(result.ops_) /
+                                        result.seconds_
+                                  : 0.0,
+              static_cast<unsigned long long>(result.failures_),
+              result.peak_requested_ / 1024, result.rss_growth_ / 1024,
+              internal * 100, std::max(0.0, overall) * 100);
+  std::fflush(stdout);
+  _exit(0);
+}
+
+auto ReadTrace(const char* path, std::vector<TraceRecord>& records) -> bool {
+  FILE* file = std::fopen(path, "rb");
+  if (file == nullptr) {
+    std::perror(path);
+    return false;
+  }
+  TraceRecord record{};
+  while (std::fread(&record, sizeof(record), 1, file) == 1) {
+    records.push_back(record);
+  }
+  std::fclose(file);
+  return true;
+}
+
+/**
+ * @brief 用带跟踪的 Slab<Buddy> 运行随机负载并导出跟踪
+ * @param path 输出文件
+ * @param count 记录数
+ */
+auto Generate(const char* path, size_t count) -> bool {
+  using Allocator = Slab<Buddy<>>;
+  Arena arena(kArenaBytes);
+  if (arena.Memory() == nullptr) {
+    return false;
+  }
+  Allocator allocator("trace", arena.Memory(), arena.Bytes());
+  std::vector<TraceRecord> records(count);
+  TraceBuffer buffer(records.data(), records.size(), []() -> uint64_t {
+    return static_cast<uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+  });
+  allocator.SetTraceBuffer(&buffer);
+
+  // 对数均匀分布的大小，存活对象数在 [0, 4096) 之间随机游走
+  std::mt19937_64 gen(1);
+  std::uniform_real_distribution<double> log_size(
+      std::log2(static_cast<double>(Allocator::kMinObjectSize)), 14.0);
+  std::vector<void*> live;
+  while (buffer.Written() < count) {
+    bool alloc = live.empty() || (live.size() < 4096 && gen() % 2 == 0);
+    if (alloc) {
+      auto size = static_cast<size_t>(std::exp2(log_size(gen)));
+      if (void* ptr = allocator.Alloc(size); ptr != nullptr) {
+        live.push_back(ptr);
+      }
+    } else {
+      auto index = gen() % live.size();
+      allocator.Free(live[index]);
+      live[index] = live.back();
+      live.pop_back();
+    }
+  }
+  allocator.SetTraceBuffer(nullptr);
+  for (void* ptr : live) {
+    allocator.Free(ptr);
+  }
+
+  FILE* file = std::fopen(path, "wb");
+  if (file == nullptr) {
+    std::perror(path);
+    return false;
+  }
+  for (size_t i = 0; i < buffer.Size(); i++) {
+    std::fwrite(&buffer[i], sizeof(TraceRecord), 1, file);
+  }
+  std::fclose(file);
+  std::printf("wrote %zu records to %s\n", buffer.Size(), path);
+  return true;
+}
+
+void Usage(const char* name) {
+  std::fprintf(stderr,
+               "usage: %s <trace> [--pages] [slab|firstfit|bmalloc|libc...]\n"
+               "       %s --generate <trace> <count>\n",
+               name, name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc >= 2 && std::strcmp(argv[1], "--generate") == 0) {
+    if (argc != 4) {
+      Usage(argv[0]);
+      return 1;
+    }
+    return Generate(argv[2], std::strtoull(argv[3], nullptr, 10)) ? 0 : 1;
+  }
+  if (argc < 2) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  size_t unit = 1;
+  std::vector<std::string> selected;
+  for (int i = 2; i < argc; i++) {
+    if (std::strcmp(argv[i], "--pages") == 0) {
+      unit = kPageSize;
+    } else {
+      selected.emplace_back(argv[i]);
+    }
+  }
+  auto enabled = [&selected](const char* name) {
+    return selected.empty() ||
+           std::find(selected.begin(), selected.end(), name) !=
+               selected.end();
+  };
+
+  std::vector<TraceRecord> records;
+  if (!ReadTrace(argv[1], records)) {
+    return 1;
+  }
+  uint32_t slots = 0;
+  auto steps = Prepare(records, unit, slots);
+  std::printf("%zu records, %zu steps, %u slots\n", records.size(),
+              steps.size(), slots);
+  std::printf("%-10s %12s %10s %12s %12s %10s %10s\n", "allocator", "ops/s",
+              "failures", "peak_req_kb", "rss_kb", "internal", "overall");
+
+  if (enabled(SlabSubject::kName)) {
+    RunInChild<SlabSubject>(steps, slots);
+  }
+  if (enabled(FirstFitSubject::kName)) {
+    RunInChild<FirstFitSubject>(steps, slots);
+  }
+  if (enabled(BmallocSubject::kName)) {
+    RunInChild<BmallocSubject>(steps, slots);
+  }
+  if (enabled(LibcSubject::kName)) {
+    RunInChild<LibcSubject>(steps, slots);
+  }
+  return 0;
+}